@@ -31,166 +31,14 @@
 
 
 
-// translate pin number to SC1A nomenclature and viceversa
-// we need to create this static const arrays so that we can assign the "normal arrays" to the correct one
-// depending on which ADC module we will be.
-/* channel2sc1aADCx converts a pin number to their value for the SC1A register, for the ADC0 and ADC1
-*  numbers with +ADC_SC1A_PIN_MUX (128) means those pins use mux a, the rest use mux b.
-*  numbers with +ADC_SC1A_PIN_DIFF (64) means it's also a differential pin (treated also in the channel2sc1a_diff_ADCx)
-*  For diff_table_ADCx, +ADC_SC1A_PIN_PGA means the pin can use PGA on that ADC
-*/
-
-///////// ADC0
-#if defined(ADC_TEENSY_3_0)
-const uint8_t ADC::channel2sc1aADC0[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 0, 19, 3, 21, // 0-13, we treat them as A0-A13
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
-    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, // 24-33
-    0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 3+ADC_SC1A_PIN_DIFF, 21+ADC_SC1A_PIN_DIFF, // 34-37 (A10-A13)
-    26, 22, 23, 27, 29, 30 // 38-43: temp. sensor, VREF_OUT, A14, bandgap, VREFH, VREFL. A14 isn't connected to anything in Teensy 3.0.
-};
-#elif defined(ADC_TEENSY_3_1) // the only difference with 3.0 is that A13 is not connected to ADC0 and that T3.1 has PGA.
-const uint8_t ADC::channel2sc1aADC0[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 0, 19, 3, 31, // 0-13, we treat them as A0-A13
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
-    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, // 24-33
-    0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, // 34-37 (A10-A13)
-    26, 22, 23, 27, 29, 30 // 38-43: temp. sensor, VREF_OUT, A14, bandgap, VREFH, VREFL. A14 isn't connected to anything in Teensy 3.0.
-};
-#elif defined(ADC_TEENSY_LC)
-// Teensy LC
-const uint8_t ADC::channel2sc1aADC0[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 11, 0, 4+ADC_SC1A_PIN_MUX, 23, 31, // 0-13, we treat them as A0-A12 + A13= doesn't exist
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 11, // 14-23 (A0-A9)
-    0+ADC_SC1A_PIN_DIFF, 4+ADC_SC1A_PIN_MUX+ADC_SC1A_PIN_DIFF, 23, 31, 31, 31, 31, 31, 31, 31, // 24-33 ((A10-A12) + nothing), A11 uses mux a
-    31, 31, 31, 31, // 34-37 nothing
-    26, 27, 31, 27, 29, 30 // 38-43: temp. sensor, , , bandgap, VREFH, VREFL.
-};
-#elif defined(ADC_TEENSY_3_5)
-const uint8_t ADC::channel2sc1aADC0[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 3, 31, 31, 31, // 0-13, we treat them as A0-A13
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
-    26, 27, 29, 30, 31, 31, 31, // 24-30: Temp_Sensor, bandgap, VREFH, VREFL.
-    31, 31, 17, 18,// 31-34 A12(ADC1), A13(ADC1), A14, A15
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 35-43
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 44-52
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
-    31, 31, 3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, 23, 31, 1, 31 // 62-69 64: A10, 65: A11 (NOT CONNECTED), 66: A21, 68: A25 (no diff)
-};
-#elif defined(ADC_TEENSY_3_6)
-const uint8_t ADC::channel2sc1aADC0[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 3, 31, 31, 31, // 0-13, we treat them as A0-A13
-    5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
-    26, 27, 29, 30, 31, 31, 31, // 24-30: Temp_Sensor, bandgap, VREFH, VREFL.
-    31, 31, 17, 18,// 31-34 A12(ADC1), A13(ADC1), A14, A15
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 35-43
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 44-52
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
-    31, 31, 3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, 23, 31 // 62-67 64: A10, 65: A11 (NOT CONNECTED), 66: A21, 67: A22(ADC1)
-};
-#endif // defined
-
-///////// ADC1
-#if defined(ADC_TEENSY_3_1)
-const uint8_t ADC::channel2sc1aADC1[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    31, 31, 8, 9, 31, 31, 31, 31, 31, 31, 3, 31, 0, 19, // 0-13, we treat them as A0-A13
-    31, 31, 8, 9, 31, 31, 31, 31, 31, 31, // 14-23 (A0-A9)
-    31, 31,  // 24,25 are digital only pins
-    5+ADC_SC1A_PIN_MUX, 5, 4, 6, 7, 4+ADC_SC1A_PIN_MUX, 31, 31, // 26-33 26=5a, 27=5b, 28=4b, 29=6b, 30=7b, 31=4a, 32,33 are digital only
-    3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, 0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, // 34-37 (A10-A13) A11 isn't connected.
-    26, 18, 31, 27, 29, 30 // 38-43: temp. sensor, VREF_OUT, A14 (not connected), bandgap, VREFH, VREFL.
-};
-#elif defined(ADC_TEENSY_3_5)
-const uint8_t ADC::channel2sc1aADC1[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    31, 31, 8, 9, 31, 31, 31, 31, 31, 31, 31, 19, 14, 15, // 0-13, we treat them as A0-A13
-    31, 31, 8, 9, 31, 31, 31, 31, 31, 31, // 14-23 (A0-A9)
-    26, 27, 29, 30, 18, 31, 31,  // 24-30: Temp_Sensor, bandgap, VREFH, VREFL, VREF_OUT
-    14, 15, 31, 31, 4, 5, 6, 7, 17, // 31-39 A12-A20
-    31, 31, 31, 31, // 40-43
-    31, 31, 31, 31, 31, 10, 11, 31, 31, // 44-52, 49: A23, 50: A24
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
-    31, 31, 0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 31, 23, 31, 1 // 62-69 64: A10, 65: A11, 67: A22, 69: A26 (not diff)
-};
-#elif defined(ADC_TEENSY_3_6)
-const uint8_t ADC::channel2sc1aADC1[]= { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
-    31, 31, 8, 9, 31, 31, 31, 31, 31, 31, 31, 19, 14, 15, // 0-13, we treat them as A0-A13
-    31, 31, 8, 9, 31, 31, 31, 31, 31, 31, // 14-23 (A0-A9)
-    26, 27, 29, 30, 18, 31, 31,  // 24-30: Temp_Sensor, bandgap, VREFH, VREFL, VREF_OUT
-    14, 15, 31, 31, 4, 5, 6, 7, 17, // 31-39 A12-A20
-    31, 31, 31, 23, // 40-43: A10(ADC0), A11(ADC0), A21, A22
-    31, 31, 31, 31, 31, 10, 11, 31, 31, // 44-52, 49: A23, 50: A24
-    31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
-    31, 31, 0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 31, 23 // 61-67 64: A10, 65: A11, 66: A21(ADC0), 67: A22
-};
-#endif
-
-#if defined(ADC_TEENSY_3_1) // Teensy 3.1
-    const ADC_Module::ADC_NLIST ADC::diff_table_ADC0[]= {
-        {A10, 0+ADC_SC1A_PIN_PGA}, {A12, 3}
-    };
-    const ADC_Module::ADC_NLIST ADC::diff_table_ADC1[]= {
-        {A10, 3}, {A12, 0+ADC_SC1A_PIN_PGA}
-    };
-#elif defined(ADC_TEENSY_3_0) // Teensy 3.0
-    const ADC_Module::ADC_NLIST ADC::diff_table_ADC0[]= {
-        {A10, 0}, {A12, 3}
-    };
-#elif defined(ADC_TEENSY_LC) // Teensy LC
-    const ADC_Module::ADC_NLIST ADC::diff_table_ADC0[]= {
-        {A10, 0}
-    };
-#elif defined(ADC_TEENSY_3_5) || defined(ADC_TEENSY_3_6) // Teensy 3.6// Teensy 3.5
-    const ADC_Module::ADC_NLIST ADC::diff_table_ADC0[]= {
-        {A10, 3}
-    };
-    const ADC_Module::ADC_NLIST ADC::diff_table_ADC1[]= {
-        {A10, 0}
-    };
-#endif
-
-
-
-// translate SC1A to pin number
-///////// ADC0
-#if defined(ADC_TEENSY_3_0) || defined(ADC_TEENSY_3_1)
-const uint8_t ADC::sc1a2channelADC0[]= { // new version, gives directly the pin number
-    34, 0, 0, 36, 23, 14, 20, 21, 16, 17, 0, 0, 19, 18, // 0-13
-    15, 22, 23, 0, 0, 35, 0, 37, // 14-21
-    39, 40, 0, 0, 38, 41, 42, 43, // VREF_OUT, A14, temp. sensor, bandgap, VREFH, VREFL.
-    0 // 31 means disabled, but just in case
-};
-#elif defined(ADC_TEENSY_LC)
-// Teensy LC
-const uint8_t ADC::sc1a2channelADC0[]= { // new version, gives directly the pin number
-    24, 0, 0, 0, 25, 14, 20, 21, 16, 17, 0, 23, 19, 18, // 0-13
-    15, 22, 23, 0, 0, 0, 0, 0, // 14-21
-    26, 0, 0, 0, 38, 41, 0, 42, 43, // A12, temp. sensor, bandgap, VREFH, VREFL.
-    0 // 31 means disabled, but just in case
-};
-#elif defined(ADC_TEENSY_3_5) || defined(ADC_TEENSY_3_6)
-const uint8_t ADC::sc1a2channelADC0[]= { // new version, gives directly the pin number
-    0, 68, 0, 64, 23, 14, 20, 21, 16, 17, 0, 0, 19, 18, // 0-13
-    15, 22, 0, 33, 34, 0, 0, 0, // 14-21
-    0, 66, 0, 0, 70, 0, 0, 0, // 22-29
-    0 // 31 means disabled, but just in case
-};
-#endif // defined
-
-///////// ADC1
-#if defined(ADC_TEENSY_3_1)
-const uint8_t ADC::sc1a2channelADC1[]= { // new version, gives directly the pin number
-    36, 0, 0, 34, 28, 26, 29, 30, 16, 17, 0, 0, 0, 0, // 0-13. 5a=26, 5b=27, 4b=28, 4a=31
-    0, 0, 0, 0, 39, 37, 0, 0, // 14-21
-    0, 0, 0, 0, 38, 41, 0, 42, // 22-29. VREF_OUT, A14, temp. sensor, bandgap, VREFH, VREFL.
-    43
-};
-#elif defined(ADC_TEENSY_3_5) || defined(ADC_TEENSY_3_6)
-const uint8_t ADC::sc1a2channelADC1[]= { // new version, gives directly the pin number
-    0, 69, 0, 0, 35, 36, 37, 38, 0, 0, 49, 50, 0, 0, // 0-13.
-    31, 32, 0, 39, 71, 65, 0, 0, // 14-21
-    0, 67, 0, 0, 0, 0, 0, 0, // 22-29.
-    0
-};
+// definitions of the tables, their values are in ADC.h
+constexpr uint8_t ADC::channel2sc1aADC0[];
+constexpr uint8_t ADC::sc1a2channelADC0[];
+constexpr ADC_Module::ADC_NLIST ADC::diff_table_ADC0[];
+#if ADC_NUM_ADCS>1
+constexpr uint8_t ADC::channel2sc1aADC1[];
+constexpr uint8_t ADC::sc1a2channelADC1[];
+constexpr ADC_Module::ADC_NLIST ADC::diff_table_ADC1[];
 #endif
 
 
@@ -215,20 +63,73 @@ ADC::ADC() : // awkward initialization  so there are no -Wreorder warnings
 
 
 
+/////////////// SELECTION OF THE ADC MODULE ////////////////////
+/*
+    The methods with an adc_num parameter call the method of the same name of the selected ADC_Module.
+    adc_num=0 or 1 selects that ADC (ADC1 is an error in boards with only one),
+    adc_num=-1 selects the ADC that can measure the pin, or the one with less workload if both can.
+    Use the template methods (analogRead<ADC_1>(pin), module<ADC_1>()) to select the ADC at compile time.
+*/
+
+#if ADC_NUM_ADCS>1
+/* Returns the ADC that can measure the pins (adc0Valid, adc1Valid), if both can the one that would finish the conversion first
+*  If none can it sets the WRONG_PIN error and returns nullptr
+*/
+ADC_Module* ADC::selectModule(bool adc0Valid, bool adc1Valid, bool differential) {
+    if(adc0Valid && adc1Valid)  { // Both ADCs
+        if(adc0->isOwned()) { // only readOwned can use it
+            return adc1;
+        } else if(adc1->isOwned()) {
+            return adc0;
+        } else if( adc0->getCompletionTimeNs(differential) > adc1->getCompletionTimeNs(differential) ) { // ADC1 is done first
+            return adc1;
+        } else {
+            return adc0;
+        }
+    } else if(adc0Valid) { // ADC0
+        return adc0;
+    } else if(adc1Valid) { // ADC1
+        return adc1;
+    }
+    // pin not valid in any ADC
+    adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
+    adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
+    return nullptr;
+}
+#endif
+
+// ADC that should measure the pin
+ADC_Module* ADC::getModuleForPin(uint8_t pin, int8_t adc_num) {
+    #if ADC_NUM_ADCS>1
+    if( adc_num==-1 ) { // use no ADC in particular
+        return selectModule(adc0->checkPin(pin), adc1->checkPin(pin));
+    }
+    #endif
+    return getModule(adc_num);
+}
+
+// ADC that should measure the differential pins
+ADC_Module* ADC::getModuleForDifferentialPins(uint8_t pinP, uint8_t pinN, int8_t adc_num) {
+    #if ADC_NUM_ADCS>1
+    if( adc_num==-1 ) { // use no ADC in particular
+        return selectModule(adc0->checkDifferentialPins(pinP, pinN), adc1->checkDifferentialPins(pinP, pinN), true);
+    }
+    #endif
+    return getModule(adc_num);
+}
+
+
+
+/////////////// METHODS TO SET/GET SETTINGS OF THE ADC ////////////////////
+
 /* Set the voltage reference you prefer,
 *  type can be ADC_REF_3V3, ADC_REF_1V2 (not for Teensy LC) or ADC_REF_EXT
 */
 void ADC::setReference(ADC_REFERENCE type, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->setReference(type);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->setReference(type); // adc_num isn't changed or has selected ADC0
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->setReference(type);
+    }
 }
 
 
@@ -244,43 +145,28 @@ void ADC::setReference(ADC_REFERENCE type, int8_t adc_num) {
 *  for startSingle* or startContinous*, so whenever you change the resolution, change also the comparison values.
 */
 void ADC::setResolution(uint8_t bits, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->setResolution(bits);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->setResolution(bits); // adc_num isn't changed or has selected ADC0
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->setResolution(bits);
+    }
 }
 
 //! Returns the resolution of the ADC_Module.
 uint8_t ADC::getResolution(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->getResolution();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return 0;
     }
-    return adc0->getResolution(); // adc_num isn't changed or has selected ADC0
-
+    return module->getResolution();
 }
 
 //! Returns the maximum value for a measurement.
 uint32_t ADC::getMaxValue(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->getMaxValue();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return 1;
     }
-    return adc0->getMaxValue();
+    return module->getMaxValue();
 }
 
 
@@ -291,17 +177,10 @@ uint32_t ADC::getMaxValue(int8_t adc_num) {
 *  It recalibrates at the end.
 */
 void ADC::setConversionSpeed(ADC_CONVERSION_SPEED speed, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->setConversionSpeed(speed);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->setConversionSpeed(speed);
     }
-    adc0->setConversionSpeed(speed); // adc_num isn't changed or has selected ADC0
-    return;
-
 }
 
 
@@ -316,17 +195,10 @@ void ADC::setConversionSpeed(ADC_CONVERSION_SPEED speed, int8_t adc_num) {
 * VERY_HIGH_SPEED is the highest possible sampling speed (0 ADCK added).
 */
 void ADC::setSamplingSpeed(ADC_SAMPLING_SPEED speed, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->setSamplingSpeed(speed);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->setSamplingSpeed(speed);
     }
-    adc0->setSamplingSpeed(speed); // adc_num isn't changed or has selected ADC0
-    return;
-
 }
 
 
@@ -335,16 +207,89 @@ void ADC::setSamplingSpeed(ADC_SAMPLING_SPEED speed, int8_t adc_num) {
 * \param num can be 0, 4, 8, 16 or 32.
 */
 void ADC::setAveraging(uint8_t num, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->setAveraging(num);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->setAveraging(num); // adc_num isn't changed or has selected ADC0
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->setAveraging(num);
+    }
+}
+
+
+//! Time that a conversion takes with the current settings, in ns.
+uint32_t ADC::getConversionTimeNs(bool differential, bool continuous, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return 0;
+    }
+    return module->getConversionTimeNs(differential, continuous);
+}
+
+//! Maximum sample rate with the current settings, in Hz.
+uint32_t ADC::getMaxSampleRate(bool differential, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return 0;
+    }
+    return module->getMaxSampleRate(differential);
+}
+
+//! Choose the settings with the least noise that can convert at targetHz.
+bool ADC::configureForRate(uint32_t targetHz, bool differential, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return false;
+    }
+    return module->configureForRate(targetHz, differential);
+}
+
+// Returns the settings of the ADC
+ADC_Settings ADC::getSettings(int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return ADC_Settings();
+    }
+    return module->getSettings();
+}
+
+// Write all the settings at once
+void ADC::commit(const ADC_Settings& settings, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->commit(settings);
+    }
+}
+
+// Take the ADC for readOwned
+bool ADC::acquire(int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return false;
+    }
+    return module->acquire();
+}
+
+// Free the ADC
+void ADC::release(int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->release();
+    }
+}
+
+// Save a profile of the ADC
+void ADC::saveProfile(ADC_Module::ADC_Profile* profile, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->saveProfile(profile);
+    }
+}
+
+// Write a profile to the ADC
+bool ADC::applyProfile(const ADC_Module::ADC_Profile& profile, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return false;
+    }
+    return module->applyProfile(profile);
 }
 
 
@@ -353,30 +298,56 @@ void ADC::setAveraging(uint8_t num, int8_t adc_num) {
 *  (including hardware averages and if the comparison (if any) is true).
 */
 void ADC::enableInterrupts(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->enableInterrupts();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->enableInterrupts();
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->enableInterrupts();
+    }
 }
 
 // Disable interrupts
 void ADC::disableInterrupts(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->disableInterrupts();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->disableInterrupts();
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->disableInterrupts();
+    }
+}
+
+// Call fn when conversions are done
+bool ADC::onComplete(ADC_CompleteCallback fn, void* ctx, uint16_t batch, uint16_t* buffer, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return false;
+    }
+    return module->onComplete(fn, ctx, batch, buffer);
+}
+
+// Adds a conversion to the request queue
+bool ADC::submit(const ADC_Request& request, int8_t adc_num) {
+    ADC_Module* module;
+    #if ADC_NUM_ADCS>1
+    if( adc_num==-1 ) { // the ADC that can convert the pins and would finish first
+        const bool adc0Valid = request.differential ? adc0->checkDifferentialPins(request.pin, request.pinN) : adc0->checkPin(request.pin);
+        const bool adc1Valid = request.differential ? adc1->checkDifferentialPins(request.pin, request.pinN) : adc1->checkPin(request.pin);
+        module = selectModule(adc0Valid, adc1Valid, request.differential);
+    } else {
+        module = getModule(adc_num);
+    }
+    #else
+    module = getModule(adc_num);
+    #endif
+    if(!module) {
+        return false;
+    }
+    return module->submit(request);
+}
+
+// Number of requests in the queue
+uint8_t ADC::getQueueDepth(int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return 0;
+    }
+    return module->getQueueDepth();
 }
 
 
@@ -385,30 +356,18 @@ void ADC::disableInterrupts(int8_t adc_num) {
 *  (including hardware averages and if the comparison (if any) is true).
 */
 void ADC::enableDMA(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->enableDMA();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->enableDMA();
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->enableDMA();
+    }
 }
 
 // Disable ADC DMA request
 void ADC::disableDMA(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->disableDMA();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->disableDMA();
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->disableDMA();
+    }
 }
 
 
@@ -419,16 +378,10 @@ void ADC::disableDMA(int8_t adc_num) {
 *  Use with interrupts or poll conversion completion with isComplete()
 */
 void ADC::enableCompare(int16_t compValue, bool greaterThan, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->enableCompare(compValue, greaterThan);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->enableCompare(compValue, greaterThan);
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->enableCompare(compValue, greaterThan);
+    }
 }
 
 // Enable the compare function to a range
@@ -439,30 +392,18 @@ void ADC::enableCompare(int16_t compValue, bool greaterThan, int8_t adc_num) {
 *  Use with interrupts or poll conversion completion with isComplete()
 */
 void ADC::enableCompareRange(int16_t lowerLimit, int16_t upperLimit, bool insideRange, bool inclusive, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->enableCompareRange(lowerLimit, upperLimit, insideRange, inclusive);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->enableCompareRange(lowerLimit, upperLimit, insideRange, inclusive);
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->enableCompareRange(lowerLimit, upperLimit, insideRange, inclusive);
+    }
 }
 
 //! Disable the compare function
 void ADC::disableCompare(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->disableCompare();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->disableCompare();
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->disableCompare();
+    }
 }
 
 
@@ -473,58 +414,38 @@ void ADC::disableCompare(int8_t adc_num) {
 *
 */
 void ADC::enablePGA(uint8_t gain, int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->enablePGA(gain);
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->enablePGA(gain);
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->enablePGA(gain);
+    }
 }
 
 //! Returns the PGA level
 /** PGA level = 2^gain, from 0 to 64
 */
 uint8_t ADC::getPGA(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->getPGA();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return 1;
-        #endif
     }
-    return adc0->getPGA();
+    return module->getPGA();
 }
 
 //! Disable PGA
 void ADC::disablePGA(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->disablePGA();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
-    }
-    adc0->disablePGA();
-    return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->disablePGA();
+    }
 }
 
 //! Is the ADC converting at the moment?
 bool ADC::isConverting(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->isConverting();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->isConverting();
+    return module->isConverting();
 }
 
 // Is an ADC conversion ready?
@@ -534,41 +455,29 @@ bool ADC::isConverting(int8_t adc_num) {
 *  So it only makes sense to call it before analogReadContinuous() or readSingle()
 */
 bool ADC::isComplete(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->isComplete();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->isComplete();;
+    return module->isComplete();
 }
 
 //! Is the ADC in differential mode?
 bool ADC::isDifferential(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->isDifferential();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->isDifferential();
+    return module->isDifferential();
 }
 
 //! Is the ADC in continuous mode?
 bool ADC::isContinuous(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->isContinuous();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->isContinuous();
+    return module->isContinuous();
 }
 
 
@@ -580,47 +489,11 @@ bool ADC::isContinuous(int8_t adc_num) {
 * adc_num. If you select ADC1 in Teensy 3.0 it will return ADC_ERROR_VALUE.
 */
 int ADC::analogRead(uint8_t pin, int8_t adc_num) {
-    #if ADC_NUM_ADCS==1
-    /* Teensy 3.0, LC
-    */
-    if( adc_num==1 ) { // If asked to use ADC1, return error
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModuleForPin(pin, adc_num);
+    if(!module) {
         return ADC_ERROR_VALUE;
     }
-    return adc0->analogRead(pin); // use ADC0
-    #elif ADC_NUM_ADCS==2
-    /* Teensy 3.1
-    */
-    if( adc_num==-1 ) { // use no ADC in particular
-        // check which ADC can read the pin
-        bool adc0Pin = adc0->checkPin(pin);
-        bool adc1Pin = adc1->checkPin(pin);
-
-        if(adc0Pin && adc1Pin)  { // Both ADCs
-            if( (adc0->num_measurements) > (adc1->num_measurements)) { // use the ADC with less workload
-                return adc1->analogRead(pin);
-            } else {
-                return adc0->analogRead(pin);
-            }
-        } else if(adc0Pin) { // ADC0
-            return adc0->analogRead(pin);
-        } else if(adc1Pin) { // ADC1
-            return adc1->analogRead(pin);
-        } else { // pin not valid in any ADC
-            adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
-            adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
-            return ADC_ERROR_VALUE;   // all others are invalid
-        }
-    }
-    else if( adc_num==0 ) { // user wants ADC0
-        return adc0->analogRead(pin);
-    }
-    else if( adc_num==1 ){ // user wants ADC 1
-        return adc1->analogRead(pin);
-    }
-    adc0->fail_flag |= ADC_ERROR::OTHER;
-    return ADC_ERROR_VALUE;
-    #endif
+    return module->analogRead(pin);
 }
 
 /* Reads the differential analog value of two pins (pinP - pinN).
@@ -634,48 +507,11 @@ int ADC::analogRead(uint8_t pin, int8_t adc_num) {
 * adc_num. If you select ADC1 in Teensy 3.0 it will return ADC_ERROR_VALUE.
 */
 int ADC::analogReadDifferential(uint8_t pinP, uint8_t pinN, int8_t adc_num) {
-
-    #if ADC_NUM_ADCS==1
-    /* Teensy 3.0, LC
-    */
-    if( adc_num==1 ) { // If asked to use ADC1, return error
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModuleForDifferentialPins(pinP, pinN, adc_num);
+    if(!module) {
         return ADC_ERROR_VALUE;
     }
-    return adc0->analogReadDifferential(pinP, pinN); // use ADC0
-    #elif ADC_NUM_ADCS==2
-    /* Teensy 3.1
-    */
-    if( adc_num==-1 ) { // use no ADC in particular
-        // check which ADC can read the pin
-        bool adc0Pin = adc0->checkDifferentialPins(pinP, pinN);
-        bool adc1Pin = adc1->checkDifferentialPins(pinP, pinN);
-
-        if(adc0Pin && adc1Pin)  { // Both ADCs
-            if( (adc0->num_measurements) > (adc1->num_measurements)) { // use the ADC with less workload
-                return adc1->analogReadDifferential(pinP, pinN);
-            } else {
-                return adc0->analogReadDifferential(pinP, pinN);
-            }
-        } else if(adc0Pin) { // ADC0
-            return adc0->analogReadDifferential(pinP, pinN);
-        } else if(adc1Pin) { // ADC1
-            return adc1->analogReadDifferential(pinP, pinN);
-        } else { // pins not valid in any ADC
-            adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
-            adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
-            return ADC_ERROR_VALUE;   // all others are invalid
-        }
-    }
-    else if( adc_num==0 ) { // user wants ADC0
-        return adc0->analogReadDifferential(pinP, pinN);
-    }
-    else if( adc_num==1 ){ // user wants ADC 1
-        return adc1->analogReadDifferential(pinP, pinN);
-    }
-    adc0->fail_flag |= ADC_ERROR::OTHER;
-    return ADC_ERROR_VALUE;
-    #endif
+    return module->analogReadDifferential(pinP, pinN);
 }
 
 
@@ -683,51 +519,15 @@ int ADC::analogReadDifferential(uint8_t pinP, uint8_t pinN, int8_t adc_num) {
 /* It returns immediately, get value with readSingle().
 *   If the pin is incorrect it returns ADC_ERROR_VALUE
 *   This function is interrupt safe. The ADC interrupt will restore the adc to its previous settings and
-*   restart the adc if it stopped a measurement. If you modify the adc_isr then this won't happen.
+*   restart the adc if it stopped a measurement. This is done by the library if you use onComplete,
+*   if you write your own adc_isr load adc_config there when adcWasInUse is true.
 */
 bool ADC::startSingleRead(uint8_t pin, int8_t adc_num) {
-    #if ADC_NUM_ADCS==1
-    /* Teensy 3.0, LC
-    */
-    if( adc_num==1 ) { // If asked to use ADC1, return error
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModuleForPin(pin, adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->startSingleRead(pin); // use ADC0
-    #elif ADC_NUM_ADCS==2
-    /* Teensy 3.1
-    */
-    if( adc_num==-1 ) { // use no ADC in particular
-        // check which ADC can read the pin
-        bool adc0Pin = adc0->checkPin(pin);
-        bool adc1Pin = adc1->checkPin(pin);
-
-        if(adc0Pin && adc1Pin)  { // Both ADCs
-
-            if( (adc0->num_measurements) > (adc1->num_measurements)) { // use the ADC with less workload
-                return adc1->startSingleRead(pin);
-            } else {
-                return adc0->startSingleRead(pin);
-            }
-        } else if(adc0Pin) { // ADC0
-            return adc0->startSingleRead(pin);
-        } else if(adc1Pin) { // ADC1
-            return adc1->startSingleRead(pin);
-        } else { // pin not valid in any ADC
-            adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
-            adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
-            return false;   // all others are invalid
-        }
-    }
-    else if( adc_num==0 ) { // user wants ADC0
-        return adc0->startSingleRead(pin);
-    }
-    else if( adc_num==1 ){ // user wants ADC 1
-        return adc1->startSingleRead(pin);
-    }
-    adc0->fail_flag |= ADC_ERROR::OTHER;
-    return false;
-    #endif
+    return module->startSingleRead(pin);
 }
 
 // Start a differential conversion between two pins (pinP - pinN) and enables interrupts.
@@ -736,50 +536,15 @@ bool ADC::startSingleRead(uint8_t pin, int8_t adc_num) {
 *   \param pinN must be A11 (if pinP=A10) or A13 (if pinP=A12).
 *   Other pins will return ADC_ERROR_DIFF_VALUE.
 *   This function is interrupt safe. The ADC interrupt will restore the adc to its previous settings and
-*   restart the adc if it stopped a measurement. If you modify the adc_isr then this won't happen.
+*   restart the adc if it stopped a measurement. This is done by the library if you use onComplete,
+*   if you write your own adc_isr load adc_config there when adcWasInUse is true.
 */
 bool ADC::startSingleDifferential(uint8_t pinP, uint8_t pinN, int8_t adc_num) {
-    #if ADC_NUM_ADCS==1
-    /* Teensy 3.0, LC
-    */
-    if( adc_num==1 ) { // If asked to use ADC1, return error
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModuleForDifferentialPins(pinP, pinN, adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->startSingleDifferential(pinP, pinN); // use ADC0
-    #elif ADC_NUM_ADCS==2
-    /* Teensy 3.1
-    */
-    if( adc_num==-1 ) { // use no ADC in particular
-        // check which ADC can read the pin
-        bool adc0Pin = adc0->checkDifferentialPins(pinP, pinN);
-        bool adc1Pin = adc1->checkDifferentialPins(pinP, pinN);
-
-        if(adc0Pin && adc1Pin)  { // Both ADCs
-            if( (adc0->num_measurements) > (adc1->num_measurements)) { // use the ADC with less workload
-                return adc1->startSingleDifferential(pinP, pinN);
-            } else {
-                return adc0->startSingleDifferential(pinP, pinN);
-            }
-        } else if(adc0Pin) { // ADC0
-            return adc0->startSingleDifferential(pinP, pinN);
-        } else if(adc1Pin) { // ADC1
-            return adc1->startSingleDifferential(pinP, pinN);
-        } else { // pins not valid in any ADC
-            adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
-            adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
-            return false;   // all others are invalid
-        }
-    }
-    else if( adc_num==0 ) { // user wants ADC0
-        return adc0->startSingleDifferential(pinP, pinN);
-    }
-    else if( adc_num==1 ){ // user wants ADC 1
-        return adc1->startSingleDifferential(pinP, pinN);
-    }
-    adc0->fail_flag |= ADC_ERROR::OTHER;
-    return false;
-    #endif
+    return module->startSingleDifferential(pinP, pinN);
 }
 
 // Reads the analog value of a single conversion.
@@ -787,15 +552,11 @@ bool ADC::startSingleDifferential(uint8_t pinP, uint8_t pinN, int8_t adc_num) {
 *   \return the converted value.
 */
 int ADC::readSingle(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        return adc1->readSingle();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return ADC_ERROR_VALUE;
-        #endif
     }
-    return adc0->readSingle();
+    return module->readSingle();
 }
 
 
@@ -803,48 +564,11 @@ int ADC::readSingle(int8_t adc_num) {
 /* It returns as soon as the ADC is set, use analogReadContinuous() to read the value.
 */
 bool ADC::startContinuous(uint8_t pin, int8_t adc_num) {
-
-    #if ADC_NUM_ADCS==1
-    /* Teensy 3.0, LC
-    */
-    if( adc_num==1 ) { // If asked to use ADC1, return error
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModuleForPin(pin, adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->startContinuous(pin); // use ADC0
-    #elif ADC_NUM_ADCS==2
-    /* Teensy 3.1
-    */
-    if( adc_num==-1 ) { // use no ADC in particular
-        // check which ADC can read the pin
-        bool adc0Pin = adc0->checkPin(pin);
-        bool adc1Pin = adc1->checkPin(pin);
-
-        if(adc0Pin && adc1Pin)  { // Both ADCs
-            if( (adc0->num_measurements) > (adc1->num_measurements)) { // use the ADC with less workload
-                return adc1->startContinuous(pin);
-            } else {
-                return adc0->startContinuous(pin);
-            }
-        } else if(adc0Pin) { // ADC0
-            return adc0->startContinuous(pin);
-        } else if(adc1Pin) { // ADC1
-            return adc1->startContinuous(pin);
-        } else { // pin not valid in any ADC
-            adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
-            adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
-            return false;   // all others are invalid
-        }
-    }
-    else if( adc_num==0 ) { // user wants ADC0
-        return adc0->startContinuous(pin);
-    }
-    else if( adc_num==1 ){ // user wants ADC 1
-        return adc1->startContinuous(pin);
-    }
-    adc0->fail_flag |= ADC_ERROR::OTHER;
-    return false;
-    #endif
+    return module->startContinuous(pin);
 }
 
 // Starts continuous conversion between the pins (pinP-pinN).
@@ -854,47 +578,11 @@ bool ADC::startContinuous(uint8_t pin, int8_t adc_num) {
 * Other pins will return ADC_ERROR_DIFF_VALUE.
 */
 bool ADC::startContinuousDifferential(uint8_t pinP, uint8_t pinN, int8_t adc_num) {
-    #if ADC_NUM_ADCS==1
-    /* Teensy 3.0, LC
-    */
-    if( adc_num==1 ) { // If asked to use ADC1, return error
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+    ADC_Module* module = getModuleForDifferentialPins(pinP, pinN, adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->startContinuousDifferential(pinP, pinN); // use ADC0
-    #elif ADC_NUM_ADCS==2
-    /* Teensy 3.1
-    */
-    if( adc_num==-1 ) { // use no ADC in particular
-        // check which ADC can read the pin
-        bool adc0Pin = adc0->checkDifferentialPins(pinP, pinN);
-        bool adc1Pin = adc1->checkDifferentialPins(pinP, pinN);
-
-        if(adc0Pin && adc1Pin)  { // Both ADCs
-            if( (adc0->num_measurements) > (adc1->num_measurements)) { // use the ADC with less workload
-                return adc1->startContinuousDifferential(pinP, pinN);
-            } else {
-                return adc0->startContinuousDifferential(pinP, pinN);
-            }
-        } else if(adc0Pin) { // ADC0
-            return adc0->startContinuousDifferential(pinP, pinN);
-        } else if(adc1Pin) { // ADC1
-            return adc1->startContinuousDifferential(pinP, pinN);
-        } else { // pins not valid in any ADC
-            adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
-            adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
-            return false;   // all others are invalid
-        }
-    }
-    else if( adc_num==0 ) { // user wants ADC0
-        return adc0->startContinuousDifferential(pinP, pinN);
-    }
-    else if( adc_num==1 ){ // user wants ADC 1
-        return adc1->startContinuousDifferential(pinP, pinN);
-    }
-    adc0->fail_flag |= ADC_ERROR::OTHER;
-    return false;
-    #endif
+    return module->startContinuousDifferential(pinP, pinN);
 }
 
 //! Reads the analog value of a continuous conversion.
@@ -904,29 +592,64 @@ bool ADC::startContinuousDifferential(uint8_t pinP, uint8_t pinN, int8_t adc_num
 *   otherwise values larger than 3.3/2 V are interpreted as negative!
 */
 int ADC::analogReadContinuous(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2
-        return adc1->analogReadContinuous();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
         return false;
     }
-    return adc0->analogReadContinuous();
+    return module->analogReadContinuous();
 }
 
 //! Stops continuous conversion
 void ADC::stopContinuous(int8_t adc_num) {
-    if(adc_num==1){ // user wants ADC 1, do nothing if it's a Teensy 3.0
-        #if ADC_NUM_ADCS>=2 // Teensy 3.1
-        adc1->stopContinuous();
-        #else
-        adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
-        #endif
-        return;
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->stopContinuous();
     }
-    adc0->stopContinuous();
-    return;
+}
+
+
+
+///////////// SCAN METHODS ////////////
+
+/* Starts converting the pins one after the other
+* The results are stored in dst, see ADC_Module::startScan
+*/
+bool ADC::startScan(const uint8_t* pins, uint8_t num_pins, volatile uint16_t* dst, uint32_t frames, int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    #if ADC_NUM_ADCS>1
+    if( adc_num==-1 ) { // use the ADC that can read all pins
+        bool adc0Pins = true;
+        bool adc1Pins = true;
+        for(uint8_t i=0; i<num_pins; i++) {
+            adc0Pins = adc0Pins && adc0->checkPin(pins[i]);
+            adc1Pins = adc1Pins && adc1->checkPin(pins[i]);
+        }
+        module = selectModule(adc0Pins, adc1Pins);
+    }
+    #endif
+    if(!module) {
+        return false;
+    }
+    return module->startScan(pins, num_pins, dst, frames);
+}
+
+/* Stops the scan
+*/
+void ADC::stopScan(int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(module) {
+        module->stopScan();
+    }
+}
+
+/* Is a scan in progress?
+*/
+bool ADC::isScanning(int8_t adc_num) {
+    ADC_Module* module = getModule(adc_num);
+    if(!module) {
+        return false;
+    }
+    return module->isScanning();
 }
 
 
@@ -959,7 +682,7 @@ ADC::Sync_result ADC::analogSynchronizedRead(uint8_t pin0, uint8_t pin1) {
 
     // check if we are interrupting a measurement, store setting if so.
     // vars to save the current state of the ADC in case it's in use
-    ADC_Module::ADC_Config old_adc0_config = {0};
+    ADC_Module::ADC_Config old_adc0_config = {};
     uint8_t wasADC0InUse = adc0->isConverting(); // is the ADC running now?
     if(wasADC0InUse) { // this means we're interrupting a conversion
         // save the current conversion config, the adc isr will restore the adc
@@ -968,7 +691,7 @@ ADC::Sync_result ADC::analogSynchronizedRead(uint8_t pin0, uint8_t pin1) {
         adc0->saveConfig(&old_adc0_config);
         __enable_irq();
     }
-    ADC_Module::ADC_Config old_adc1_config = {0};
+    ADC_Module::ADC_Config old_adc1_config = {};
     uint8_t wasADC1InUse = adc1->isConverting(); // is the ADC running now?
     if(wasADC1InUse) { // this means we're interrupting a conversion
         // save the current conversion config, the adc isr will restore the adc
@@ -1046,7 +769,7 @@ ADC::Sync_result ADC::analogSynchronizedReadDifferential(uint8_t pin0P, uint8_t
 
     // check if we are interrupting a measurement, store setting if so.
     // vars to save the current state of the ADC in case it's in use
-    ADC_Module::ADC_Config old_adc0_config = {0};
+    ADC_Module::ADC_Config old_adc0_config = {};
     uint8_t wasADC0InUse = adc0->isConverting(); // is the ADC running now?
     if(wasADC0InUse) { // this means we're interrupting a conversion
         // save the current conversion config, the adc isr will restore the adc
@@ -1055,7 +778,7 @@ ADC::Sync_result ADC::analogSynchronizedReadDifferential(uint8_t pin0P, uint8_t
         adc0->saveConfig(&old_adc0_config);
         __enable_irq();
     }
-    ADC_Module::ADC_Config old_adc1_config = {0};
+    ADC_Module::ADC_Config old_adc1_config = {};
     uint8_t wasADC1InUse = adc1->isConverting(); // is the ADC running now?
     if(wasADC1InUse) { // this means we're interrupting a conversion
         // save the current conversion config, the adc isr will restore the adc
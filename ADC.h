@@ -28,7 +28,6 @@
  */
 
 /* TODO
-* - Function to measure more that 1 pin consecutively (stream?)
 *
 * bugs:
 * - comparison values in 16 bit differential mode are twice what they should be
@@ -43,10 +42,8 @@
 
 // include ADC module class
 #include "ADC_Module.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
+// and the PDB counter they share
+#include "PDBTimebase.h"
 
 /** Class ADC: Controls the Teensy 3.x ADC
 *
@@ -65,6 +62,33 @@ class ADC
         //! Number of ADC objects
         const uint8_t num_ADCs = ADC_NUM_ADCS;
 
+        //! Get the ADC module adc_num (-1 means ADC0)
+        /** If the board doesn't have it (or adc_num isn't -1, 0 or 1), it sets the WRONG_ADC error of ADC0 and returns nullptr
+        */
+        ADC_Module* getModule(int8_t adc_num) __attribute__((always_inline)) {
+            if( (adc_num==0) || (adc_num==-1) ) {
+                return adc0;
+            }
+            #if ADC_NUM_ADCS>1
+            if(adc_num==1) {
+                return adc1;
+            }
+            #endif
+            adc0->fail_flag |= ADC_ERROR::WRONG_ADC;
+            return nullptr;
+        }
+
+        #if ADC_NUM_ADCS>1
+        //! ADC that can measure the pins, if both can the one that would finish first (see ADC_Module::getCompletionTimeNs), nullptr if none can
+        ADC_Module* selectModule(bool adc0Valid, bool adc1Valid, bool differential = false);
+        #endif
+
+        //! ADC that should measure the pin, see getModule and selectModule
+        ADC_Module* getModuleForPin(uint8_t pin, int8_t adc_num);
+
+        //! ADC that should measure the differential pins, see getModule and selectModule
+        ADC_Module* getModuleForDifferentialPins(uint8_t pinP, uint8_t pinN, int8_t adc_num);
+
 
     public:
 
@@ -87,6 +111,25 @@ class ADC
         ADC_Module *const adc[ADC_NUM_ADCS] = {adc0, adc1};
         #endif
 
+        #if ADC_USE_PDB
+        //! The PDB counter, shared by both ADCs (see PDBTimebase)
+        PDBTimebase *const pdb = &PDBTimebase::pdb0;
+        #endif
+
+        //! ADC module adc_num, selected at compile time
+        /** Use it to call any method of ADC_Module without checking adc_num at runtime: adc->module<ADC_1>().setResolution(12);
+        *   Asking for ADC_1 in a board with only one ADC is a compile error.
+        */
+        template<int8_t adc_num>
+        ADC_Module& module() {
+            static_assert((adc_num>=0) && (adc_num<ADC_NUM_ADCS), "ADC: this board doesn't have that ADC module");
+            #if ADC_NUM_ADCS>1
+            return (adc_num==0) ? adc0_obj : adc1_obj;
+            #else
+            return adc0_obj;
+            #endif
+        }
+
 
         /////////////// METHODS TO SET/GET SETTINGS OF THE ADC ////////////////////
 
@@ -169,6 +212,77 @@ class ADC
         void setAveraging(uint8_t num, int8_t adc_num = -1);
 
 
+        //! Time that a conversion takes with the current settings.
+        /** The time the code takes to start the conversion and read the result is not included.
+        *   \param differential true for differential conversions, which take longer.
+        *   \param continuous true for the second and following continuous conversions,
+        *          false for single (software or hardware triggered) conversions and the first continuous one.
+        *   \param adc_num ADC number to query.
+        *   \return the conversion time in ns.
+        */
+        uint32_t getConversionTimeNs(bool differential = false, bool continuous = false, int8_t adc_num = -1);
+
+        //! Maximum rate of single (triggered) conversions with the current settings.
+        /**
+        *   \param differential true for differential conversions.
+        *   \param adc_num ADC number to query.
+        *   \return the maximum rate in Hz.
+        */
+        uint32_t getMaxSampleRate(bool differential = false, int8_t adc_num = -1);
+
+        //! Choose the averages, conversion and sampling speed with the least noise that can convert at targetHz.
+        /** More averages are preferred, then the slowest conversion and sampling speed that is fast enough.
+        *   The resolution isn't changed. If targetHz can't be reached the settings are not changed.
+        *   \param targetHz rate of single (triggered) conversions in Hz.
+        *   \param differential true for differential conversions.
+        *   \param adc_num ADC number to change.
+        *   \return true if the settings meet targetHz.
+        */
+        bool configureForRate(uint32_t targetHz, bool differential = false, int8_t adc_num = -1);
+
+        //! Returns the resolution, averaging, speeds and reference of the ADC.
+        /** Change them and pass them to commit to write all of them at once.
+        *   \param adc_num ADC number to query.
+        *   \return the settings, the library defaults if the ADC doesn't exist.
+        */
+        ADC_Settings getSettings(int8_t adc_num = -1);
+
+        //! Writes the settings to the ADC, each register at most once.
+        /**
+        *   \param settings settings to apply.
+        *   \param adc_num ADC number to change.
+        */
+        void commit(const ADC_Settings& settings, int8_t adc_num = -1);
+
+        //! Takes the ADC for exclusive use with readOwned
+        /** See ADC_Module::acquire. Read with adc->adc0->readOwned(pin) (or adc1), the ADC object doesn't add any overhead then.
+        *   \param adc_num ADC number to take.
+        *   \return true if the ADC is now owned by the caller.
+        */
+        bool acquire(int8_t adc_num = -1);
+
+        //! Frees the ADC taken with acquire
+        /**
+        *   \param adc_num ADC number to free.
+        */
+        void release(int8_t adc_num = -1);
+
+        //! Save the settings, compare, PGA and calibration of the ADC to a profile
+        /** See ADC_Module::saveProfile.
+        *   \param profile where to store them.
+        *   \param adc_num ADC number to save.
+        */
+        void saveProfile(ADC_Module::ADC_Profile* profile, int8_t adc_num = -1);
+
+        //! Write a profile saved by saveProfile to the ADC
+        /** See ADC_Module::applyProfile.
+        *   \param profile profile to apply, saved from the same ADC.
+        *   \param adc_num ADC number to change.
+        *   \return true if it was applied.
+        */
+        bool applyProfile(const ADC_Module::ADC_Profile& profile, int8_t adc_num = -1);
+
+
         //! Enable interrupts
         /** An IRQ_ADCx Interrupt will be raised when the conversion is completed
         *  (including hardware averages and if the comparison (if any) is true).
@@ -182,6 +296,32 @@ class ADC
         */
         void disableInterrupts(int8_t adc_num = -1);
 
+        //! Calls fn from the ADC interrupt when a conversion, or batch conversions, are done
+        /** See ADC_Module::onComplete, don't define adcX_isr when using it.
+        *   \param fn function to call, nullptr removes it.
+        *   \param ctx pointer passed to fn.
+        *   \param batch number of results for each call to fn.
+        *   \param buffer where the results are kept until fn is called, it must hold batch values. It can be nullptr if batch is 1.
+        *   \param adc_num ADC number to use.
+        *   \return false if the batch or buffer are wrong.
+        */
+        bool onComplete(ADC_CompleteCallback fn, void* ctx = nullptr, uint16_t batch = 1, uint16_t* buffer = nullptr, int8_t adc_num = -1);
+
+        //! Adds a conversion to the request queue of an ADC
+        /** See ADC_Module::submit.
+        *   \param request pin(s), priority and callback.
+        *   \param adc_num ADC number to use, -1 selects the one that can convert the pins and would finish first.
+        *   \return true if it was added.
+        */
+        bool submit(const ADC_Request& request, int8_t adc_num = -1);
+
+        //! Number of requests in the queue of an ADC, including the one being converted
+        /**
+        *   \param adc_num ADC number to query.
+        *   \return number of requests.
+        */
+        uint8_t getQueueDepth(int8_t adc_num = -1);
+
 
         //! Enable DMA request
         /** An ADC DMA request will be raised when the conversion is completed
@@ -394,6 +534,133 @@ class ADC
         void stopContinuous(int8_t adc_num = -1);
 
 
+        ///////////// CONVERSION METHODS WITH COMPILE TIME ADC SELECTION ////////////
+        /* Same as the methods above, but the ADC is selected at compile time: adc->analogRead<ADC_1>(pin).
+        *  There's no check of adc_num at runtime, asking for ADC_1 in a board with only one ADC is a compile error.
+        *  For other methods use module<adc_num>().
+        */
+
+        //! Returns the analog value of the pin measured by ADC adc_num, see analogRead(pin, adc_num)
+        template<int8_t adc_num>
+        int analogRead(uint8_t pin) {
+            return module<adc_num>().analogRead(pin);
+        }
+
+        //! Returns the differential value of the pins measured by ADC adc_num, see analogReadDifferential(pinP, pinN, adc_num)
+        template<int8_t adc_num>
+        int analogReadDifferential(uint8_t pinP, uint8_t pinN) {
+            return module<adc_num>().analogReadDifferential(pinP, pinN);
+        }
+
+        //! Starts an analog measurement on the pin with ADC adc_num, see startSingleRead(pin, adc_num)
+        template<int8_t adc_num>
+        bool startSingleRead(uint8_t pin) {
+            return module<adc_num>().startSingleRead(pin);
+        }
+
+        //! Starts a differential measurement on the pins with ADC adc_num, see startSingleDifferential(pinP, pinN, adc_num)
+        template<int8_t adc_num>
+        bool startSingleDifferential(uint8_t pinP, uint8_t pinN) {
+            return module<adc_num>().startSingleDifferential(pinP, pinN);
+        }
+
+        //! Reads the analog value of a single conversion of ADC adc_num
+        template<int8_t adc_num>
+        int readSingle() {
+            return module<adc_num>().readSingle();
+        }
+
+        //! Starts continuous conversion on the pin with ADC adc_num, see startContinuous(pin, adc_num)
+        template<int8_t adc_num>
+        bool startContinuous(uint8_t pin) {
+            return module<adc_num>().startContinuous(pin);
+        }
+
+        //! Starts continuous differential conversion on the pins with ADC adc_num
+        template<int8_t adc_num>
+        bool startContinuousDifferential(uint8_t pinP, uint8_t pinN) {
+            return module<adc_num>().startContinuousDifferential(pinP, pinN);
+        }
+
+        //! Reads the analog value of a continuous conversion of ADC adc_num
+        template<int8_t adc_num>
+        int analogReadContinuous() {
+            return module<adc_num>().analogReadContinuous();
+        }
+
+        //! Stops continuous conversion of ADC adc_num
+        template<int8_t adc_num>
+        void stopContinuous() {
+            module<adc_num>().stopContinuous();
+        }
+
+
+        ///////////// CONVERSION METHODS WITH COMPILE TIME PIN ////////////
+        /* The pin is checked and translated to its SC1A number at compile time: adc->analogRead<A9, ADC_0>().
+        *  A pin that the ADC can't measure is a compile error.
+        */
+
+        //! SC1A number (with the mux info) of the pin in ADC adc_num, ADC_SC1A_PIN_INVALID if it can't measure it
+        static constexpr uint8_t getSC1A(uint8_t pin, int8_t adc_num) {
+            return (pin>ADC_MAX_PIN) ? ADC_SC1A_PIN_INVALID :
+                #if ADC_NUM_ADCS>1
+                (adc_num==1) ? channel2sc1aADC1[pin] :
+                #endif
+                channel2sc1aADC0[pin];
+        }
+
+        //! Can ADC adc_num measure the pin?
+        static constexpr bool isValidPin(uint8_t pin, int8_t adc_num) {
+            return (getSC1A(pin, adc_num)&ADC_SC1A_CHANNELS) != ADC_SC1A_PIN_INVALID;
+        }
+
+        //! Returns the analog value of the pin measured by ADC adc_num, see analogRead(pin, adc_num)
+        template<uint8_t pin, int8_t adc_num>
+        int analogRead() {
+            static_assert(isValidPin(pin, adc_num), "ADC: this ADC module can't measure the pin");
+            constexpr uint8_t sc1a_pin = getSC1A(pin, adc_num);
+            return module<adc_num>().analogReadSC1A(sc1a_pin);
+        }
+
+        //! Starts a single-ended conversion on the pin with ADC adc_num, see ADC_Module::startReadFast
+        /** It doesn't change the continuous conversion bit and doesn't save the ADC config.
+        */
+        template<uint8_t pin, int8_t adc_num>
+        void startReadFast() {
+            static_assert(isValidPin(pin, adc_num), "ADC: this ADC module can't measure the pin");
+            constexpr uint8_t sc1a_pin = getSC1A(pin, adc_num);
+            module<adc_num>().startReadFastSC1A(sc1a_pin);
+        }
+
+
+        ///////////// SCAN METHODS ////////////
+
+        //! Starts converting the pins one after the other, back to back.
+        /** Call adc->adcX->scanStep() inside adcX_isr to store each result and start the next conversion.
+        *   dst[frame*num_pins + i] is the value of pins[i] in that frame.
+        *   \param pins single-ended pins to convert.
+        *   \param num_pins number of pins, up to ADC_MAX_SCAN_PINS.
+        *   \param dst buffer for the results, it must hold num_pins*frames values.
+        *   \param frames number of times to scan all pins.
+        *   \param adc_num ADC_X ADC module, if -1 the ADC that can read all pins with less workload.
+        *   \return true if the pins are valid, false otherwise.
+        */
+        bool startScan(const uint8_t* pins, uint8_t num_pins, volatile uint16_t* dst, uint32_t frames = 1, int8_t adc_num = -1);
+
+        //! Stops the scan
+        /**
+        *   \param adc_num ADC_X ADC module
+        */
+        void stopScan(int8_t adc_num = -1);
+
+        //! Is a scan in progress?
+        /**
+        *   \param adc_num ADC_X ADC module
+        *   \return true if it is, false when all frames are done.
+        */
+        bool isScanning(int8_t adc_num = -1);
+
+
 
         /////////// SYNCHRONIZED METHODS ///////////////
         ///// ONLY FOR BOARDS WITH MORE THAN ONE ADC /////
@@ -502,7 +769,7 @@ class ADC
         bool startSynchronizedContinuousDifferential(uint8_t pin0P, uint8_t pin0N, uint8_t pin1P, uint8_t pin1N);
 
         //! Returns the values of both ADCs.
-        /**
+        /** To capture every pair of values at a fixed rate, without reading them one by one, use SyncDMA.
         *   \return the converted value.
         */
         Sync_result readSynchronizedContinuous();
@@ -529,38 +796,169 @@ class ADC
         }
 
 
-        //! Translate pin number to SC1A nomenclature
-        // should this be a constexpr?
-        static const uint8_t channel2sc1aADC0[ADC_MAX_PIN+1];
-        #if ADC_NUM_ADCS>1
-        //! Translate pin number to SC1A nomenclature
-        static const uint8_t channel2sc1aADC1[ADC_MAX_PIN+1];
-        #endif
+        // translate pin number to SC1A nomenclature and viceversa
+        // they are constexpr so the pin of analogRead<pin, adc_num>() can be checked and translated at compile time.
+        /* channel2sc1aADCx converts a pin number to their value for the SC1A register, for the ADC0 and ADC1
+        *  numbers with +ADC_SC1A_PIN_MUX (128) means those pins use mux a, the rest use mux b.
+        *  numbers with +ADC_SC1A_PIN_DIFF (64) means it's also a differential pin (treated also in the channel2sc1a_diff_ADCx)
+        *  For diff_table_ADCx, +ADC_SC1A_PIN_PGA means the pin can use PGA on that ADC
+        */
 
-        //! Translate pin number to SC1A nomenclature for differential pins
-        static const uint8_t sc1a2channelADC0[ADC_MAX_PIN+1];
-        #if ADC_NUM_ADCS>1
-        //! Translate pin number to SC1A nomenclature for differential pins
-        static const uint8_t sc1a2channelADC1[ADC_MAX_PIN+1];
+        ///////// ADC0
+        #if defined(ADC_TEENSY_3_0)
+        static constexpr uint8_t channel2sc1aADC0[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 0, 19, 3, 21, // 0-13, we treat them as A0-A13
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
+            31, 31, 31, 31, 31, 31, 31, 31, 31, 31, // 24-33
+            0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 3+ADC_SC1A_PIN_DIFF, 21+ADC_SC1A_PIN_DIFF, // 34-37 (A10-A13)
+            26, 22, 23, 27, 29, 30 // 38-43: temp. sensor, VREF_OUT, A14, bandgap, VREFH, VREFL. A14 isn't connected to anything in Teensy 3.0.
+        };
+        #elif defined(ADC_TEENSY_3_1) // the only difference with 3.0 is that A13 is not connected to ADC0 and that T3.1 has PGA.
+        static constexpr uint8_t channel2sc1aADC0[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 0, 19, 3, 31, // 0-13, we treat them as A0-A13
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
+            31, 31, 31, 31, 31, 31, 31, 31, 31, 31, // 24-33
+            0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, // 34-37 (A10-A13)
+            26, 22, 23, 27, 29, 30 // 38-43: temp. sensor, VREF_OUT, A14, bandgap, VREFH, VREFL. A14 isn't connected to anything in Teensy 3.0.
+        };
+        #elif defined(ADC_TEENSY_LC)
+        // Teensy LC
+        static constexpr uint8_t channel2sc1aADC0[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 11, 0, 4+ADC_SC1A_PIN_MUX, 23, 31, // 0-13, we treat them as A0-A12 + A13= doesn't exist
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 11, // 14-23 (A0-A9)
+            0+ADC_SC1A_PIN_DIFF, 4+ADC_SC1A_PIN_MUX+ADC_SC1A_PIN_DIFF, 23, 31, 31, 31, 31, 31, 31, 31, // 24-33 ((A10-A12) + nothing), A11 uses mux a
+            31, 31, 31, 31, // 34-37 nothing
+            26, 27, 31, 27, 29, 30 // 38-43: temp. sensor, , , bandgap, VREFH, VREFL.
+        };
+        #elif defined(ADC_TEENSY_3_5)
+        static constexpr uint8_t channel2sc1aADC0[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 3, 31, 31, 31, // 0-13, we treat them as A0-A13
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
+            26, 27, 29, 30, 31, 31, 31, // 24-30: Temp_Sensor, bandgap, VREFH, VREFL.
+            31, 31, 17, 18,// 31-34 A12(ADC1), A13(ADC1), A14, A15
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 35-43
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 44-52
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
+            31, 31, 3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, 23, 31, 1, 31 // 62-69 64: A10, 65: A11 (NOT CONNECTED), 66: A21, 68: A25 (no diff)
+        };
+        #elif defined(ADC_TEENSY_3_6)
+        static constexpr uint8_t channel2sc1aADC0[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 3, 31, 31, 31, // 0-13, we treat them as A0-A13
+            5, 14, 8, 9, 13, 12, 6, 7, 15, 4, // 14-23 (A0-A9)
+            26, 27, 29, 30, 31, 31, 31, // 24-30: Temp_Sensor, bandgap, VREFH, VREFL.
+            31, 31, 17, 18,// 31-34 A12(ADC1), A13(ADC1), A14, A15
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 35-43
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 44-52
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
+            31, 31, 3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, 23, 31 // 62-67 64: A10, 65: A11 (NOT CONNECTED), 66: A21, 67: A22(ADC1)
+        };
+        #endif // defined
+
+        ///////// ADC1
+        #if defined(ADC_TEENSY_3_1)
+        static constexpr uint8_t channel2sc1aADC1[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            31, 31, 8, 9, 31, 31, 31, 31, 31, 31, 3, 31, 0, 19, // 0-13, we treat them as A0-A13
+            31, 31, 8, 9, 31, 31, 31, 31, 31, 31, // 14-23 (A0-A9)
+            31, 31,  // 24,25 are digital only pins
+            5+ADC_SC1A_PIN_MUX, 5, 4, 6, 7, 4+ADC_SC1A_PIN_MUX, 31, 31, // 26-33 26=5a, 27=5b, 28=4b, 29=6b, 30=7b, 31=4a, 32,33 are digital only
+            3+ADC_SC1A_PIN_DIFF, 31+ADC_SC1A_PIN_DIFF, 0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, // 34-37 (A10-A13) A11 isn't connected.
+            26, 18, 31, 27, 29, 30 // 38-43: temp. sensor, VREF_OUT, A14 (not connected), bandgap, VREFH, VREFL.
+        };
+        #elif defined(ADC_TEENSY_3_5)
+        static constexpr uint8_t channel2sc1aADC1[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            31, 31, 8, 9, 31, 31, 31, 31, 31, 31, 31, 19, 14, 15, // 0-13, we treat them as A0-A13
+            31, 31, 8, 9, 31, 31, 31, 31, 31, 31, // 14-23 (A0-A9)
+            26, 27, 29, 30, 18, 31, 31,  // 24-30: Temp_Sensor, bandgap, VREFH, VREFL, VREF_OUT
+            14, 15, 31, 31, 4, 5, 6, 7, 17, // 31-39 A12-A20
+            31, 31, 31, 31, // 40-43
+            31, 31, 31, 31, 31, 10, 11, 31, 31, // 44-52, 49: A23, 50: A24
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
+            31, 31, 0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 31, 23, 31, 1 // 62-69 64: A10, 65: A11, 67: A22, 69: A26 (not diff)
+        };
+        #elif defined(ADC_TEENSY_3_6)
+        static constexpr uint8_t channel2sc1aADC1[ADC_MAX_PIN+1] = { // new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
+            31, 31, 8, 9, 31, 31, 31, 31, 31, 31, 31, 19, 14, 15, // 0-13, we treat them as A0-A13
+            31, 31, 8, 9, 31, 31, 31, 31, 31, 31, // 14-23 (A0-A9)
+            26, 27, 29, 30, 18, 31, 31,  // 24-30: Temp_Sensor, bandgap, VREFH, VREFL, VREF_OUT
+            14, 15, 31, 31, 4, 5, 6, 7, 17, // 31-39 A12-A20
+            31, 31, 31, 23, // 40-43: A10(ADC0), A11(ADC0), A21, A22
+            31, 31, 31, 31, 31, 10, 11, 31, 31, // 44-52, 49: A23, 50: A24
+            31, 31, 31, 31, 31, 31, 31, 31, 31, // 53-61
+            31, 31, 0+ADC_SC1A_PIN_DIFF, 19+ADC_SC1A_PIN_DIFF, 31, 23 // 61-67 64: A10, 65: A11, 66: A21(ADC0), 67: A22
+        };
         #endif
 
-
-        //! Translate differential pin number to SC1A nomenclature
-        static const ADC_Module::ADC_NLIST diff_table_ADC0[ADC_DIFF_PAIRS];
-        #if ADC_NUM_ADCS>1
-        //! Translate differential pin number to SC1A nomenclature
-        static const ADC_Module::ADC_NLIST diff_table_ADC1[ADC_DIFF_PAIRS];
+        #if defined(ADC_TEENSY_3_1) // Teensy 3.1
+        static constexpr ADC_Module::ADC_NLIST diff_table_ADC0[ADC_DIFF_PAIRS] = {
+            {A10, 0+ADC_SC1A_PIN_PGA}, {A12, 3}
+        };
+        static constexpr ADC_Module::ADC_NLIST diff_table_ADC1[ADC_DIFF_PAIRS] = {
+            {A10, 3}, {A12, 0+ADC_SC1A_PIN_PGA}
+        };
+        #elif defined(ADC_TEENSY_3_0) // Teensy 3.0
+        static constexpr ADC_Module::ADC_NLIST diff_table_ADC0[ADC_DIFF_PAIRS] = {
+            {A10, 0}, {A12, 3}
+        };
+        #elif defined(ADC_TEENSY_LC) // Teensy LC
+        static constexpr ADC_Module::ADC_NLIST diff_table_ADC0[ADC_DIFF_PAIRS] = {
+            {A10, 0}
+        };
+        #elif defined(ADC_TEENSY_3_5) || defined(ADC_TEENSY_3_6) // Teensy 3.6// Teensy 3.5
+        static constexpr ADC_Module::ADC_NLIST diff_table_ADC0[ADC_DIFF_PAIRS] = {
+            {A10, 3}
+        };
+        static constexpr ADC_Module::ADC_NLIST diff_table_ADC1[ADC_DIFF_PAIRS] = {
+            {A10, 0}
+        };
         #endif
 
 
-};
-
 
+        // translate SC1A to pin number
+        ///////// ADC0
+        #if defined(ADC_TEENSY_3_0) || defined(ADC_TEENSY_3_1)
+        static constexpr uint8_t sc1a2channelADC0[ADC_MAX_PIN+1] = { // new version, gives directly the pin number
+            34, 0, 0, 36, 23, 14, 20, 21, 16, 17, 0, 0, 19, 18, // 0-13
+            15, 22, 23, 0, 0, 35, 0, 37, // 14-21
+            39, 40, 0, 0, 38, 41, 42, 43, // VREF_OUT, A14, temp. sensor, bandgap, VREFH, VREFL.
+            0 // 31 means disabled, but just in case
+        };
+        #elif defined(ADC_TEENSY_LC)
+        // Teensy LC
+        static constexpr uint8_t sc1a2channelADC0[ADC_MAX_PIN+1] = { // new version, gives directly the pin number
+            24, 0, 0, 0, 25, 14, 20, 21, 16, 17, 0, 23, 19, 18, // 0-13
+            15, 22, 23, 0, 0, 0, 0, 0, // 14-21
+            26, 0, 0, 0, 38, 41, 0, 42, 43, // A12, temp. sensor, bandgap, VREFH, VREFL.
+            0 // 31 means disabled, but just in case
+        };
+        #elif defined(ADC_TEENSY_3_5) || defined(ADC_TEENSY_3_6)
+        static constexpr uint8_t sc1a2channelADC0[ADC_MAX_PIN+1] = { // new version, gives directly the pin number
+            0, 68, 0, 64, 23, 14, 20, 21, 16, 17, 0, 0, 19, 18, // 0-13
+            15, 22, 0, 33, 34, 0, 0, 0, // 14-21
+            0, 66, 0, 0, 70, 0, 0, 0, // 22-29
+            0 // 31 means disabled, but just in case
+        };
+        #endif // defined
+
+        ///////// ADC1
+        #if defined(ADC_TEENSY_3_1)
+        static constexpr uint8_t sc1a2channelADC1[ADC_MAX_PIN+1] = { // new version, gives directly the pin number
+            36, 0, 0, 34, 28, 26, 29, 30, 16, 17, 0, 0, 0, 0, // 0-13. 5a=26, 5b=27, 4b=28, 4a=31
+            0, 0, 0, 0, 39, 37, 0, 0, // 14-21
+            0, 0, 0, 0, 38, 41, 0, 42, // 22-29. VREF_OUT, A14, temp. sensor, bandgap, VREFH, VREFL.
+            43
+        };
+        #elif defined(ADC_TEENSY_3_5) || defined(ADC_TEENSY_3_6)
+        static constexpr uint8_t sc1a2channelADC1[ADC_MAX_PIN+1] = { // new version, gives directly the pin number
+            0, 69, 0, 0, 35, 36, 37, 38, 0, 0, 49, 50, 0, 0, // 0-13.
+            31, 32, 0, 39, 71, 65, 0, 0, // 14-21
+            0, 67, 0, 0, 0, 0, 0, 0, // 22-29.
+            0
+        };
+        #endif
 
 
-#ifdef __cplusplus
-}
-#endif
+};
 
 
 #endif // ADC_H
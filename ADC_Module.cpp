@@ -35,6 +35,173 @@
 // include the internal reference
 #include <VREF.h>
 
+// the PDB counter, shared by both modules
+#include "PDBTimebase.h"
+
+
+/////////////// ADC_Settings ////////////////////
+
+/* Default settings of the library
+*  All bits start cleared (8 bits, bus clock, short sampling, no averages) and the setters change them.
+*/
+ADC_Settings::ADC_Settings() :
+        cfg1(0), cfg2(0), sc3(0)
+        , max_value(255), resolution(8), averaging(0)
+        , conversion_speed(ADC_CONVERSION_SPEED::VERY_HIGH_SPEED)
+        , sampling_speed(ADC_SAMPLING_SPEED::VERY_HIGH_SPEED)
+        , reference(ADC_REF_SOURCE::REF_NONE) {
+
+    setResolution(10);
+    setAveraging(4);
+    setConversionSpeed(ADC_CONVERSION_SPEED::MED_SPEED);
+    setSamplingSpeed(ADC_SAMPLING_SPEED::MED_SPEED);
+    setReference(ADC_REFERENCE::REF_3V3);
+}
+
+/* Change the resolution of the measurement
+*  single-ended 8 bits is the same as differential 9 bits, etc.
+*/
+void ADC_Settings::setResolution(uint8_t bits) {
+    uint32_t mode;
+
+    if (bits <= 9) {
+        resolution = 8;
+        mode = 0;
+        max_value = 255; // diff mode 9 bits has 1 bit for sign, so max value is the same as single 8 bits
+    } else if (bits <= 11) {
+        resolution = 10;
+        mode = 2;
+        max_value = 1023;
+    } else if (bits <= 13) {
+        resolution = 12;
+        mode = 1;
+        max_value = 4095;
+    } else {
+        resolution = 16;
+        mode = 3;
+        max_value = 65535;
+    }
+
+    cfg1 = (cfg1 & ~ADC_CFG1_MODE(3)) | ADC_CFG1_MODE(mode);
+}
+
+/* Set the number of averages: 0, 4, 8, 16 or 32.
+*
+*/
+void ADC_Settings::setAveraging(uint8_t num) {
+    if (num <= 1) {
+        averaging = 0;
+        sc3 = 0;
+        return;
+    }
+
+    uint32_t avgs;
+    if (num <= 4) {
+        averaging = 4;
+        avgs = 0;
+    } else if (num <= 8) {
+        averaging = 8;
+        avgs = 1;
+    } else if (num <= 16) {
+        averaging = 16;
+        avgs = 2;
+    } else {
+        averaging = 32;
+        avgs = 3;
+    }
+    sc3 = ADC_SC3_AVGE | ADC_SC3_AVGS(avgs);
+}
+
+/* Sets the conversion speed: the clock source, divider, low power and high speed configuration
+*
+*/
+bool ADC_Settings::setConversionSpeed(ADC_CONVERSION_SPEED speed) {
+    uint32_t cfg1_speed; // clock source, divider and low power configuration
+    uint32_t cfg2_speed; // asynchronous clock enable and high speed configuration
+
+    switch(speed) {
+    case ADC_CONVERSION_SPEED::VERY_LOW_SPEED: // no high-speed config, use low power conf.
+        cfg1_speed = ADC_CFG1_VERY_LOW_SPEED | ADC_CFG1_ADLPC;
+        cfg2_speed = 0;
+        break;
+    case ADC_CONVERSION_SPEED::LOW_SPEED: // no high-speed config, use low power conf.
+        cfg1_speed = ADC_CFG1_LOW_SPEED | ADC_CFG1_ADLPC;
+        cfg2_speed = 0;
+        break;
+    case ADC_CONVERSION_SPEED::MED_SPEED: // no high-speed config, no low power conf.
+        cfg1_speed = ADC_CFG1_MED_SPEED;
+        cfg2_speed = 0;
+        break;
+    case ADC_CONVERSION_SPEED::HIGH_SPEED_16BITS: // high-speed config: add 2 ADCK, no low power conf.
+        cfg1_speed = ADC_CFG1_HI_SPEED_16_BITS;
+        cfg2_speed = ADC_CFG2_ADHSC;
+        break;
+    case ADC_CONVERSION_SPEED::HIGH_SPEED: // high-speed config: add 2 ADCK, no low power conf.
+        cfg1_speed = ADC_CFG1_HI_SPEED;
+        cfg2_speed = ADC_CFG2_ADHSC;
+        break;
+    case ADC_CONVERSION_SPEED::VERY_HIGH_SPEED: // this speed is most likely out of specs, so accuracy can be bad
+        cfg1_speed = ADC_CFG1_VERY_HIGH_SPEED;
+        cfg2_speed = ADC_CFG2_ADHSC;
+        break;
+
+    // internal asynchronous clock settings: fADK = 2.4, 4.0, 5.2 or 6.2 MHz, no dividers
+    // ADACKEN enables ADACK (takes max 5us to be ready)
+    case ADC_CONVERSION_SPEED::ADACK_2_4:
+        cfg1_speed = ADC_CFG1_ADICLK(3) | ADC_CFG1_ADLPC;
+        cfg2_speed = ADC_CFG2_ADACKEN;
+        break;
+    case ADC_CONVERSION_SPEED::ADACK_4_0:
+        cfg1_speed = ADC_CFG1_ADICLK(3) | ADC_CFG1_ADLPC;
+        cfg2_speed = ADC_CFG2_ADACKEN | ADC_CFG2_ADHSC;
+        break;
+    case ADC_CONVERSION_SPEED::ADACK_5_2:
+        cfg1_speed = ADC_CFG1_ADICLK(3);
+        cfg2_speed = ADC_CFG2_ADACKEN;
+        break;
+    case ADC_CONVERSION_SPEED::ADACK_6_2:
+        cfg1_speed = ADC_CFG1_ADICLK(3);
+        cfg2_speed = ADC_CFG2_ADACKEN | ADC_CFG2_ADHSC;
+        break;
+
+    default:
+        return false;
+    }
+
+    cfg1 = (cfg1 & ~(ADC_CFG1_ADLPC | ADC_CFG1_ADIV(3) | ADC_CFG1_ADICLK(3))) | cfg1_speed;
+    cfg2 = (cfg2 & ~(ADC_CFG2_ADACKEN | ADC_CFG2_ADHSC)) | cfg2_speed;
+    conversion_speed = speed;
+    return true;
+}
+
+/* Sets the sampling speed: long sampling time enable and how long
+*
+*/
+void ADC_Settings::setSamplingSpeed(ADC_SAMPLING_SPEED speed) {
+    switch(speed) {
+    case ADC_SAMPLING_SPEED::VERY_LOW_SPEED: // maximum sampling time (+24 ADCK)
+        cfg1 |= ADC_CFG1_ADLSMP;
+        cfg2 = (cfg2 & ~ADC_CFG2_ADLSTS(3)) | ADC_CFG2_ADLSTS(0);
+        break;
+    case ADC_SAMPLING_SPEED::LOW_SPEED: // high sampling time (+16 ADCK)
+        cfg1 |= ADC_CFG1_ADLSMP;
+        cfg2 = (cfg2 & ~ADC_CFG2_ADLSTS(3)) | ADC_CFG2_ADLSTS(1);
+        break;
+    case ADC_SAMPLING_SPEED::MED_SPEED: // medium sampling time (+10 ADCK)
+        cfg1 |= ADC_CFG1_ADLSMP;
+        cfg2 = (cfg2 & ~ADC_CFG2_ADLSTS(3)) | ADC_CFG2_ADLSTS(2);
+        break;
+    case ADC_SAMPLING_SPEED::HIGH_SPEED: // low sampling time (+6 ADCK)
+        cfg1 |= ADC_CFG1_ADLSMP;
+        cfg2 = (cfg2 & ~ADC_CFG2_ADLSTS(3)) | ADC_CFG2_ADLSTS(3);
+        break;
+    case ADC_SAMPLING_SPEED::VERY_HIGH_SPEED: // shortest sampling time
+        cfg1 &= ~ADC_CFG1_ADLSMP;
+        break;
+    }
+    sampling_speed = speed;
+}
+
 
 /* Constructor
 *   Point the registers to the correct ADC module
@@ -76,6 +243,8 @@ ADC_Module::ADC_Module(uint8_t ADC_number, const uint8_t* const a_channel2sc1a,
         , ADC_CLM1(ADC_num? ADC1_CLM1 : ADC0_CLM1)
         , ADC_CLM0(ADC_num? ADC1_CLM0 : ADC0_CLM0)
         , PDB0_CHnC1(ADC_num? PDB0_CH1C1 : PDB0_CH0C1)
+        , PDB0_CHnDLY0(ADC_num? PDB0_CH1DLY0 : PDB0_CH0DLY0)
+        , PDB0_CHnDLY1(ADC_num? PDB0_CH1DLY1 : PDB0_CH0DLY1)
         #if ADC_NUM_ADCS==2
         // IRQ_ADC0 and IRQ_ADC1 aren't consecutive in Teensy 3.6
         , IRQ_ADC(ADC_num? IRQ_ADC1 : IRQ_ADC0) // fix by SB, https://github.com/pedvide/ADC/issues/19
@@ -113,40 +282,67 @@ void ADC_Module::analog_init() {
         - sampling speed = medium
     initiate to 0 (or 1) so the corresponding functions change it to the correct value
     */
-    analog_res_bits = 0;
-    analog_max_val = 0;
-    analog_num_average = 0;
-    analog_reference_internal = ADC_REF_SOURCE::REF_NONE;
+    // set the registers to something different from init_settings so commit writes them
+    settings.cfg1 = 0xFFFFFFFF;
+    settings.cfg2 = 0xFFFFFFFF;
+    settings.sc3 = 0xFFFFFFFF;
+    settings.reference = ADC_REF_SOURCE::REF_NONE;
     pga_value = 1;
-
-    conversion_speed = ADC_CONVERSION_SPEED::VERY_HIGH_SPEED; // set to something different from line 139 so it gets changed there
-    sampling_speed =  ADC_SAMPLING_SPEED::VERY_HIGH_SPEED;
+    owned = false;
+
+    complete_callback = nullptr;
+    complete_ctx = nullptr;
+    complete_buffer = &complete_value;
+    complete_batch = 1;
+    complete_count = 0;
+
+    queue_depth = 0;
+    queue_active = false;
+    queue_held = 0;
+    queue_preempted = false;
+    queue_preempted_continuous = false;
+    continuous_priority = 0;
+    resetQueueStats();
 
     calibrating = 0;
+    calibration_state = ADC_CALIBRATION_STATE::IDLE;
+    calibration_callback = nullptr;
+    pending_mask = 0;
+    clearCalibrationCache();
+    calibration_count = 0;
+    loaded_calibration = 0;
+
+    scan_num_pins = 0;
+    scan_index = 0;
+    scan_dst = nullptr;
+    scan_remaining = 0;
+    scan_aien = 0;
 
     fail_flag = ADC_ERROR::CLEAR; // clear all errors
 
     num_measurements = 0;
+    continuous_counted = false;
+    work_ns = 0;
+    work_cfg1 = 0xFFFFFFFF; // no settings have these values, the times are computed the first time
+    work_cfg2 = 0xFFFFFFFF;
+    work_sc3 = 0xFFFFFFFF;
+    work_conversion_ns[0] = 0;
+    work_conversion_ns[1] = 0;
 
     // select b channels
     // ADC_CFG2_muxsel = 1;
     atomic::setBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
 
-    // set reference to vcc
-    setReference(ADC_REFERENCE::REF_3V3);
-
-    // set resolution to 10
-    setResolution(10);
-
     // the first calibration will use 32 averages and lowest speed,
-    // when this calibration is over the averages and speed will be set to default by wait_for_cal and init_calib will be cleared.
+    // when this calibration is over the averages and speed will be set to default by finish_cal and init_calib will be cleared.
     init_calib = 1;
-    setAveraging(32);
-    setConversionSpeed(ADC_CONVERSION_SPEED::LOW_SPEED);
-    setSamplingSpeed(ADC_SAMPLING_SPEED::LOW_SPEED);
+    ADC_Settings init_settings; // 10 bits and vcc reference
+    init_settings.setAveraging(32);
+    init_settings.setConversionSpeed(ADC_CONVERSION_SPEED::LOW_SPEED);
+    init_settings.setSamplingSpeed(ADC_SAMPLING_SPEED::LOW_SPEED);
 
-    // begin init calibration
-    calibrate();
+    // the reference changes, this begins the init calibration
+    commit(init_settings);
 }
 
 // starts calibration
@@ -155,6 +351,8 @@ void ADC_Module::calibrate() {
     __disable_irq();
 
     calibrating = 1;
+    calibration_state = ADC_CALIBRATION_STATE::RUNNING;
+    loaded_calibration = ++calibration_count; // the calibration registers change
     // ADC_SC3_cal = 0; // stop possible previous calibration
     atomic::clearBitFlag(ADC_SC3, ADC_SC3_CAL);
     // ADC_SC3_calf = 1; // clear possible previous error
@@ -170,46 +368,264 @@ void ADC_Module::calibrate() {
 *
 */
 void ADC_Module::wait_for_cal(void) {
-    uint16_t sum;
 
     while(atomic::getBitFlag(ADC_SC3, ADC_SC3_CAL)) { // Bit ADC_SC3_CAL in register ADC0_SC3 cleared when calib. finishes.
         yield();
     }
 
+    finish_cal();
+}
+
+/* Checks whether the calibration is over, if so it finishes it.
+*
+*/
+ADC_CALIBRATION_STATE ADC_Module::pollCalibration() {
+    if( (calibration_state == ADC_CALIBRATION_STATE::RUNNING) && !atomic::getBitFlag(ADC_SC3, ADC_SC3_CAL) ) {
+        finish_cal();
+    }
+    return calibration_state;
+}
+
+/* Writes the gains and applies the settings changed during the calibration.
+*  Everything is done with interrupts disabled, so nobody sees the settings half applied.
+*/
+void ADC_Module::finish_cal() {
+    uint16_t sum;
+
+    __disable_irq();
+    if (calibration_state != ADC_CALIBRATION_STATE::RUNNING) { // already finished
+        __enable_irq();
+        return;
+    }
+    calibration_state = ADC_CALIBRATION_STATE::GAIN_APPLY; // the setters don't queue anymore
+
     if(atomic::getBitFlag(ADC_SC3, ADC_SC3_CALF)) { // calibration failed
         fail_flag |= ADC_ERROR::CALIB; // the user should know and recalibrate manually
     }
 
-    __disable_irq();
-    if (calibrating) {
-        sum = ADC_CLPS + ADC_CLP4 + ADC_CLP3 + ADC_CLP2 + ADC_CLP1 + ADC_CLP0;
-        sum = (sum / 2) | 0x8000;
-        ADC_PG = sum;
+    sum = ADC_CLPS + ADC_CLP4 + ADC_CLP3 + ADC_CLP2 + ADC_CLP1 + ADC_CLP0;
+    sum = (sum / 2) | 0x8000;
+    ADC_PG = sum;
 
-        sum = ADC_CLMS + ADC_CLM4 + ADC_CLM3 + ADC_CLM2 + ADC_CLM1 + ADC_CLM0;
-        sum = (sum / 2) | 0x8000;
-        ADC_MG = sum;
+    sum = ADC_CLMS + ADC_CLM4 + ADC_CLM3 + ADC_CLM2 + ADC_CLM1 + ADC_CLM0;
+    sum = (sum / 2) | 0x8000;
+    ADC_MG = sum;
 
-        calibrating = 0;
+    // keep it for setReference and exportCalibration, before the settings change
+    if(settings.reference != ADC_REF_SOURCE::REF_NONE) {
+        ADC_Calibration& cached = calibration_cache[static_cast<uint8_t>(settings.reference)];
+        if(atomic::getBitFlag(ADC_SC3, ADC_SC3_CALF)) {
+            cached.magic = 0;
+        } else {
+            readCalibration(&cached);
+        }
     }
+
+    apply_pending_settings();
+
+    calibrating = 0;
+    calibration_state = ADC_CALIBRATION_STATE::DONE;
     __enable_irq();
 
+    if(calibration_callback) {
+        calibration_callback();
+    }
+}
+
+/* Applies the default settings after the first calibration and the settings changed during the calibration.
+*  Called with interrupts disabled.
+*/
+void ADC_Module::apply_pending_settings() {
+    commit(settingsAfterCalibration());
+    init_calib = 0;
+
+    const uint8_t mask = pending_mask;
+    pending_mask = 0;
+    if(mask & (1<<SETTING_INTERRUPTS)) {
+        pending_settings[SETTING_INTERRUPTS] ? enableInterrupts() : disableInterrupts();
+    }
+    if(mask & (1<<SETTING_DMA)) {
+        pending_settings[SETTING_DMA] ? enableDMA() : disableDMA();
+    }
+}
+
+/* Settings with the defaults after the first calibration and the settings changed during the calibration.
+*
+*/
+ADC_Settings ADC_Module::settingsAfterCalibration() {
+    ADC_Settings new_settings = settings;
+
     // the first calibration uses 32 averages and lowest speed,
     // when this calibration is over, set the averages and speed to default.
     if(init_calib) {
+        ADC_Settings defaults;
+        new_settings.setConversionSpeed(defaults.getConversionSpeed());
+        new_settings.setSamplingSpeed(defaults.getSamplingSpeed());
+        new_settings.setAveraging(defaults.getAveraging());
+    }
+
+    // settings changed during the calibration, after the defaults so they win
+    const uint8_t mask = pending_mask;
+    if(mask & (1<<SETTING_RESOLUTION)) {
+        new_settings.setResolution(pending_settings[SETTING_RESOLUTION]);
+    }
+    if(mask & (1<<SETTING_CONVERSION_SPEED)) {
+        new_settings.setConversionSpeed(static_cast<ADC_CONVERSION_SPEED>(pending_settings[SETTING_CONVERSION_SPEED]));
+    }
+    if(mask & (1<<SETTING_SAMPLING_SPEED)) {
+        new_settings.setSamplingSpeed(static_cast<ADC_SAMPLING_SPEED>(pending_settings[SETTING_SAMPLING_SPEED]));
+    }
+    if(mask & (1<<SETTING_AVERAGING)) {
+        new_settings.setAveraging(pending_settings[SETTING_AVERAGING]);
+    }
+
+    return new_settings;
+}
+
+/* Reads the calibration registers and the current settings
+*
+*/
+void ADC_Module::readCalibration(ADC_Calibration* cal) {
+    cal->magic = ADC_CALIBRATION_MAGIC;
+    cal->adc_num = ADC_num;
+    cal->reference = settings.reference;
+    cal->resolution = settings.resolution;
+    cal->averaging = settings.averaging;
+    cal->conversion_speed = settings.conversion_speed;
+
+    cal->ofs = ADC_OFS;
+    cal->pg = ADC_PG;
+    cal->mg = ADC_MG;
+
+    cal->clp[0] = ADC_CLPD;
+    cal->clp[1] = ADC_CLPS;
+    cal->clp[2] = ADC_CLP4;
+    cal->clp[3] = ADC_CLP3;
+    cal->clp[4] = ADC_CLP2;
+    cal->clp[5] = ADC_CLP1;
+    cal->clp[6] = ADC_CLP0;
+
+    cal->clm[0] = ADC_CLMD;
+    cal->clm[1] = ADC_CLMS;
+    cal->clm[2] = ADC_CLM4;
+    cal->clm[3] = ADC_CLM3;
+    cal->clm[4] = ADC_CLM2;
+    cal->clm[5] = ADC_CLM1;
+    cal->clm[6] = ADC_CLM0;
+}
+
+/* Writes the calibration registers
+*
+*/
+void ADC_Module::writeCalibration(const ADC_Calibration* cal) {
+    ADC_OFS = cal->ofs;
+    ADC_PG = cal->pg;
+    ADC_MG = cal->mg;
+
+    ADC_CLPD = cal->clp[0];
+    ADC_CLPS = cal->clp[1];
+    ADC_CLP4 = cal->clp[2];
+    ADC_CLP3 = cal->clp[3];
+    ADC_CLP2 = cal->clp[4];
+    ADC_CLP1 = cal->clp[5];
+    ADC_CLP0 = cal->clp[6];
+
+    ADC_CLMD = cal->clm[0];
+    ADC_CLMS = cal->clm[1];
+    ADC_CLM4 = cal->clm[2];
+    ADC_CLM3 = cal->clm[3];
+    ADC_CLM2 = cal->clm[4];
+    ADC_CLM1 = cal->clm[5];
+    ADC_CLM0 = cal->clm[6];
+}
+
+/* Copies the last successful calibration with the current reference
+*
+*/
+bool ADC_Module::exportCalibration(ADC_Calibration* cal) {
+    if( (pollCalibration() != ADC_CALIBRATION_STATE::DONE) || (settings.reference == ADC_REF_SOURCE::REF_NONE) ) {
+        return false;
+    }
+    const ADC_Calibration& cached = calibration_cache[static_cast<uint8_t>(settings.reference)];
+    if(cached.magic != ADC_CALIBRATION_MAGIC) { // it failed
+        return false;
+    }
+    *cal = cached;
+    return true;
+}
+
+/* Writes the calibration registers, stopping the calibration if it's running
+*
+*/
+bool ADC_Module::importCalibration(const ADC_Calibration* cal) {
+    if( (cal->magic != ADC_CALIBRATION_MAGIC) || (cal->adc_num != ADC_num) ||
+        ((cal->reference != ADC_REF_SOURCE::REF_DEFAULT) && (cal->reference != ADC_REF_SOURCE::REF_ALT)) ) {
+        fail_flag |= ADC_ERROR::CALIB;
+        return false;
+    }
+
+    if(cal->reference != settings.reference) {
+        setReferenceSource(cal->reference);
+    }
+
+    __disable_irq();
+    const bool was_calibrating = (calibration_state == ADC_CALIBRATION_STATE::RUNNING);
+    calibration_state = ADC_CALIBRATION_STATE::GAIN_APPLY; // the setters don't queue anymore
+
+    // writing any register aborts the calibration
+    ADC_OFS = cal->ofs;
+    while(atomic::getBitFlag(ADC_SC3, ADC_SC3_CAL)) { // the abort takes a few cycles at most
+    }
+    // ADC_SC3_calf = 1; // clear the error of the aborted calibration
+    atomic::setBitFlag(ADC_SC3, ADC_SC3_CALF);
+
+    writeCalibration(cal);
+    loaded_calibration = ++calibration_count;
+
+    calibration_cache[static_cast<uint8_t>(cal->reference)] = *cal;
+
+    if(was_calibrating) {
+        apply_pending_settings();
+    }
+
+    calibrating = 0;
+    calibration_state = ADC_CALIBRATION_STATE::DONE;
+    __enable_irq();
 
-        // set conversion speed to medium
-        setConversionSpeed(ADC_CONVERSION_SPEED::MED_SPEED);
+    if(calibration_callback) {
+        calibration_callback();
+    }
+
+    return true;
+}
 
-        // set sampling speed to medium
-        setSamplingSpeed(ADC_SAMPLING_SPEED::MED_SPEED);
+/* Forget the calibrations kept for each reference
+*
+*/
+void ADC_Module::clearCalibrationCache() {
+    calibration_cache[0].magic = 0;
+    calibration_cache[1].magic = 0;
+}
 
-        // number of averages to 4
-        setAveraging(4);
+/* Stores the new value of a setting if the ADC is calibrating, finish_cal will apply it.
+*  Returns false if the setting has to be applied now.
+*/
+bool ADC_Module::queueSetting(ADC_SETTING setting, uint8_t value) {
+    // don't touch the interrupts if not calibrating, finish_cal calls the setters with them disabled
+    // the calibration may have finished without anybody polling it, then the setting is applied now
+    if(pollCalibration() != ADC_CALIBRATION_STATE::RUNNING) {
+        return false;
+    }
 
-        init_calib = 0; // clear
+    __disable_irq();
+    const bool queued = (calibration_state == ADC_CALIBRATION_STATE::RUNNING);
+    if(queued) {
+        pending_settings[setting] = value;
+        pending_mask |= 1<<setting;
     }
+    __enable_irq();
 
+    return queued;
 }
 
 //! Starts the calibration sequence, waits until it's done and writes the results
@@ -229,23 +645,42 @@ void ADC_Module::recalibrate() {
 
 
 /* Set the voltage reference you prefer, default is 3.3V
-*   It needs to recalibrate
+*   It needs to recalibrate, unless a calibration with the same reference and settings was done before
 *  Use ADC_REF_3V3, ADC_REF_1V2 (not for Teensy LC) or ADC_REF_EXT
 */
 void ADC_Module::setReference(ADC_REFERENCE type) {
     ADC_REF_SOURCE ref_type = static_cast<ADC_REF_SOURCE>(type); // cast to source type, that is, either internal or default
 
-    if (analog_reference_internal==ref_type) { // don't need to change anything
+    if (settings.reference==ref_type) { // don't need to change anything
         return;
     }
 
+    setReferenceSource(ref_type);
+
+    // reuse the last calibration with this reference if it was done with the same settings
+    if( !calibrating && (ref_type != ADC_REF_SOURCE::REF_NONE) ) {
+        const ADC_Calibration& cached = calibration_cache[static_cast<uint8_t>(ref_type)];
+        if( (cached.magic == ADC_CALIBRATION_MAGIC) && (cached.resolution == settings.resolution) &&
+            (cached.averaging == settings.averaging) && (cached.conversion_speed == settings.conversion_speed) ) {
+            importCalibration(&cached);
+            return;
+        }
+    }
+
+    calibrate();
+}
+
+/* Changes the reference without calibrating
+*
+*/
+void ADC_Module::setReferenceSource(ADC_REF_SOURCE ref_type) {
     if (ref_type == ADC_REF_SOURCE::REF_ALT) { // 1.2V ref for Teensy 3.x, 3.3 VDD for Teensy LC
         // internal reference requested
         #if ADC_USE_INTERNAL_VREF
         VREF::start(); // enable VREF if Teensy 3.x
         #endif
 
-        analog_reference_internal = ADC_REF_SOURCE::REF_ALT;
+        settings.reference = ADC_REF_SOURCE::REF_ALT;
 
         // *ADC_SC2_ref = 1; // uses bitband: atomic
         atomic::setBitFlag(ADC_SC2, ADC_SC2_REFSEL(1));
@@ -257,13 +692,11 @@ void ADC_Module::setReference(ADC_REFERENCE type) {
         VREF::stop(); // disable 1.2V reference source when using the external ref (p. 102, 3.7.1.7)
         #endif
 
-        analog_reference_internal = ADC_REF_SOURCE::REF_DEFAULT;
+        settings.reference = ADC_REF_SOURCE::REF_DEFAULT;
 
         // *ADC_SC2_ref = 0; // uses bitband: atomic
         atomic::clearBitFlag(ADC_SC2, ADC_SC2_REFSEL(1));
     }
-
-    calibrate();
 }
 
 
@@ -277,68 +710,29 @@ void ADC_Module::setReference(ADC_REFERENCE type) {
 */
 void ADC_Module::setResolution(uint8_t bits) {
 
-    if(analog_res_bits==bits) {
+    if(queueSetting(SETTING_RESOLUTION, bits)) { // applied when the calibration is done
         return;
     }
 
-    uint8_t config;
-
-    if (calibrating) wait_for_cal();
-
-    if (bits <= 9) {
-        config = 8;
-    } else if (bits <= 11) {
-        config = 10;
-    } else if (bits <= 13) {
-        config = 12;
-    } else if (bits > 13) {
-        config = 16;
-    } else {
-        config = 8; // default to 8 bits
-    }
-
-    // conversion resolution
-    // single-ended 8 bits is the same as differential 9 bits, etc.
-    if ( (config == 8) || (config == 9) )  {
-        // *ADC_CFG1_mode1 = 0;
-        // *ADC_CFG1_mode0 = 0;
-        atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_MODE(3));
-        analog_max_val = 255; // diff mode 9 bits has 1 bit for sign, so max value is the same as single 8 bits
-    } else if ( (config == 10 )|| (config == 11) ) {
-        // *ADC_CFG1_mode1 = 1;
-        // *ADC_CFG1_mode0 = 0;
-        atomic::changeBitFlag(ADC_CFG1, ADC_CFG1_MODE(3), ADC_CFG1_MODE(2));
-        analog_max_val = 1023;
-    } else if ( (config == 12 )|| (config == 13) ) {
-        // *ADC_CFG1_mode1 = 0;
-        // *ADC_CFG1_mode0 = 1;
-        atomic::changeBitFlag(ADC_CFG1, ADC_CFG1_MODE(3), ADC_CFG1_MODE(1));
-        analog_max_val = 4095;
-    } else {
-        // *ADC_CFG1_mode1 = 1;
-        // *ADC_CFG1_mode0 = 1;
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_MODE(3));
-        analog_max_val = 65535;
-    }
-
-    analog_res_bits = config;
+    ADC_Settings new_settings = settings;
+    new_settings.setResolution(bits);
+    commit(new_settings);
 
     // no recalibration is needed when changing the resolution, p. 619
-
 }
 
-/* Returns the resolution of the ADC
+/* Returns the resolution of the ADC, or the one it will have if it was set during the calibration
 *
 */
 uint8_t ADC_Module::getResolution() {
-    return analog_res_bits;
+    return getSettings().resolution;
 }
 
-/* Returns the maximum value for a measurement, that is: 2^resolution-1
+/* Returns the maximum value for a measurement, that is: 2^resolution-1, see getResolution
 *
 */
 uint32_t ADC_Module::getMaxValue() {
-    return analog_max_val;
+    return getSettings().max_value;
 }
 
 
@@ -354,109 +748,16 @@ uint32_t ADC_Module::getMaxValue() {
 */
 void ADC_Module::setConversionSpeed(ADC_CONVERSION_SPEED speed) {
 
-    if(speed==conversion_speed) { // no change
-        return;
-    }
-
-    if (calibrating) wait_for_cal();
-
-    // internal asynchronous clock settings: fADK = 2.4, 4.0, 5.2 or 6.2 MHz
-    if( (speed == ADC_CONVERSION_SPEED::ADACK_2_4) ||
-        (speed == ADC_CONVERSION_SPEED::ADACK_4_0) ||
-        (speed == ADC_CONVERSION_SPEED::ADACK_5_2) ||
-        (speed == ADC_CONVERSION_SPEED::ADACK_6_2)) {
-        atomic::setBitFlag(ADC_CFG2, ADC_CFG2_ADACKEN); // enable ADACK (takes max 5us to be ready)
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADICLK(3)); // select ADACK as clock source
-
-        atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADIV(3)); // select no dividers
-
-        if(speed == ADC_CONVERSION_SPEED::ADACK_2_4) {
-            atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-            atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-        } else if(speed == ADC_CONVERSION_SPEED::ADACK_4_0) {
-            atomic::setBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-            atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-        } else if(speed == ADC_CONVERSION_SPEED::ADACK_5_2) {
-            atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-            atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-        } else if(speed == ADC_CONVERSION_SPEED::ADACK_6_2) {
-            atomic::setBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-            atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-        }
-        conversion_speed = speed;
+    if(queueSetting(SETTING_CONVERSION_SPEED, static_cast<uint8_t>(speed))) { // applied when the calibration is done
         return;
     }
 
-
-    // normal bus clock used
-
-    // *ADC_CFG2_adacken = 0; // disable the internal asynchronous clock
-    atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_ADACKEN);
-
-    uint32_t ADC_CFG1_speed; // store the clock and divisor
-
-    if(speed == ADC_CONVERSION_SPEED::VERY_LOW_SPEED) {
-        // *ADC_CFG2_adhsc = 0; // no high-speed config
-        // *ADC_CFG1_adlpc  = 1; // use low power conf.
-        atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-
-        ADC_CFG1_speed = ADC_CFG1_VERY_LOW_SPEED;
-
-    } else if(speed == ADC_CONVERSION_SPEED::LOW_SPEED) {
-        // *ADC_CFG2_adhsc = 0; // no high-speed config
-        // *ADC_CFG1_adlpc  = 1; // use low power conf.
-        atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-
-        ADC_CFG1_speed = ADC_CFG1_LOW_SPEED;
-
-    } else if(speed == ADC_CONVERSION_SPEED::MED_SPEED) {
-        // *ADC_CFG2_adhsc = 0; // no high-speed config
-        // *ADC_CFG1_adlpc  = 0; // no low power conf.
-        atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-        atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-
-        ADC_CFG1_speed = ADC_CFG1_MED_SPEED;
-
-    } else if(speed == ADC_CONVERSION_SPEED::HIGH_SPEED_16BITS) {
-        // *ADC_CFG2_adhsc = 1; // high-speed config: add 2 ADCK
-        // *ADC_CFG1_adlpc  = 0; // no low power conf.
-        atomic::setBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-        atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-
-        ADC_CFG1_speed = ADC_CFG1_HI_SPEED_16_BITS;
-
-    } else if(speed == ADC_CONVERSION_SPEED::HIGH_SPEED) {
-        // *ADC_CFG2_adhsc = 1; // high-speed config: add 2 ADCK
-        // *ADC_CFG1_adlpc  = 0; // no low power conf.
-        atomic::setBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-        atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-
-        ADC_CFG1_speed = ADC_CFG1_HI_SPEED;
-
-    } else if(speed == ADC_CONVERSION_SPEED::VERY_HIGH_SPEED) { // this speed is most likely out of specs, so accuracy can be bad
-        // *ADC_CFG2_adhsc = 1; // high-speed config: add 2 ADCK
-        // *ADC_CFG1_adlpc  = 0; // no low power conf.
-        atomic::setBitFlag(ADC_CFG2, ADC_CFG2_ADHSC);
-        atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADLPC);
-
-        ADC_CFG1_speed = ADC_CFG1_VERY_HIGH_SPEED;
-
-    } else {
+    ADC_Settings new_settings = settings;
+    if(!new_settings.setConversionSpeed(speed)) {
         fail_flag |= ADC_ERROR::OTHER;
         return;
     }
-
-    // clock source is bus or bus/2
-    atomic::changeBitFlag(ADC_CFG1, ADC_CFG1_ADICLK(3), ADC_CFG1_speed & ADC_CFG1_ADICLK(3));
-
-    // divisor for the clock source: 1, 2, 4 or 8.
-    // so total speed can be: bus, bus/2, bus/4, bus/8 or bus/16.
-    atomic::changeBitFlag(ADC_CFG1, ADC_CFG1_ADIV(3), ADC_CFG1_speed & ADC_CFG1_ADIV(3));
-
-    conversion_speed = speed;
-
+    commit(new_settings);
 }
 
 
@@ -471,30 +772,13 @@ void ADC_Module::setConversionSpeed(ADC_CONVERSION_SPEED speed) {
 * VERY_HIGH_SPEED is the highest possible sampling speed (0 ADCK added).
 */
 void ADC_Module::setSamplingSpeed(ADC_SAMPLING_SPEED speed) {
-    if (calibrating) wait_for_cal();
-
-    switch(speed) {
-    case ADC_SAMPLING_SPEED::VERY_LOW_SPEED:
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLSMP); // long sampling time enable
-        atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_ADLSTS(3)); // maximum sampling time (+24 ADCK)
-        break;
-    case ADC_SAMPLING_SPEED::LOW_SPEED:
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLSMP); // long sampling time enable
-        atomic::changeBitFlag(ADC_CFG2, ADC_CFG2_ADLSTS(3), ADC_CFG2_ADLSTS(1)); // high sampling time (+16 ADCK)
-        break;
-    case ADC_SAMPLING_SPEED::MED_SPEED:
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLSMP); // long sampling time enable
-        atomic::changeBitFlag(ADC_CFG2, ADC_CFG2_ADLSTS(3), ADC_CFG2_ADLSTS(2)); // medium sampling time (+10 ADCK)
-        break;
-    case ADC_SAMPLING_SPEED::HIGH_SPEED:
-        atomic::setBitFlag(ADC_CFG1, ADC_CFG1_ADLSMP); // long sampling time enable
-        atomic::setBitFlag(ADC_CFG2, ADC_CFG2_ADLSTS(3)); // low sampling time (+6 ADCK)
-        break;
-    case ADC_SAMPLING_SPEED::VERY_HIGH_SPEED:
-        atomic::clearBitFlag(ADC_CFG1, ADC_CFG1_ADLSMP); // shortest sampling time
-        break;
+    if(queueSetting(SETTING_SAMPLING_SPEED, static_cast<uint8_t>(speed))) { // applied when the calibration is done
+        return;
     }
-    sampling_speed =  speed;
+
+    ADC_Settings new_settings = settings;
+    new_settings.setSamplingSpeed(speed);
+    commit(new_settings);
 }
 
 
@@ -503,80 +787,473 @@ void ADC_Module::setSamplingSpeed(ADC_SAMPLING_SPEED speed) {
 */
 void ADC_Module::setAveraging(uint8_t num) {
 
-    if (calibrating) wait_for_cal();
-
-    if (num <= 1) {
-        num = 0;
-        // ADC_SC3_avge = 0;
-        atomic::clearBitFlag(ADC_SC3, ADC_SC3_AVGE);
-    } else {
-        // ADC_SC3_avge = 1;
-        atomic::setBitFlag(ADC_SC3, ADC_SC3_AVGE);
-        if (num <= 4) {
-            num = 4;
-            // ADC_SC3_avgs0 = 0;
-            // ADC_SC3_avgs1 = 0;
-            atomic::clearBitFlag(ADC_SC3, ADC_SC3_AVGS(3));
-        } else if (num <= 8) {
-            num = 8;
-            // ADC_SC3_avgs0 = 1;
-            // ADC_SC3_avgs1 = 0;
-            atomic::changeBitFlag(ADC_SC3, ADC_SC3_AVGS(3), ADC_SC3_AVGS(1));
-        } else if (num <= 16) {
-            num = 16;
-            // ADC_SC3_avgs0 = 0;
-            // ADC_SC3_avgs1 = 1;
-            atomic::changeBitFlag(ADC_SC3, ADC_SC3_AVGS(3), ADC_SC3_AVGS(2));
-        } else {
-            num = 32;
-            // ADC_SC3_avgs0 = 1;
-            // ADC_SC3_avgs1 = 1;
-            atomic::setBitFlag(ADC_SC3, ADC_SC3_AVGS(3));
-        }
+    if(queueSetting(SETTING_AVERAGING, num)) { // applied when the calibration is done
+        return;
     }
-    analog_num_average = num;
-}
-
-
-/* Enable interrupts: An ADC Interrupt will be raised when the conversion is completed
-*  (including hardware averages and if the comparison (if any) is true).
-*/
-void ADC_Module::enableInterrupts() {
-    if (calibrating) wait_for_cal();
 
-    // ADC_SC1A_aien = 1;
-    atomic::setBitFlag(ADC_SC1A, ADC_SC1_AIEN);
-
-    NVIC_ENABLE_IRQ(IRQ_ADC);
+    ADC_Settings new_settings = settings;
+    new_settings.setAveraging(num);
+    commit(new_settings);
 }
 
-/* Disable interrupts
+
+/* Returns the current settings, including those that will be applied after the calibration
 *
 */
-void ADC_Module::disableInterrupts() {
-    // ADC_SC1A_aien = 0;
-    atomic::clearBitFlag(ADC_SC1A, ADC_SC1_AIEN);
-
-    NVIC_DISABLE_IRQ(IRQ_ADC);
+ADC_Settings ADC_Module::getSettings() {
+    if(pollCalibration() == ADC_CALIBRATION_STATE::RUNNING) {
+        return settingsAfterCalibration();
+    }
+    return settings;
 }
 
-
-/* Enable DMA request: An ADC DMA request will be raised when the conversion is completed
-*  (including hardware averages and if the comparison (if any) is true).
+/* Writes the registers that change, each one once.
+*  The bits of CFG2 and SC3 that don't belong to the settings (MUXSEL, ADCO, CALF) are kept,
+*  so the interrupts are disabled between the read and the write.
 */
-void ADC_Module::enableDMA() {
+void ADC_Module::commit(const ADC_Settings& new_settings) {
 
-    if (calibrating) wait_for_cal();
+    // finish the calibration now if it's over, otherwise the settings would be queued until somebody polls it
+    pollCalibration();
 
-    // ADC_SC2_dma = 1;
-    atomic::setBitFlag(ADC_SC2, ADC_SC2_DMAEN);
-}
+    // finish_cal and importCalibration call it with the interrupts disabled already
+    const bool irq_disabled = (calibration_state == ADC_CALIBRATION_STATE::GAIN_APPLY);
+
+    if(!irq_disabled) {
+        __disable_irq();
+    }
+    if(calibration_state == ADC_CALIBRATION_STATE::RUNNING) { // applied when the calibration is done
+        pending_settings[SETTING_RESOLUTION] = new_settings.resolution;
+        pending_settings[SETTING_CONVERSION_SPEED] = static_cast<uint8_t>(new_settings.conversion_speed);
+        pending_settings[SETTING_SAMPLING_SPEED] = static_cast<uint8_t>(new_settings.sampling_speed);
+        pending_settings[SETTING_AVERAGING] = new_settings.averaging;
+        pending_mask |= (1<<SETTING_RESOLUTION) | (1<<SETTING_CONVERSION_SPEED) | (1<<SETTING_SAMPLING_SPEED) | (1<<SETTING_AVERAGING);
+    } else {
+        if(new_settings.cfg1 != settings.cfg1) {
+            ADC_CFG1 = new_settings.cfg1;
+        }
+        if(new_settings.cfg2 != settings.cfg2) {
+            ADC_CFG2 = (ADC_CFG2 & ~ADC_SETTINGS_CFG2_MASK) | new_settings.cfg2;
+        }
+        if(new_settings.sc3 != settings.sc3) {
+            ADC_SC3 = (ADC_SC3 & ~(ADC_SETTINGS_SC3_MASK | ADC_SC3_CALF)) | new_settings.sc3; // writing CALF would clear it
+        }
+        const ADC_REF_SOURCE reference = settings.reference;
+        settings = new_settings;
+        settings.reference = reference; // setReference changes it
+    }
+    if(!irq_disabled) {
+        __enable_irq();
+    }
+
+    if(new_settings.reference != settings.reference) {
+        setReference(static_cast<ADC_REFERENCE>(new_settings.reference));
+    }
+}
+
+/* Saves the registers of the settings, compare function and PGA, and the calibration values.
+*  The compare values and PGA are saved even if they are disabled, they don't change anything then.
+*/
+void ADC_Module::saveProfile(ADC_Profile* profile) {
+
+    if (calibrating) wait_for_cal(); // the calibration values must be the final ones
+
+    __disable_irq();
+    saveConfig(&profile->config);
+    profile->config.savedSC2 &= ADC_PROFILE_SC2_MASK;
+    profile->config.savedCV1 = ADC_CV1;
+    profile->config.savedCV2 = ADC_CV2;
+    #if ADC_USE_PGA
+    profile->config.savedPGA = ADC_PGA;
+    #else
+    profile->config.savedPGA = 0;
+    #endif
+    profile->pga_value = pga_value;
+    profile->settings = settings;
+
+    readCalibration(&profile->calibration);
+    profile->calibration_id = loaded_calibration;
+    if(atomic::getBitFlag(ADC_SC3, ADC_SC3_CALF)) { // the last calibration failed, don't save it
+        profile->calibration.magic = 0;
+    }
+    profile->valid = true;
+    __enable_irq();
+}
+
+/* Writes the registers of a profile, all values were computed by saveProfile.
+*  CFG1, CFG2 and SC3 are written only if they change, and the calibration only if a different one is loaded (see loaded_calibration).
+*/
+bool ADC_Module::applyProfile(const ADC_Profile& profile) {
+    if( !profile.valid || (profile.calibration.adc_num != ADC_num) ) {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    if(calibrating) {
+        if(profile.isCalibrated()) {
+            importCalibration(&profile.calibration); // stops the calibration
+            loaded_calibration = profile.calibration_id;
+        } else {
+            wait_for_cal(); // if we modify the adc's registers when calibrating, it will fail
+        }
+    }
+
+    // change the reference without calibrating
+    if(profile.settings.reference != settings.reference) {
+        setReferenceSource(profile.settings.reference);
+    }
+
+    const uint32_t primask = atomic::disableInterrupts();
+    ADC_SC2 = (ADC_SC2 & ~ADC_PROFILE_SC2_MASK) | profile.config.savedSC2; // keep the trigger and DMA bits
+    ADC_CV1 = profile.config.savedCV1;
+    ADC_CV2 = profile.config.savedCV2;
+    #if ADC_USE_PGA
+    ADC_PGA = profile.config.savedPGA;
+    #endif
+    pga_value = profile.pga_value;
+    if(profile.isCalibrated() && (profile.calibration_id != loaded_calibration)) {
+        writeCalibration(&profile.calibration);
+        loaded_calibration = profile.calibration_id;
+    }
+
+    // like commit, but the calibration is done and the reference is set already
+    const ADC_Settings& new_settings = profile.settings;
+    if(new_settings.cfg1 != settings.cfg1) {
+        ADC_CFG1 = new_settings.cfg1;
+    }
+    if(new_settings.cfg2 != settings.cfg2) {
+        ADC_CFG2 = (ADC_CFG2 & ~ADC_SETTINGS_CFG2_MASK) | new_settings.cfg2;
+    }
+    if(new_settings.sc3 != settings.sc3) {
+        ADC_SC3 = (ADC_SC3 & ~(ADC_SETTINGS_SC3_MASK | ADC_SC3_CALF)) | new_settings.sc3; // writing CALF would clear it
+    }
+    settings = new_settings;
+    atomic::restoreInterrupts(primask);
+
+    return true;
+}
+
+
+/* Time of a conversion with the given register values, see "Conversion time" in the reference manual:
+*  ConversionTime = SFCAdder + AverageNum*(BCT + LSTAdder + HSCAdder)
+*  The single or first continuous conversion adder (SFCAdder) is 3 ADCK + 5 bus cycles,
+*  or 5 us + 5 bus cycles if ADACK is selected but not enabled with ADACKEN; subsequent continuous conversions have no adder.
+*/
+uint32_t ADC_Module::conversionTimeNs(uint32_t cfg1, uint32_t cfg2, uint32_t sc3, bool differential, bool continuous) {
+    // base conversion time (ADCK) indexed by CFG1[MODE]: 8 (9) bits, 12 (13) bits, 10 (11) bits and 16 bits
+    const uint8_t bct_single[4] = {17, 20, 20, 25};
+    const uint8_t bct_diff[4] = {27, 30, 30, 34};
+    // long sample time adder (ADCK) indexed by CFG2[ADLSTS]: +24, +16, +10 and +6 ADCK sampling
+    const uint8_t lst_adder[4] = {20, 12, 6, 2};
+    // typical ADACK frequency indexed by CFG1[ADLPC]*2 + CFG2[ADHSC]
+    const uint32_t adack_freq[4] = {5200000, 6200000, 2400000, 4000000};
+
+    const uint8_t adiclk = cfg1 & ADC_CFG1_ADICLK(3);
+    uint32_t adck_freq;
+    if(adiclk == 0) {
+        adck_freq = F_BUS;
+    } else if(adiclk == 1) {
+        adck_freq = F_BUS/2;
+    } else if(adiclk == 2) {
+        adck_freq = ADC_ALTCLK_FREQ;
+    } else {
+        adck_freq = adack_freq[((cfg1 & ADC_CFG1_ADLPC) ? 2 : 0) + ((cfg2 & ADC_CFG2_ADHSC) ? 1 : 0)];
+    }
+    adck_freq >>= (cfg1 >> 5) & 3; // ADIV
+
+    const uint8_t mode = (cfg1 >> 2) & 3;
+    uint32_t adck_cycles = differential ? bct_diff[mode] : bct_single[mode];
+    if(cfg1 & ADC_CFG1_ADLSMP) {
+        adck_cycles += lst_adder[cfg2 & ADC_CFG2_ADLSTS(3)];
+    }
+    if(cfg2 & ADC_CFG2_ADHSC) {
+        adck_cycles += 2;
+    }
+    if(sc3 & ADC_SC3_AVGE) {
+        adck_cycles *= 4 << (sc3 & ADC_SC3_AVGS(3));
+    }
+
+    // picoseconds, so that the bus cycles don't get rounded
+    uint64_t time_ps = 0;
+    if(!continuous) {
+        time_ps += 5*1000000000000ULL/F_BUS;
+        if( (adiclk == 3) && !(cfg2 & ADC_CFG2_ADACKEN) ) {
+            time_ps += 5000000; // the asynchronous clock needs 5 us to start
+        } else {
+            adck_cycles += 3;
+        }
+    }
+    time_ps += adck_cycles*1000000000000ULL/adck_freq;
+
+    return (time_ps + 999)/1000; // round up
+}
+
+/* Conversion time with the current resolution, averaging, conversion and sampling speed
+*
+*/
+uint32_t ADC_Module::getConversionTimeNs(bool differential, bool continuous) {
+    const ADC_Settings current = getSettings(); // the registers have the calibration settings until it's done
+    return conversionTimeNs(current.getCFG1(), current.getCFG2(), current.getSC3(), differential, continuous);
+}
+
+/* Single conversion time with the current settings.
+*  analogRead calls it for every read and the ADC class to choose the ADC, so the time is only computed again when the settings change.
+*/
+uint32_t ADC_Module::cachedConversionTimeNs(bool differential) {
+    const ADC_Settings current = getSettings();
+    if( (current.getCFG1() != work_cfg1) || (current.getCFG2() != work_cfg2) || (current.getSC3() != work_sc3) ) {
+        const uint32_t single_ns = conversionTimeNs(current.getCFG1(), current.getCFG2(), current.getSC3(), false, false);
+        const uint32_t diff_ns = conversionTimeNs(current.getCFG1(), current.getCFG2(), current.getSC3(), true, false);
+        __disable_irq(); // an interrupt that reads must see the times and the settings they belong to
+        work_conversion_ns[0] = single_ns;
+        work_conversion_ns[1] = diff_ns;
+        work_cfg1 = current.getCFG1();
+        work_cfg2 = current.getCFG2();
+        work_sc3 = current.getSC3();
+        __enable_irq();
+    }
+    return work_conversion_ns[differential ? 1 : 0];
+}
+
+/* Time until a new conversion would be done: the blocking reads in progress, the requests in the queue and the conversion itself.
+*  Conversions that don't end by themselves count as ADC_BUSY_WORK_NS.
+*/
+uint32_t ADC_Module::getCompletionTimeNs(bool differential) {
+    const uint32_t conversion_ns = cachedConversionTimeNs(differential);
+    const uint32_t reads_ns = work_ns;
+    const uint8_t depth = queue_depth;
+
+    uint64_t time_ns = reads_ns + (uint64_t)(depth + 1)*conversion_ns;
+
+    const bool converting = isConverting();
+    // a finished calibration is applied by the next read, that's fast
+    if( (calibrating && atomic::getBitFlag(ADC_SC3, ADC_SC3_CAL)) || isScanning() || queue_preempted_continuous || (converting && isContinuous())
+        || (ADC_SC2 & (ADC_SC2_ADTRG | ADC_SC2_DMAEN)) ) {
+        time_ns += ADC_BUSY_WORK_NS;
+    } else if(converting && !reads_ns && !depth) { // startSingleRead
+        time_ns += conversion_ns;
+    }
+
+    return (time_ns > 0xFFFFFFFF) ? 0xFFFFFFFF : time_ns;
+}
+
+/* Maximum rate of single (software or hardware triggered) conversions with the current settings
+*
+*/
+uint32_t ADC_Module::getMaxSampleRate(bool differential) {
+    return 1000000000UL/getConversionTimeNs(differential, false);
+}
+
+/* Choose the lowest noise settings that can convert at targetHz
+*  The averages are the most important, then the slowest ADCK and sampling time that meet the rate.
+*  Only conversion speeds within specs for the current resolution are used (no VERY_HIGH_SPEED or ADACK).
+*/
+bool ADC_Module::configureForRate(uint32_t targetHz, bool differential) {
+    if(targetHz == 0) {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    const uint32_t max_time_ns = 1000000000UL/targetHz;
+
+    const uint8_t averages[] = {32, 16, 8, 4, 0};
+    const ADC_Settings current = getSettings();
+    // only the speeds within specs for this resolution
+    const ADC_CONVERSION_SPEED min_conv_speed = (current.resolution == 16) ? ADC_CONVERSION_SPEED::LOW_SPEED : ADC_CONVERSION_SPEED::VERY_LOW_SPEED;
+    const ADC_CONVERSION_SPEED max_conv_speed = (current.resolution == 16) ? ADC_CONVERSION_SPEED::HIGH_SPEED_16BITS : ADC_CONVERSION_SPEED::HIGH_SPEED;
+
+    for(uint8_t avg : averages) {
+        // the slowest combination that is fast enough
+        uint32_t best_time = 0;
+        ADC_Settings best;
+        for(uint8_t c = static_cast<uint8_t>(min_conv_speed); c <= static_cast<uint8_t>(max_conv_speed); c++) {
+            for(uint8_t s = 0; s <= static_cast<uint8_t>(ADC_SAMPLING_SPEED::VERY_HIGH_SPEED); s++) {
+                ADC_Settings candidate = current;
+                candidate.setAveraging(avg);
+                candidate.setConversionSpeed(static_cast<ADC_CONVERSION_SPEED>(c));
+                candidate.setSamplingSpeed(static_cast<ADC_SAMPLING_SPEED>(s));
+                const uint32_t time = conversionTimeNs(candidate.cfg1, candidate.cfg2, candidate.sc3, differential, false);
+                if( (time <= max_time_ns) && (time > best_time) ) {
+                    best_time = time;
+                    best = candidate;
+                }
+            }
+        }
+
+        if(best_time) {
+            commit(best);
+            return true;
+        }
+    }
+
+    // too fast even without averages
+    fail_flag |= ADC_ERROR::OTHER;
+    return false;
+}
+
+
+/* Enable interrupts: An ADC Interrupt will be raised when the conversion is completed
+*  (including hardware averages and if the comparison (if any) is true).
+*/
+void ADC_Module::enableInterrupts() {
+    if(queueSetting(SETTING_INTERRUPTS, 1)) { // applied when the calibration is done
+        return;
+    }
+
+    // ADC_SC1A_aien = 1;
+    atomic::setBitFlag(ADC_SC1A, ADC_SC1_AIEN);
+    atomic::setBitFlag(ADC_SC1B, ADC_SC1_AIEN); // pretrigger B, see startPDBDual
+
+    NVIC_ENABLE_IRQ(IRQ_ADC);
+}
+
+/* Disable interrupts
+*
+*/
+void ADC_Module::disableInterrupts() {
+    if(queueSetting(SETTING_INTERRUPTS, 0)) { // writing SC1A now would abort the calibration
+        return;
+    }
+
+    // ADC_SC1A_aien = 0;
+    atomic::clearBitFlag(ADC_SC1A, ADC_SC1_AIEN);
+    atomic::clearBitFlag(ADC_SC1B, ADC_SC1_AIEN);
+
+    NVIC_DISABLE_IRQ(IRQ_ADC);
+}
+
+
+ADC_Module* ADC_Module::dispatch_table[ADC_NUM_ADCS];
+
+void ADC_Module::adc0_dispatch() {
+    dispatch_table[0]->dispatchComplete();
+}
+
+#if ADC_NUM_ADCS>1
+void ADC_Module::adc1_dispatch() {
+    dispatch_table[1]->dispatchComplete();
+}
+#endif
+
+/* Sets the function called when conversions are done, the ADC interrupt calls dispatchComplete from now on
+*
+*/
+bool ADC_Module::onComplete(ADC_CompleteCallback fn, void* ctx, uint16_t batch, uint16_t* buffer) {
+
+    if(fn == nullptr) { // back to adcX_isr, unless the request queue needs it
+        __disable_irq();
+        complete_callback = nullptr;
+        if(queue_depth) {
+            __enable_irq();
+            return true;
+        }
+        #if ADC_NUM_ADCS>1
+        attachInterruptVector(static_cast<IRQ_NUMBER_t>(IRQ_ADC), ADC_num ? adc1_isr : adc0_isr);
+        #else
+        attachInterruptVector(static_cast<IRQ_NUMBER_t>(IRQ_ADC), adc0_isr);
+        #endif
+        __enable_irq();
+        disableInterrupts();
+        return true;
+    }
+
+    if( (batch == 0) || ((batch > 1) && (buffer == nullptr)) ) {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    __disable_irq();
+    complete_callback = fn;
+    complete_ctx = ctx;
+    complete_buffer = (batch > 1) ? buffer : &complete_value;
+    complete_batch = batch;
+    complete_count = 0;
+    attachDispatch();
+    __enable_irq();
+
+    enableInterrupts();
+
+    return true;
+}
+
+/* The ADC interrupt calls dispatchComplete of this module
+*
+*/
+void ADC_Module::attachDispatch() {
+    dispatch_table[ADC_num] = this;
+    #if ADC_NUM_ADCS>1
+    attachInterruptVector(static_cast<IRQ_NUMBER_t>(IRQ_ADC), ADC_num ? adc1_dispatch : adc0_dispatch);
+    #else
+    attachInterruptVector(static_cast<IRQ_NUMBER_t>(IRQ_ADC), adc0_dispatch);
+    #endif
+}
+
+/* Called by the ADC interrupt: stores the result and calls the callback when the batch is full.
+*  Then it restores the conversion interrupted by startSingleRead (see adcWasInUse), the user's adc isr used to do it.
+*/
+void ADC_Module::dispatchComplete() {
+
+    if(queue_active) { // the result of a request
+        requestDone();
+        return;
+    }
+
+    if(isScanning()) { // the results go to the scan buffer
+        scanStep();
+        return;
+    }
+
+    // A's result, then B's if pretrigger B converted too (see startPDBDual). Reading them clears the interrupt
+    if(isComplete() || !isCompleteB()) {
+        storeComplete((uint16_t)ADC_RA);
+    }
+    if(isCompleteB()) {
+        storeComplete((uint16_t)ADC_RB);
+    }
+
+    // restore the ADC config if startSingleRead interrupted a conversion, and restart it
+    if(adcWasInUse) {
+        adcWasInUse = 0;
+        loadConfig(&adc_config);
+    }
+}
+
+
+/* Adds a result to the batch, calls the callback when it's full
+*
+*/
+void ADC_Module::storeComplete(uint16_t value) {
+    if(complete_callback) {
+        complete_buffer[complete_count] = value;
+        if(++complete_count == complete_batch) {
+            complete_count = 0;
+            complete_callback(complete_buffer, complete_batch, complete_ctx);
+        }
+    }
+}
+
+
+/* Enable DMA request: An ADC DMA request will be raised when the conversion is completed
+*  (including hardware averages and if the comparison (if any) is true).
+*/
+void ADC_Module::enableDMA() {
+
+    if(queueSetting(SETTING_DMA, 1)) { // applied when the calibration is done
+        return;
+    }
+
+    // ADC_SC2_dma = 1;
+    atomic::setBitFlag(ADC_SC2, ADC_SC2_DMAEN);
+}
 
 /* Disable ADC DMA request
 *
 */
 void ADC_Module::disableDMA() {
 
+    if(queueSetting(SETTING_DMA, 0)) { // applied when the calibration is done
+        return;
+    }
+
     // ADC_SC2_dma = 0;
     atomic::clearBitFlag(ADC_SC2, ADC_SC2_DMAEN);
 }
@@ -646,6 +1323,8 @@ void ADC_Module::enableCompareRange(int16_t lowerLimit, int16_t upperLimit, bool
 */
 void ADC_Module::disableCompare() {
 
+    if (calibrating) wait_for_cal(); // if we modify the adc's registers when calibrating, it will fail
+
     // ADC_SC2_cfe = 0;
     atomic::clearBitFlag(ADC_SC2, ADC_SC2_ACFE);
 }
@@ -692,6 +1371,8 @@ uint8_t ADC_Module::getPGA() {
 //! Disable PGA
 void ADC_Module::disablePGA() {
 #if ADC_USE_PGA
+    if (calibrating) wait_for_cal();
+
     // ADC_PGA_pgaen = 0;
     atomic::clearBitFlag(ADC_PGA, ADC_PGA_PGAEN);
 #endif
@@ -753,27 +1434,6 @@ bool ADC_Module::checkDifferentialPins(uint8_t pinP, uint8_t pinN) {
 
 //////////////// HELPER METHODS FOR CONVERSION /////////////////
 
-// Starts a single-ended conversion on the pin (sets the mux correctly)
-// Doesn't do any of the checks on the pin
-// It doesn't change the continuous conversion bit
-void ADC_Module::startReadFast(uint8_t pin) {
-
-    // translate pin number to SC1A number, that also contains MUX a or b info.
-    const uint8_t sc1a_pin = channel2sc1a[pin];
-
-    if(sc1a_pin&ADC_SC1A_PIN_MUX) { // mux a
-        atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
-    } else { // mux b
-        atomic::setBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
-    }
-
-    // select pin for single-ended mode and start conversion, enable interrupts if requested
-    __disable_irq();
-    ADC_SC1A = (sc1a_pin&ADC_SC1A_CHANNELS) + atomic::getBitFlag(ADC_SC1A, ADC_SC1_AIEN)*ADC_SC1_AIEN;
-    __enable_irq();
-
-}
-
 // Starts a differential conversion on the pair of pins
 // Doesn't do any of the checks on the pins
 // It doesn't change the continuous conversion bit
@@ -827,8 +1487,25 @@ int ADC_Module::analogRead(uint8_t pin) {
         return ADC_ERROR_VALUE;
     }
 
+    return analogReadSC1A(channel2sc1a[pin]);
+
+} // analogRead
+
+
+/* Reads the analog value of the SC1A number, it's not checked.
+* The rest is like analogRead.
+*/
+int ADC_Module::analogReadSC1A(uint8_t sc1a_pin) {
+
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return ADC_ERROR_VALUE;
+    }
+
     // increase the counter of measurements
     num_measurements++;
+    const uint32_t conversion_ns = cachedConversionTimeNs(false);
+    work_ns += conversion_ns;
 
     //digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
 
@@ -836,9 +1513,11 @@ int ADC_Module::analogRead(uint8_t pin) {
 
     //digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
 
+    if(queue_active) waitForRequest();
+
     // check if we are interrupting a measurement, store setting if so.
     // vars to save the current state of the ADC in case it's in use
-    ADC_Config old_config = {0};
+    ADC_Config old_config = {};
     const uint8_t wasADCInUse = isConverting(); // is the ADC running now?
 
     if(wasADCInUse) { // this means we're interrupting a conversion
@@ -846,6 +1525,9 @@ int ADC_Module::analogRead(uint8_t pin) {
         __disable_irq();
         //digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN) );
         saveConfig(&old_config);
+        if(queue_active) { // stop the request, the ADC interrupt would take the result of the read
+            ADC_SC1A = ADC_SC1A_PIN_INVALID;
+        }
         __enable_irq();
     }
 
@@ -853,7 +1535,7 @@ int ADC_Module::analogRead(uint8_t pin) {
     // no continuous mode
     singleMode();
 
-    startReadFast(pin); // start single read
+    startReadFastSC1A(sc1a_pin); // start single read
 
     // wait for the ADC to finish
     while(isConverting()) {
@@ -880,9 +1562,18 @@ int ADC_Module::analogRead(uint8_t pin) {
     }
 
     num_measurements--;
+    work_ns -= conversion_ns;
+
+    // the requests submitted during the read waited for it
+    if(queue_depth) {
+        __disable_irq();
+        startQueue();
+        __enable_irq();
+    }
+
     return result;
 
-} // analogRead
+} // analogReadSC1A
 
 
 
@@ -898,8 +1589,15 @@ int ADC_Module::analogReadDifferential(uint8_t pinP, uint8_t pinN) {
         return ADC_ERROR_VALUE;   // all others are invalid
     }
 
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return ADC_ERROR_VALUE;
+    }
+
     // increase the counter of measurements
     num_measurements++;
+    const uint32_t conversion_ns = cachedConversionTimeNs(true);
+    work_ns += conversion_ns;
 
     // check for calibration before setting channels,
     // because conversion will start as soon as we write to ADC_SC1A
@@ -907,14 +1605,19 @@ int ADC_Module::analogReadDifferential(uint8_t pinP, uint8_t pinN) {
 
     uint8_t res = getResolution();
 
+    if(queue_active) waitForRequest();
+
     // vars to saved the current state of the ADC in case it's in use
-    ADC_Config old_config = {0};
+    ADC_Config old_config = {};
     uint8_t wasADCInUse = isConverting(); // is the ADC running now?
 
     if(wasADCInUse) { // this means we're interrupting a conversion
         // save the current conversion config, we don't want any other interrupts messing up the configs
         __disable_irq();
         saveConfig(&old_config);
+        if(queue_active) { // stop the request, the ADC interrupt would take the result of the read
+            ADC_SC1A = ADC_SC1A_PIN_INVALID;
+        }
         __enable_irq();
     }
 
@@ -951,39 +1654,113 @@ int ADC_Module::analogReadDifferential(uint8_t pinP, uint8_t pinN) {
     }
 
     num_measurements--;
+    work_ns -= conversion_ns;
+
+    // the requests submitted during the read waited for it
+    if(queue_depth) {
+        __disable_irq();
+        startQueue();
+        __enable_irq();
+    }
+
     return result;
 
 } // analogReadDifferential
 
 
 
-/////////////// NON-BLOCKING CONVERSION METHODS //////////////
+/////////////// OWNED CONVERSION METHODS //////////////
 /*
-    This methods are implemented like this:
-
-    1. Check that the pin is correct
-    2. if calibrating, wait for it to finish before modifiying any ADC register
-    3. Check if we're interrupting a measurement, if so store the settings (in a member of the class, so it can be accessed).
-    4. Disable continuous conversion mode and start the current measurement
-
-    The fast methods only do step 4.
-
+    acquire does once the steps that analogRead does for each conversion:
+    wait for the calibration, check that the ADC isn't in use, disable continuous mode.
+    It also disables the interrupts and DMA, so readOwned can start a conversion and wait for it
+    without saving the configuration or disabling the interrupts.
 */
 
-
-/* Starts an analog measurement on the pin.
-*  It returns inmediately, read value with readSingle().
-*  If the pin is incorrect it returns false.
+/* Takes the ADC if it's not owned or busy
+*
 */
-bool ADC_Module::startSingleRead(uint8_t pin) {
+bool ADC_Module::acquire() {
 
-    // check whether the pin is correct
-    if(!checkPin(pin)) {
-        fail_flag |= ADC_ERROR::WRONG_PIN;
+    if (calibrating) wait_for_cal();
+
+    __disable_irq();
+    if( owned || isConverting() || isScanning() || queue_depth || atomic::getBitFlag(ADC_SC2, ADC_SC2_ADTRG) ) {
+        __enable_irq();
         return false;
     }
+    owned = true;
+    __enable_irq();
 
-    if (calibrating) wait_for_cal();
+    owned_interrupts = atomic::getBitFlag(ADC_SC1A, ADC_SC1_AIEN);
+    owned_dma = atomic::getBitFlag(ADC_SC2, ADC_SC2_DMAEN);
+    if(owned_interrupts) {
+        disableInterrupts();
+    }
+    if(owned_dma) {
+        disableDMA();
+    }
+
+    // no continuous mode
+    singleMode();
+
+    return true;
+}
+
+/* Frees the ADC and enables the interrupts and DMA again
+*
+*/
+void ADC_Module::release() {
+    if(!owned) {
+        return;
+    }
+
+    if(owned_dma) {
+        enableDMA();
+    }
+    if(owned_interrupts) {
+        enableInterrupts();
+    }
+
+    owned = false;
+}
+
+
+/////////////// NON-BLOCKING CONVERSION METHODS //////////////
+/*
+    This methods are implemented like this:
+
+    1. Check that the pin is correct
+    2. if calibrating, wait for it to finish before modifiying any ADC register
+    3. Check if we're interrupting a measurement, if so store the settings (in a member of the class, so it can be accessed).
+    4. Disable continuous conversion mode and start the current measurement
+
+    The fast methods only do step 4.
+
+*/
+
+
+/* Starts an analog measurement on the pin.
+*  It returns inmediately, read value with readSingle().
+*  If the pin is incorrect it returns false.
+*/
+bool ADC_Module::startSingleRead(uint8_t pin) {
+
+    // check whether the pin is correct
+    if(!checkPin(pin)) {
+        fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
+
+    if (calibrating) wait_for_cal();
+
+    // the requests wait until the new conversion is set
+    holdQueue();
 
     // save the current state of the ADC in case it's in use
     adcWasInUse = isConverting(); // is the ADC running now?
@@ -1001,6 +1778,8 @@ bool ADC_Module::startSingleRead(uint8_t pin) {
     // start measurement
     startReadFast(pin);
 
+    releaseQueue();
+
     return true;
 }
 
@@ -1017,10 +1796,18 @@ bool ADC_Module::startSingleDifferential(uint8_t pinP, uint8_t pinN) {
         return false;   // all others are invalid
     }
 
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
+
     // check for calibration before setting channels,
     // because conversion will start as soon as we write to ADC_SC1A
     if (calibrating) wait_for_cal();
 
+    // the requests wait until the new conversion is set
+    holdQueue();
+
     // vars to saved the current state of the ADC in case it's in use
     adcWasInUse = isConverting(); // is the ADC running now?
 
@@ -1037,6 +1824,8 @@ bool ADC_Module::startSingleDifferential(uint8_t pinP, uint8_t pinN) {
     // start the conversion
     startDifferentialFast(pinP, pinN);
 
+    releaseQueue();
+
     return true;
 }
 
@@ -1064,17 +1853,30 @@ bool ADC_Module::startContinuous(uint8_t pin) {
         return false;
     }
 
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
+
     // check for calibration before setting channels,
     if (calibrating) wait_for_cal();
 
-    // increase the counter of measurements
-    num_measurements++;
+    // the requests wait until the new conversion is set
+    holdQueue();
+
+    // increase the counter of measurements, once for each continuous conversion
+    if(!continuous_counted) {
+        num_measurements++;
+        continuous_counted = true;
+    }
 
     // set continuous conversion flag
     continuousMode();
 
     startReadFast(pin);
 
+    releaseQueue();
+
     return true;
 }
 
@@ -1090,13 +1892,24 @@ bool ADC_Module::startContinuousDifferential(uint8_t pinP, uint8_t pinN) {
         return false;   // all others are invalid
     }
 
-    // increase the counter of measurements
-    num_measurements++;
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
+
+    // increase the counter of measurements, once for each continuous conversion
+    if(!continuous_counted) {
+        num_measurements++;
+        continuous_counted = true;
+    }
 
     // check for calibration before setting channels,
     // because conversion will start as soon as we write to ADC_SC1A
     if (calibrating) wait_for_cal();
 
+    // the requests wait until the new conversion is set
+    holdQueue();
+
     // save the current state of the ADC in case it's in use
     uint8_t wasADCInUse = isConverting(); // is the ADC running now?
 
@@ -1113,6 +1926,8 @@ bool ADC_Module::startContinuousDifferential(uint8_t pinP, uint8_t pinN) {
     // start conversions
     startDifferentialFast(pinP, pinN);
 
+    releaseQueue();
+
     return true;
 }
 
@@ -1121,138 +1936,477 @@ bool ADC_Module::startContinuousDifferential(uint8_t pinP, uint8_t pinN) {
 */
 void ADC_Module::stopContinuous() {
 
-    // set channel select to all 1's (31) to stop it.
-    ADC_SC1A = ADC_SC1A_PIN_INVALID + atomic::getBitFlag(ADC_SC1A, ADC_SC1_AIEN)*ADC_SC1_AIEN;
+    __disable_irq();
+    if(queue_active) { // a request is converting, don't stop it
+        if(queue_preempted_continuous) { // the queue stopped it already, don't restart it
+            queue_preempted = false;
+            queue_preempted_continuous = false;
+        }
+    } else {
+        // set channel select to all 1's (31) to stop it.
+        ADC_SC1A = ADC_SC1A_PIN_INVALID + atomic::getBitFlag(ADC_SC1A, ADC_SC1_AIEN)*ADC_SC1_AIEN;
 
-    // decrease the counter of measurements (unless it's 0)
-    if(!num_measurements) {
-        num_measurements--;
+        // the requests with lower priority waited for it
+        startQueue();
     }
+    __enable_irq();
 
+    // decrease the counter of measurements if a continuous conversion was counted
+    if(continuous_counted) {
+        continuous_counted = false;
+        if(num_measurements) {
+            num_measurements--;
+        }
+    }
 
     return;
 }
 
-//////////// PDB ////////////////
-//// Only works for Teensy 3.0 and 3.1, not LC (it doesn't have PDB)
+///////////// SCAN METHODS ////////////
+/*
+    startScan does the steps of the non-blocking methods once for all pins,
+    storing their SC1A numbers, and starts the first conversion.
+    Each call to scanStep (in the adc isr) stores the result and starts the next conversion.
+*/
 
-#if ADC_USE_PDB
+/* Starts converting the pins one after the other
+*  Results are stored in dst as frames of num_pins values.
+*/
+bool ADC_Module::startScan(const uint8_t* pins, uint8_t num_pins, volatile uint16_t* dst, uint32_t frames) {
 
-// frequency in Hz
-void ADC_Module::startPDB(uint32_t freq) {
-    if (!(SIM_SCGC6 & SIM_SCGC6_PDB)) { // setup PDB
-        SIM_SCGC6 |= SIM_SCGC6_PDB; // enable pdb clock
+    if( (num_pins==0) || (num_pins>ADC_MAX_SCAN_PINS) || (frames==0) ) {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
     }
 
-    if(freq>F_BUS) return; // too high
-    if(freq<1) return; // too low
+    // check all pins now, scanStep doesn't
+    for(uint8_t i=0; i<num_pins; i++) {
+        if(!checkPin(pins[i])) {
+            fail_flag |= ADC_ERROR::WRONG_PIN;
+            return false;
+        }
+    }
 
-    // mod will have to be a 16 bit value
-    // we detect if it's higher than 0xFFFF and scale it back accordingly.
-    uint32_t mod = (F_BUS / freq);
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
 
-    uint8_t prescaler = 0; // from 0 to 7: factor of 1, 2, 4, 8, 16, 32, 64 or 128
-    uint8_t mult = 0; // from 0 to 3, factor of 1, 10, 20 or 40
+    if (calibrating) wait_for_cal();
 
-    // if mod is too high we need to use prescaler and mult to bring it down to a 16 bit number
-    const uint32_t min_level = 0xFFFF;
-    if(mod>min_level) {
-        if( mod < 2*min_level ) {
-                prescaler = 1;
-        }
-        else if( mod < 4*min_level ) {
-                prescaler = 2;
-        }
-        else if( mod < 8*min_level ) {
-                prescaler = 3;
-        }
-        else if( mod < 10*min_level ) {
-                mult = 1;
-        }
-        else if( mod < 16*min_level ) {
-                prescaler = 4;
-        }
-        else if( mod < 20*min_level ) {
-                mult = 2;
-        }
-        else if( mod < 32*min_level ) {
-                prescaler = 5;
-        }
-        else if( mod < 40*min_level ) {
-                mult = 3;
-        }
-        else if( mod < 64*min_level ) {
-                prescaler = 6;
-        }
-        else if( mod < 128*min_level ) {
-                prescaler = 7;
-        }
-        else if( mod < 160*min_level ) { // 16*10
-                prescaler = 4;
-                mult = 1;
-        }
-        else if( mod < 320*min_level ) { // 16*20
-                prescaler = 4;
-                mult = 2;
-        }
-        else if( mod < 640*min_level ) { // 16*40
-                prescaler = 4;
-                mult = 3;
-        }
-        else if( mod < 1280*min_level ) { // 32*40
-                prescaler = 5;
-                mult = 3;
-        }
-        else if( mod < 2560*min_level ) { // 64*40
-                prescaler = 6;
-                mult = 3;
-        }
-        else if( mod < 5120*min_level ) { // 128*40
-                prescaler = 7;
-                mult = 3;
-        }
-        else { // frequency too low
-            return;
-        }
+    // the requests wait until the new conversion is set
+    holdQueue();
 
-        mod >>= prescaler;
-        if(mult>0) {
-                mod /= 10;
-                mod >>= (mult-1);
-        }
+    // a new scan replaces the old one
+    if(isScanning()) {
+        stopScan();
     }
 
-    setHardwareTrigger(); // trigger ADC with hardware
+    // save the current state of the ADC in case it's in use
+    adcWasInUse = isConverting(); // is the ADC running now?
 
-    //                                   software trigger    enable PDB     PDB interrupt  continuous mode load immediately
-    constexpr uint32_t ADC_PDB_CONFIG = PDB_SC_TRGSEL(15) | PDB_SC_PDBEN | PDB_SC_PDBIE | PDB_SC_CONT |   PDB_SC_LDMOD(0);
+    if(adcWasInUse) { // this means we're interrupting a conversion
+        // save the current conversion config, it's restored at the end of the scan
+        __disable_irq();
+        saveConfig(&adc_config);
+        __enable_irq();
+    }
 
-    constexpr uint32_t PDB_CHnC1_TOS_1 = 0x0100;
-    constexpr uint32_t PDB_CHnC1_EN_1 = 0x01;
+    // startScanConversion enables the interrupts, stopScan restores them
+    scan_aien = atomic::getBitFlag(ADC_SC1A, ADC_SC1_AIEN) ? ADC_SC1_AIEN : 0;
 
-    PDB0_IDLY = 1; // the pdb interrupt happens when IDLY is equal to CNT+1
+    for(uint8_t i=0; i<num_pins; i++) {
+        scan_sc1a[i] = channel2sc1a[pins[i]];
+    }
+    scan_num_pins = num_pins;
+    scan_index = 0;
+    scan_remaining = num_pins*frames;
 
-    PDB0_MOD = (uint16_t)(mod-1);
+    // increase the counter of measurements
+    num_measurements++;
+
+    // no continuous mode
+    singleMode();
 
-    PDB0_SC = ADC_PDB_CONFIG | PDB_SC_PRESCALER(prescaler) | PDB_SC_MULT(mult) | PDB_SC_LDOK; // load all new values
+    __disable_irq();
+    scan_dst = dst;
+    startScanConversion(scan_sc1a[0]);
+    __enable_irq();
 
-    PDB0_SC = ADC_PDB_CONFIG | PDB_SC_PRESCALER(prescaler) | PDB_SC_MULT(mult) | PDB_SC_SWTRIG; // start the counter!
+    releaseQueue();
 
-    PDB0_CHnC1 = PDB_CHnC1_TOS_1 | PDB_CHnC1_EN_1; // enable pretrigger 0 (SC1A)
+    return true;
+}
+
+/* Stores the result of the last conversion and starts the next one
+*  Call it inside the adc isr.
+*/
+bool ADC_Module::scanStep() {
+
+    volatile uint16_t* dst = scan_dst;
+    if(dst == nullptr) { // no scan
+        return false;
+    }
+
+    *dst = (uint16_t)ADC_RA; // also clears the interrupt
+
+    if(--scan_remaining == 0) { // all done
+        stopScan();
+        return false;
+    }
 
-    //NVIC_ENABLE_IRQ(IRQ_PDB);
+    scan_dst = dst + 1;
+    if(++scan_index == scan_num_pins) { // next frame
+        scan_index = 0;
+    }
+    startScanConversion(scan_sc1a[scan_index]);
 
+    return true;
 }
 
-void ADC_Module::stopPDB() {
-    if (!(SIM_SCGC6 & SIM_SCGC6_PDB)) { // if PDB clock wasn't on, return
-        setSoftwareTrigger();
+/* Stops the scan
+*/
+void ADC_Module::stopScan() {
+
+    __disable_irq();
+    if(scan_dst == nullptr) {
+        __enable_irq();
         return;
     }
-    PDB0_SC = 0;
-    setSoftwareTrigger();
+    scan_dst = nullptr;
+    scan_remaining = 0;
+
+    // stop the conversion in progress, if any, with the interrupts as they were before the scan
+    ADC_SC1A = ADC_SC1A_PIN_INVALID + scan_aien;
+
+    // if we interrupted a conversion, set it again
+    if(adcWasInUse) {
+        adcWasInUse = 0;
+        loadConfig(&adc_config);
+    }
+    __enable_irq();
+
+    num_measurements--;
+}
+
+
+///////////// REQUEST QUEUE ////////////
+/*
+    submit checks the pins and inserts the request in request_queue, sorted by priority.
+    The first request saves the state of the ADC (queue_saved_config), stopping the conversion in progress if any.
+    Each request is started in single mode with interrupts, when it's done dispatchComplete calls requestDone,
+    which starts the next one and then calls the callback of the request.
+    When the queue is empty, or only has requests with lower priority than a stopped continuous conversion,
+    the ADC is restored with loadConfig, which also restarts the stopped conversion.
+*/
 
-    //NVIC_DISABLE_IRQ(IRQ_PDB);
+/* Adds a request to the queue, and starts it if the queue isn't converting already
+*
+*/
+bool ADC_Module::submit(const ADC_Request& request) {
+
+    const bool valid_pins = request.differential ? checkDifferentialPins(request.pin, request.pinN) : checkPin(request.pin);
+    if(!valid_pins) {
+        fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    if(request.callback == nullptr) {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
+
+    if (calibrating) wait_for_cal();
+
+    __disable_irq();
+    if(queue_depth == ADC_REQUEST_QUEUE_SIZE) {
+        queue_stats.rejected++;
+        __enable_irq();
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    // after the requests with the same or higher priority, but never before the one converting
+    uint8_t pos = queue_depth;
+    const uint8_t first = queue_active ? 1 : 0;
+    while( (pos > first) && (request_queue[pos-1].request.priority < request.priority) ) {
+        request_queue[pos] = request_queue[pos-1];
+        pos--;
+    }
+    request_queue[pos].request = request;
+    request_queue[pos].submit_us = micros();
+    queue_depth++;
+    if(queue_depth > queue_stats.max_depth) {
+        queue_stats.max_depth = queue_depth;
+    }
+
+    attachDispatch();
+
+    startQueue();
+    __enable_irq();
+
+    NVIC_ENABLE_IRQ(IRQ_ADC);
+
+    return true;
+}
+
+/* Starts the requests unless they have to wait: for the blocking reads in progress (the one an interrupt stopped to submit, for example),
+*  or for a continuous conversion with the same or higher priority.
+*  Called with interrupts disabled.
+*/
+void ADC_Module::startQueue() {
+    if(queue_active || !queue_depth || work_ns || queue_held) {
+        return;
+    }
+    const bool continuous_running = isContinuous() && isConverting();
+    if(!continuous_running || (request_queue[0].request.priority > continuous_priority)) {
+        startNextRequest();
+    }
+}
+
+/* Waits until the request being converted is done, so blocking reads and requests take turns.
+*  The next request is stopped by the read and restarted after it. If the ADC interrupt can't run now (the read is in
+*  an interrupt with higher priority) it waits only for the conversion, the read stops the request and it's converted again.
+*/
+void ADC_Module::waitForRequest() {
+    const uint32_t completed = queue_stats.completed;
+    while(queue_active && (queue_stats.completed == completed) && isConverting()) {
+        yield();
+    }
+}
+
+/* Called by the start methods before they change the ADC. It waits for the request being converted like waitForRequest,
+*  and if the next one started (or the ADC interrupt can't run now) it stops it and restores the ADC as it was before the queue.
+*  The stopped request stays in request_queue[0] and is converted again after releaseQueue.
+*  Interrupts that call a start method hold and release the queue once each, so ++ and -- don't need the interrupts disabled.
+*/
+void ADC_Module::holdQueue() {
+    queue_held++;
+    if(queue_active) {
+        waitForRequest();
+        __disable_irq();
+        if(queue_active) {
+            finishQueue();
+        }
+        __enable_irq();
+    }
+}
+
+/* Called by the start methods when the new conversion is set: the queue starts again,
+*  saving the new conversion in queue_saved_config, so it's the one restored when the queue is done.
+*/
+void ADC_Module::releaseQueue() {
+    __disable_irq();
+    queue_held--;
+    startQueue();
+    __enable_irq();
+}
+
+/* Starts request_queue[0], the first one also saves the state of the ADC
+*  Called with interrupts disabled.
+*/
+void ADC_Module::startNextRequest() {
+
+    if(!queue_active) {
+        queue_active = true;
+        queue_preempted = isConverting();
+        queue_preempted_continuous = queue_preempted && isContinuous();
+        saveConfig(&queue_saved_config);
+        singleMode();
+    }
+
+    const QueuedRequest& next = request_queue[0];
+
+    const uint32_t wait_us = micros() - next.submit_us;
+    queue_stats.total_wait_us += wait_us;
+    if(wait_us > queue_stats.max_wait_us) {
+        queue_stats.max_wait_us = wait_us;
+    }
+
+    // enable the interrupt without starting a conversion, then start the request keeping it
+    ADC_SC1A = ADC_SC1A_PIN_INVALID + ADC_SC1_AIEN;
+    if(next.request.differential) {
+        startDifferentialFast(next.request.pin, next.request.pinN);
+    } else {
+        startReadFast(next.request.pin);
+    }
+}
+
+/* Removes the converted request, starts the next one and calls the callback with the result
+*  Called by the ADC interrupt.
+*/
+void ADC_Module::requestDone() {
+
+    const uint16_t value = (uint16_t)ADC_RA; // also clears the interrupt
+    const ADC_CompleteCallback callback = request_queue[0].request.callback;
+    void* const ctx = request_queue[0].request.ctx;
+
+    queue_depth--;
+    for(uint8_t i = 0; i < queue_depth; i++) {
+        request_queue[i] = request_queue[i+1];
+    }
+    queue_stats.completed++;
+
+    // keep the ADC busy, the callback can take a while
+    if( queue_depth && !queue_held && (!queue_preempted_continuous || (request_queue[0].request.priority > continuous_priority)) ) {
+        startNextRequest();
+    } else {
+        finishQueue();
+    }
+
+    callback(&value, 1, ctx);
+}
+
+/* Restarts the conversion stopped by the first request, or just restores the interrupt enable
+*
+*/
+void ADC_Module::finishQueue() {
+    queue_active = false;
+
+    if(queue_preempted) {
+        queue_preempted = false;
+        queue_preempted_continuous = false;
+        loadConfig(&queue_saved_config);
+    } else {
+        ADC_SC1A = ADC_SC1A_PIN_INVALID + (queue_saved_config.savedSC1A & ADC_SC1_AIEN);
+    }
+}
+
+/* Requests with a higher priority stop continuous conversions
+*
+*/
+void ADC_Module::setContinuousPriority(uint8_t priority) {
+    continuous_priority = priority;
+}
+
+/* Copy of the statistics, taken with interrupts disabled
+*
+*/
+ADC_QueueStats ADC_Module::getQueueStats() {
+    __disable_irq();
+    const ADC_QueueStats stats = queue_stats;
+    __enable_irq();
+    return stats;
+}
+
+/* Resets the statistics
+*
+*/
+void ADC_Module::resetQueueStats() {
+    __disable_irq();
+    queue_stats.completed = 0;
+    queue_stats.rejected = 0;
+    queue_stats.max_depth = queue_depth;
+    queue_stats.total_wait_us = 0;
+    queue_stats.max_wait_us = 0;
+    __enable_irq();
+}
+
+/* Removes the requests that haven't started
+*
+*/
+void ADC_Module::clearQueue() {
+    __disable_irq();
+    queue_depth = queue_active ? 1 : 0;
+    __enable_irq();
+}
+
+
+//////////// PDB ////////////////
+//// Only works for Teensy 3.0 and 3.1, not LC (it doesn't have PDB)
+
+#if ADC_USE_PDB
+
+// frequency in Hz
+bool ADC_Module::startPDB(uint32_t freq) {
+    return startPDB(solvePDB(freq));
+}
+
+// settings from solvePDB
+bool ADC_Module::startPDB(const ADC_PDBConfig& config) {
+    return PDBTimebase::pdb0.startModule(this, config, PDB_CHnC1_TOS_0 | PDB_CHnC1_EN_0, 0, 0); // enable pretrigger 0 (SC1A)
+}
+
+// frequency in Hz
+bool ADC_Module::startPDBDual(uint8_t pinA, uint8_t pinB, uint32_t freq, bool back_to_back, uint16_t delayA, uint16_t delayB) {
+    return startPDBDual(pinA, pinB, solvePDB(freq), back_to_back, delayA, delayB);
+}
+
+// pinA converted by pretrigger 0 (SC1A), pinB by pretrigger 1 (SC1B)
+bool ADC_Module::startPDBDual(uint8_t pinA, uint8_t pinB, const ADC_PDBConfig& config, bool back_to_back, uint16_t delayA, uint16_t delayB) {
+
+    if(!checkPin(pinA) || !checkPin(pinB)) {
+        fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+    const uint8_t sc1a_pinA = channel2sc1a[pinA];
+    const uint8_t sc1a_pinB = channel2sc1a[pinB];
+    // MUXSEL is common to SC1A and SC1B, it only matters for channels 4 to 7
+    const bool muxA = ((sc1a_pinA&ADC_SC1A_CHANNELS) >= 4) && ((sc1a_pinA&ADC_SC1A_CHANNELS) <= 7);
+    const bool muxB = ((sc1a_pinB&ADC_SC1A_CHANNELS) >= 4) && ((sc1a_pinB&ADC_SC1A_CHANNELS) <= 7);
+    if(muxA && muxB && ((sc1a_pinA^sc1a_pinB)&ADC_SC1A_PIN_MUX)) {
+        fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    if(!config.valid) {
+        fail_flag |= ADC_ERROR::PDB_FREQ;
+        return false;
+    }
+
+    if(owned) { // only readOwned can be used
+        fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
+
+    // the last conversion has to finish before the next period starts, and B can't start before A is done
+    const uint64_t count_ns = (uint64_t)pdbDivider(config.prescaler + 8*config.mult)*1000000000/F_BUS;
+    const uint64_t conversion_ns = getConversionTimeNs();
+    const uint64_t end_ns = back_to_back ? delayA*count_ns + 2*conversion_ns : delayB*count_ns + conversion_ns;
+    if( (delayA >= config.mod) || (end_ns > config.mod*count_ns)
+        || (!back_to_back && ((delayB <= delayA) || ((delayB - delayA)*count_ns < conversion_ns))) ) {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    if (calibrating) wait_for_cal();
+
+    // no continuous mode, and the pins are only selected until the PDB triggers them
+    singleMode();
+    setHardwareTrigger();
+
+    if((muxB ? sc1a_pinB : sc1a_pinA)&ADC_SC1A_PIN_MUX) { // mux a
+        atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+    } else { // mux b
+        atomic::setBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+    }
+
+    // both interrupt if enabled
+    __disable_irq();
+    const uint32_t aien = atomic::getBitFlag(ADC_SC1A, ADC_SC1_AIEN)*ADC_SC1_AIEN;
+    ADC_SC1A = (sc1a_pinA&ADC_SC1A_CHANNELS) + aien;
+    ADC_SC1B = (sc1a_pinB&ADC_SC1A_CHANNELS) + aien;
+    complete_count = 0; // the onComplete batches start with A
+    __enable_irq();
+
+    if(back_to_back) {
+        return PDBTimebase::pdb0.startModule(this, config, PDB_CHnC1_BB_1 | PDB_CHnC1_TOS_1 | PDB_CHnC1_TOS_0 | PDB_CHnC1_EN_1 | PDB_CHnC1_EN_0, delayA, 0);
+    }
+    return PDBTimebase::pdb0.startModule(this, config, PDB_CHnC1_TOS_1 | PDB_CHnC1_TOS_0 | PDB_CHnC1_EN_1 | PDB_CHnC1_EN_0, delayA, delayB);
+}
+
+// detach from the PDB counter, stop it if the other ADC isn't attached
+void ADC_Module::stopPDB() {
+    PDBTimebase& pdb = PDBTimebase::pdb0;
+    pdb.detach(this); // this also sets software trigger
+    if(pdb.attached == 0) {
+        pdb.stop();
+    }
 }
 
 //! Return the PDB's frequency
@@ -1261,8 +2415,8 @@ uint32_t ADC_Module::getPDBFrequency() {
     const uint8_t prescaler = (PDB0_SC&0x7000)>>12;
     const uint8_t mult = (PDB0_SC&0xC)>>2;
 
-    const uint32_t freq = uint32_t((mod + 1)<<(prescaler)) * uint32_t((mult==0) ? 1 : 10<<(mult-1));
-    return F_BUS/freq;
+    const uint32_t period = uint32_t((mod + 1)<<(prescaler)) * uint32_t((mult==0) ? 1 : 10<<(mult-1));
+    return (F_BUS + period/2)/period;
 }
 
 #endif
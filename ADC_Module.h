@@ -127,10 +127,10 @@ enum class ADC_REF_SOURCE : uint8_t {REF_DEFAULT = 0, REF_ALT = 1, REF_NONE = 2}
 /*! \file */
 /*! Reference for the ADC */
 enum class ADC_REFERENCE : uint8_t {
-    REF_3V3 = ADC_REF_SOURCE::REF_DEFAULT, /*!< 3.3 volts */
-    REF_1V2 = ADC_REF_SOURCE::REF_ALT, /*!< 1.2 volts */
-    REF_EXT = ADC_REF_SOURCE::REF_DEFAULT, /*!< External VREF */
-    NONE = ADC_REF_SOURCE::REF_NONE // internal, do not use
+    REF_3V3 = static_cast<uint8_t>(ADC_REF_SOURCE::REF_DEFAULT), /*!< 3.3 volts */
+    REF_1V2 = static_cast<uint8_t>(ADC_REF_SOURCE::REF_ALT), /*!< 1.2 volts */
+    REF_EXT = static_cast<uint8_t>(ADC_REF_SOURCE::REF_DEFAULT), /*!< External VREF */
+    NONE = static_cast<uint8_t>(ADC_REF_SOURCE::REF_NONE) // internal, do not use
 };
 #elif defined(ADC_TEENSY_LC)
 // alt is the internal ref, 3.3 V
@@ -138,9 +138,9 @@ enum class ADC_REFERENCE : uint8_t {
 /*! \file */
 /*! Reference for the ADC */
 enum class ADC_REFERENCE : uint8_t {
-    REF_3V3 = ADC_REF_SOURCE::REF_ALT, /*!< 3.3 volts */
-    REF_EXT = ADC_REF_SOURCE::REF_DEFAULT, /*!< External VREF */
-    NONE = ADC_REF_SOURCE::REF_NONE // internal, do not use
+    REF_3V3 = static_cast<uint8_t>(ADC_REF_SOURCE::REF_ALT), /*!< 3.3 volts */
+    REF_EXT = static_cast<uint8_t>(ADC_REF_SOURCE::REF_DEFAULT), /*!< External VREF */
+    NONE = static_cast<uint8_t>(ADC_REF_SOURCE::REF_NONE) // internal, do not use
 };
 #endif
 
@@ -245,6 +245,8 @@ cycles. ADHSC should be used when the ADCLK exceeds the limit for ADHSC = 0.
 #define ADC_MIN_FREQ_16BITS  (2*ADC_MHz)
 // Max freq for 16 bit mode is 12 MHz
 #define ADC_MAX_FREQ_16BITS (12*ADC_MHz)
+// the alternate clock, OSCERCLK
+#define ADC_ALTCLK_FREQ     (16*ADC_MHz)
 
 // We can divide F_BUS by 1, 2, 4, 8, or 16:
 /*
@@ -369,6 +371,170 @@ enum class ADC_SAMPLING_SPEED : uint8_t {
     VERY_HIGH_SPEED, /*!< is the highest possible sampling speed (0 ADCK added). */
 };
 
+/*! State of the calibration.
+*   Use ADC_Module::pollCalibration to move from RUNNING to DONE without blocking.
+*/
+enum class ADC_CALIBRATION_STATE : uint8_t {
+    IDLE, /*!< no calibration has been started. */
+    RUNNING, /*!< the ADC is calibrating, the settings changed now are applied when it's done. */
+    GAIN_APPLY, /*!< the calibration is over and the gains and settings are being written (with interrupts disabled). */
+    DONE /*!< the calibration is done, check ADC_ERROR::CALIB to see if it failed. */
+};
+
+
+//! Function called by the ADC interrupt when a conversion, or a batch of them, is done (see ADC_Module::onComplete).
+/** values has count results, the oldest first. Cast them to int16_t for 16 bit differential conversions.
+*   ctx is the pointer given to onComplete.
+*/
+typedef void (*ADC_CompleteCallback)(const uint16_t* values, uint16_t count, void* ctx);
+
+// number of requests that the queue of each ADC module holds, see ADC_Module::submit
+#define ADC_REQUEST_QUEUE_SIZE (8)
+
+// work in ns of a continuous conversion, scan, hardware triggered or DMA conversion or calibration, see ADC_Module::getCompletionTimeNs
+#define ADC_BUSY_WORK_NS (1000000)
+
+//! A conversion requested with ADC_Module::submit.
+struct ADC_Request {
+    //! Pin to read, or positive pin of a differential conversion.
+    uint8_t pin;
+    //! Negative pin of a differential conversion.
+    uint8_t pinN;
+    //! Differential (pin - pinN) or single-ended conversion.
+    bool differential;
+    //! Requests with higher priority are converted first, and they stop continuous conversions with lower priority.
+    uint8_t priority;
+    //! Called from the ADC interrupt with the result (count is 1).
+    ADC_CompleteCallback callback;
+    //! Pointer passed to callback.
+    void* ctx;
+};
+
+//! Statistics of the request queue of an ADC module (see ADC_Module::getQueueStats).
+struct ADC_QueueStats {
+    //! Requests converted.
+    uint32_t completed;
+    //! Requests not added because the queue was full.
+    uint32_t rejected;
+    //! Most requests in the queue at the same time.
+    uint8_t max_depth;
+    //! Sum of the times between submit and the start of the conversion, in us.
+    uint32_t total_wait_us;
+    //! Longest time between submit and the start of the conversion, in us.
+    uint32_t max_wait_us;
+};
+
+#if ADC_USE_PDB
+//! PDB counter settings for a frequency, see ADC_Module::solvePDB.
+struct ADC_PDBConfig {
+    //! Counts of each period, PDBx_MOD is mod-1 (1 to 65536).
+    uint32_t mod;
+    //! The counter runs at F_BUS/2^prescaler (0 to 7)...
+    uint8_t prescaler;
+    //! ... divided by 1, 10, 20 or 40 (mult 0 to 3).
+    uint8_t mult;
+    //! Frequency of the PDB with these settings, rounded to Hz.
+    uint32_t frequency;
+    //! Difference between the real and the requested frequency, in parts per million (rounded towards 0).
+    int32_t error_ppm;
+    //! False if the frequency is 0 or higher than the bus frequency, then the other fields are 0.
+    bool valid;
+};
+#endif
+
+// bits of ADCx_CFG2 and ADCx_SC3 that belong to ADC_Settings, all of ADCx_CFG1 belongs to it
+#define ADC_SETTINGS_CFG2_MASK (ADC_CFG2_ADACKEN | ADC_CFG2_ADHSC | ADC_CFG2_ADLSTS(3))
+#define ADC_SETTINGS_SC3_MASK (ADC_SC3_AVGE | ADC_SC3_AVGS(3))
+// bits of ADCx_SC2 that belong to ADC_Module::ADC_Profile: compare function and reference
+#define ADC_PROFILE_SC2_MASK (ADC_SC2_ACFE | ADC_SC2_ACFGT | ADC_SC2_ACREN | ADC_SC2_REFSEL(3))
+
+/*! Resolution, averages, conversion speed, sampling speed and reference of an ADC module.
+*   The setters only change the register values kept here, ADC_Module::commit writes CFG1, CFG2 and SC3 once each.
+*   Get the current settings with ADC_Module::getSettings.
+*/
+class ADC_Settings {
+public:
+    //! Default settings of the library: 10 bits, 4 averages, medium conversion and sampling speed and 3.3 V reference.
+    ADC_Settings();
+
+    //! Change the resolution, see ADC_Module::setResolution.
+    /**
+    *   \param bits 8, 10, 12 or 16 bits single-ended, 9, 11, 13 or 16 bits differential.
+    */
+    void setResolution(uint8_t bits);
+
+    //! Set the number of averages, see ADC_Module::setAveraging.
+    /**
+    *   \param num can be 0, 4, 8, 16 or 32.
+    */
+    void setAveraging(uint8_t num);
+
+    //! Sets the conversion speed, see ADC_Module::setConversionSpeed.
+    /**
+    *   \param speed any of the ADC_CONVERSION_SPEED enum.
+    *   \return false if speed is not valid, nothing is changed then.
+    */
+    bool setConversionSpeed(ADC_CONVERSION_SPEED speed);
+
+    //! Sets the sampling speed, see ADC_Module::setSamplingSpeed.
+    /**
+    *   \param speed any of the ADC_SAMPLING_SPEED enum.
+    */
+    void setSamplingSpeed(ADC_SAMPLING_SPEED speed);
+
+    //! Set the reference, ADC_Module::commit calibrates if it changes.
+    /**
+    *   \param ref_type any of the ADC_REFERENCE enum.
+    */
+    void setReference(ADC_REFERENCE ref_type) {
+        reference = static_cast<ADC_REF_SOURCE>(ref_type);
+    }
+
+    //! Resolution in bits.
+    uint8_t getResolution() const { return resolution; }
+    //! Maximum value of a measurement: 2^res-1.
+    uint32_t getMaxValue() const { return max_value; }
+    //! Number of averages.
+    uint8_t getAveraging() const { return averaging; }
+    //! Conversion speed.
+    ADC_CONVERSION_SPEED getConversionSpeed() const { return conversion_speed; }
+    //! Sampling speed.
+    ADC_SAMPLING_SPEED getSamplingSpeed() const { return sampling_speed; }
+    //! Reference source.
+    ADC_REF_SOURCE getReference() const { return reference; }
+
+    //! Value of ADCx_CFG1.
+    uint32_t getCFG1() const { return cfg1; }
+    //! Value of the ADC_SETTINGS_CFG2_MASK bits of ADCx_CFG2.
+    uint32_t getCFG2() const { return cfg2; }
+    //! Value of the ADC_SETTINGS_SC3_MASK bits of ADCx_SC3.
+    uint32_t getSC3() const { return sc3; }
+
+private:
+    friend class ADC_Module;
+
+    // register values
+    uint32_t cfg1, cfg2, sc3;
+
+    // maximum value possible 2^res-1
+    uint32_t max_value;
+
+    // resolution
+    uint8_t resolution;
+
+    // num of averages
+    uint8_t averaging;
+
+    // conversion speed
+    ADC_CONVERSION_SPEED conversion_speed;
+
+    // sampling speed
+    ADC_SAMPLING_SPEED sampling_speed;
+
+    // reference can be internal or external
+    ADC_REF_SOURCE reference;
+};
+
 
 
 // Mask for the channel selection in ADCx_SC1A,
@@ -384,6 +550,12 @@ enum class ADC_SAMPLING_SPEED : uint8_t {
 #define ADC_SC1A_PIN_PGA (0x80)
 
 
+// max number of pins in a scan, see startScan
+#define ADC_MAX_SCAN_PINS (32)
+
+// ADC_Module::ADC_Calibration::magic of a valid calibration, change it if the struct changes
+#define ADC_CALIBRATION_MAGIC (0xCA11)
+
 // Error codes for analogRead and analogReadDifferential
 #define ADC_ERROR_DIFF_VALUE (-70000)
 #define ADC_ERROR_VALUE ADC_ERROR_DIFF_VALUE
@@ -406,6 +578,8 @@ namespace ADC_Error {
         COMPARISON          = 1<<7, /*!< Error during the comparison. */
         WRONG_ADC           = 1<<8, /*!< A non-existent ADC module was selected. */
         SYNCH               = 1<<9, /*!< Error during a synchronized measurement. */
+        OWNED               = 1<<10, /*!< The ADC is owned, see ADC_Module::acquire. */
+        PDB_FREQ            = 1<<11, /*!< The PDB can't be set to the frequency (see ADC_Module::solvePDB), or the other ADC uses it at another one (see PDBTimebase). */
 
         CLEAR               = 0,    /*!< No error. */
     };
@@ -459,6 +633,12 @@ namespace ADC_Error {
                 case ADC_ERROR::SYNCH:
                     Serial.print("Synchronous");
                     break;
+                case ADC_ERROR::OWNED:
+                    Serial.print("ADC owned");
+                    break;
+                case ADC_ERROR::PDB_FREQ:
+                    Serial.print("PDB frequency");
+                    break;
                 case ADC_ERROR::OTHER:
                 case ADC_ERROR::CLEAR: // silence warnings
                 default:
@@ -482,6 +662,10 @@ using ADC_Error::ADC_ERROR;
 #define ADC_debug 0
 
 
+#if ADC_USE_PDB
+class PDBTimebase;
+#endif
+
 /** Class ADC_Module: Implements all functions of the Teensy 3.x, LC analog to digital converter
 *
 */
@@ -506,6 +690,34 @@ public:
     ADC_Module(uint8_t ADC_number, const uint8_t* const a_channel2sc1a, const ADC_NLIST* const a_diff_table);
 
 
+    //! Calibration values of an ADC module and the settings used to get them
+    /** It can be stored (in EEPROM for example) with exportCalibration and loaded with importCalibration to skip a calibration.
+    */
+    struct ADC_Calibration {
+        //! ADC_CALIBRATION_MAGIC if the calibration is valid.
+        uint16_t magic;
+        //! ADC module number.
+        uint8_t adc_num;
+        //! Reference used.
+        ADC_REF_SOURCE reference;
+        //! Resolution used.
+        uint8_t resolution;
+        //! Number of averages used.
+        uint8_t averaging;
+        //! Conversion speed used.
+        ADC_CONVERSION_SPEED conversion_speed;
+        //! Offset correction (OFS).
+        uint16_t ofs;
+        //! Plus-side gain (PG).
+        uint16_t pg;
+        //! Minus-side gain (MG).
+        uint16_t mg;
+        //! Plus-side calibration values CLPD, CLPS, CLP4, CLP3, CLP2, CLP1 and CLP0.
+        uint16_t clp[7];
+        //! Minus-side calibration values CLMD, CLMS, CLM4, CLM3, CLM2, CLM1 and CLM0.
+        uint16_t clm[7];
+    };
+
     //! Starts the calibration sequence, waits until it's done and writes the results
     /** Usually it's not necessary to call this function directly, but do it if the "environment" changed
     *   significantly since the program was started.
@@ -513,11 +725,53 @@ public:
     void recalibrate();
 
     //! Starts the calibration sequence
+    /** It doesn't wait for the calibration to finish. Changes made meanwhile with setResolution, setConversionSpeed,
+    *   setSamplingSpeed, setAveraging, enable/disableInterrupts and enable/disableDMA are applied when it's done,
+    *   other functions wait for it.
+    */
     void calibrate();
 
     //! Waits until calibration is finished and writes the corresponding registers
     void wait_for_cal();
 
+    //! Checks whether the calibration is over without blocking
+    /** When the calibration is over it writes the gains, applies the settings changed during the calibration
+    *   and calls the calibration callback, if any. Call it from loop() after changing the reference or calibrating.
+    *   Functions that need the calibration to be over, like analogRead, wait for it anyway.
+    *   \return the calibration state.
+    */
+    ADC_CALIBRATION_STATE pollCalibration();
+
+    //! Returns the calibration state, without checking if it's over
+    ADC_CALIBRATION_STATE getCalibrationState() __attribute__((always_inline)) {
+        return calibration_state;
+    }
+
+    //! Function to call when the calibration is done, nullptr for none
+    /** It's called by pollCalibration or by any function that waits for the calibration, so it may be inside an isr.
+    *   \param callback function to call.
+    */
+    void setCalibrationCallback(void (*callback)(void)) __attribute__((always_inline)) {
+        calibration_callback = callback;
+    }
+
+    //! Copies the last successful calibration with the current reference
+    /**
+    *   \param cal where to copy it.
+    *   \return false if the ADC is calibrating or the last calibration with the current reference failed.
+    */
+    bool exportCalibration(ADC_Calibration* cal);
+
+    //! Writes a calibration obtained with exportCalibration instead of calibrating
+    /** The reference is changed to the one of the calibration if necessary.
+    *   If the ADC is calibrating, the calibration is stopped and finished with these values,
+    *   so calling it right after creating the ADC object skips the calibration at startup.
+    *   The calibration callback is called at the end.
+    *   \param cal calibration to load.
+    *   \return false if cal is not a valid calibration of this ADC module, ADC_ERROR::CALIB is set too.
+    */
+    bool importCalibration(const ADC_Calibration* cal);
+
 
     /////////////// METHODS TO SET/GET SETTINGS OF THE ADC ////////////////////
 
@@ -525,10 +779,28 @@ public:
     /*!
     * \param ref_type can be ADC_REFERENCE::REF_3V3, ADC_REFERENCE::REF_1V2 (not for Teensy LC) or ADC_REFERENCE::REF_EXT
     *
-    *  It recalibrates at the end.
+    *  It recalibrates at the end, unless there's a calibration with this reference done with the current resolution,
+    *  averages and conversion speed, then it loads it.
     */
     void setReference(ADC_REFERENCE ref_type);
 
+    //! Forget the calibrations kept for each reference, so the next setReference calibrates
+    void clearCalibrationCache();
+
+    //! Returns the current settings
+    /** If the ADC is calibrating, they include the changes that will be applied when it's done.
+    *   \return the settings.
+    */
+    ADC_Settings getSettings();
+
+    //! Writes new settings to the ADC
+    /** Each register (CFG1, CFG2 and SC3) is written at most once, and only if it changes.
+    *   If the reference changes it calls setReference, which may calibrate.
+    *   If the ADC is calibrating the settings are applied when it's done.
+    *   \param new_settings settings to write.
+    */
+    void commit(const ADC_Settings& new_settings);
+
 
     //! Change the resolution of the measurement.
     /*!
@@ -598,6 +870,59 @@ public:
     void setAveraging(uint8_t num);
 
 
+    //! Time that a conversion takes with the current settings.
+    /** It's calculated from the resolution, averages, ADC clock and sampling time set in the registers
+    *   as explained in the "Conversion time" section of the reference manual.
+    *   The ADACK frequencies are the typical ones, the real ones can be quite different.
+    *   The time the code takes to start the conversion and read the result (in analogRead for example) is not included.
+    *   \param differential true for differential conversions, which take longer.
+    *   \param continuous true for the second and following continuous conversions,
+    *          false for single (software or hardware triggered) conversions and the first continuous one.
+    *   \return the conversion time in ns.
+    */
+    uint32_t getConversionTimeNs(bool differential = false, bool continuous = false);
+
+    //! Maximum sample rate with the current settings.
+    /** This is the rate at which single conversions can be triggered, by the PDB for example,
+    *   continuous conversions are a bit faster.
+    *   \param differential true for differential conversions.
+    *   \return the maximum rate in Hz.
+    */
+    uint32_t getMaxSampleRate(bool differential = false);
+
+    //! Choose the averages, conversion and sampling speed with the least noise that can convert at targetHz.
+    /** More averages are preferred, then the slowest conversion and sampling speed that is fast enough.
+    *   The resolution isn't changed, and only conversion speeds within specs for it are used.
+    *   If targetHz can't be reached the settings are not changed and ADC_ERROR::OTHER is set.
+    *   \param targetHz rate of single (triggered) conversions in Hz.
+    *   \param differential true for differential conversions.
+    *   \return true if the settings meet targetHz.
+    */
+    bool configureForRate(uint32_t targetHz, bool differential = false);
+
+    //! Conversion time for the given CFG1, CFG2 and SC3 values, see getConversionTimeNs.
+    /** It doesn't access the registers so it can be used to check settings before applying them.
+    *   \param cfg1 value of ADCx_CFG1.
+    *   \param cfg2 value of ADCx_CFG2.
+    *   \param sc3 value of ADCx_SC3.
+    *   \param differential true for differential conversions.
+    *   \param continuous true for the second and following continuous conversions.
+    *   \return the conversion time in ns.
+    */
+    static uint32_t conversionTimeNs(uint32_t cfg1, uint32_t cfg2, uint32_t sc3, bool differential, bool continuous);
+
+    //! Estimated time until a conversion started now would be done, in ns.
+    /** The ADC class uses it to choose the ADC when both can convert the pins.
+    *   It's the conversion time with the current settings (see getConversionTimeNs) times the number of conversions before it and itself:
+    *   the blocking reads in progress (an analogRead interrupted by another one, for example) and the requests in the queue (see submit).
+    *   Continuous conversions, scans, hardware triggered or DMA conversions and calibrations don't end by themselves,
+    *   so they add ADC_BUSY_WORK_NS instead: the other ADC is used unless it has more work than that.
+    *   \param differential true for a differential conversion.
+    *   \return the time in ns, it saturates instead of overflowing.
+    */
+    uint32_t getCompletionTimeNs(bool differential = false);
+
+
     //! Enable interrupts
     /** An IRQ_ADCx Interrupt will be raised when the conversion is completed
     *  (including hardware averages and if the comparison (if any) is true).
@@ -607,6 +932,19 @@ public:
     //! Disable interrupts
     void disableInterrupts();
 
+    //! Calls fn from the ADC interrupt when a conversion, or batch conversions, are done.
+    /** The library handles the ADC interrupt then, don't define adcX_isr. For each conversion it:
+    *   reads the result (or calls scanStep() if a scan is running, see startScan), calls fn when batch results are stored
+    *   and restores the conversion interrupted by startSingleRead, if any.
+    *   It also enables the interrupts.
+    *   \param fn function to call, nullptr removes it, disables the interrupts and sets adcX_isr as the interrupt again.
+    *   \param ctx pointer passed to fn.
+    *   \param batch number of results for each call to fn.
+    *   \param buffer where the results are kept until fn is called, it must hold batch values. It can be nullptr if batch is 1.
+    *   \return false if batch is 0, or more than 1 without a buffer; ADC_ERROR::OTHER is set too.
+    */
+    bool onComplete(ADC_CompleteCallback fn, void* ctx = nullptr, uint16_t batch = 1, uint16_t* buffer = nullptr);
+
 
     //! Enable DMA request
     /** An ADC DMA request will be raised when the conversion is completed
@@ -715,6 +1053,14 @@ public:
         //return ((ADC_SC1A) & ADC_SC1_COCO) >> 7;
     }
 
+    //! Is the conversion of SC1B ready? Only the PDB converts it, see startPDBDual.
+    /**
+    *  \return true if yes, false if not.
+    */
+    volatile bool isCompleteB() __attribute__((always_inline)) {
+        return atomic::getBitFlag(ADC_SC1B, ADC_SC1_COCO);
+    }
+
     //! Is the ADC in differential mode?
     /**
     *   \return true or false
@@ -760,6 +1106,15 @@ public:
     */
     bool checkDifferentialPins(uint8_t pinP, uint8_t pinN);
 
+    //! Get the SC1A number of a pin, with the mux info in bit 7 (ADC_SC1A_PIN_MUX)
+    /** It doesn't check the pin, call checkPin first.
+    *   \param pin valid analog pin.
+    *   \return the SC1A number.
+    */
+    uint8_t getSC1A(uint8_t pin) __attribute__((always_inline)) {
+        return channel2sc1a[pin];
+    }
+
 
     //////////////// HELPER METHODS FOR CONVERSION /////////////////
 
@@ -768,7 +1123,26 @@ public:
     *   doesn't change the continuous conversion bit.
     *   \param pin to read.
     */
-    void startReadFast(uint8_t pin); // helper method
+    void startReadFast(uint8_t pin) __attribute__((always_inline)) { // helper method
+        startReadFastSC1A(channel2sc1a[pin]);
+    }
+
+    //! Starts a single-ended conversion on the SC1A number
+    /** Same as startReadFast, but with the SC1A number of the pin (see getSC1A), with the mux info in bit 7.
+    *   \param sc1a_pin SC1A number of the pin to read.
+    */
+    void startReadFastSC1A(uint8_t sc1a_pin) __attribute__((always_inline)) {
+        if(sc1a_pin&ADC_SC1A_PIN_MUX) { // mux a
+            atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+        } else { // mux b
+            atomic::setBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+        }
+
+        // select pin for single-ended mode and start conversion, enable interrupts if requested
+        __disable_irq();
+        ADC_SC1A = (sc1a_pin&ADC_SC1A_CHANNELS) + atomic::getBitFlag(ADC_SC1A, ADC_SC1_AIEN)*ADC_SC1_AIEN;
+        __enable_irq();
+    }
 
     //! Starts a differential conversion on the pair of pins
     /** It sets the mux correctly, doesn't do any of the checks on the pin and
@@ -790,6 +1164,13 @@ public:
     */
     int analogRead(uint8_t pin);
 
+    //! Returns the analog value of the SC1A number.
+    /** Same as analogRead, but with the SC1A number of the pin (see getSC1A), which isn't checked.
+    *   \param sc1a_pin SC1A number of the pin to read.
+    *   \return the value of the pin.
+    */
+    int analogReadSC1A(uint8_t sc1a_pin);
+
     //! Returns the analog value of the special internal source, such as the temperature sensor.
     /** It calls analogRead(uint8_t pin) internally, with the correct value for the pin for all boards.
     *   Possible values:
@@ -817,6 +1198,67 @@ public:
     int analogReadDifferential(uint8_t pinP, uint8_t pinN);
 
 
+    /////////////// OWNED CONVERSION METHODS //////////////
+
+    //! Takes the ADC for exclusive use with readOwned.
+    /** It waits for the calibration and fails if the ADC is owned or busy (converting, continuous, scanning or hardware triggered).
+    *   The ADC interrupts and DMA are disabled until release is called.
+    *   While it's owned the other conversion methods fail and set ADC_ERROR::OWNED,
+    *   don't change the settings or calibrate from other places in the meantime.
+    *   \return true if the ADC is now owned by the caller.
+    */
+    bool acquire();
+
+    //! Frees the ADC taken with acquire.
+    /** The interrupts and DMA are enabled again if they were before acquire.
+    */
+    void release();
+
+    //! Is the ADC owned?
+    /**
+    *   \return true between acquire and release.
+    */
+    volatile bool isOwned() __attribute__((always_inline)) {
+        return owned;
+    }
+
+    //! Returns the analog value of the pin, only while the ADC is owned.
+    /** Like analogRead, but it doesn't check the pin or calibration, doesn't save and restore the ADC and doesn't disable the interrupts.
+    *   If a comparison has been set up and fails, it will return ADC_ERROR_VALUE.
+    *   \param pin pin to read, it must be valid for this ADC (see checkPin).
+    *   \return the value of the pin.
+    */
+    int readOwned(uint8_t pin) __attribute__((always_inline)) {
+        return readOwnedSC1A(channel2sc1a[pin]);
+    }
+
+    //! Returns the analog value of the SC1A number, only while the ADC is owned.
+    /** Same as readOwned, but with the SC1A number of the pin (see getSC1A).
+    *   \param sc1a_pin SC1A number of the pin to read.
+    *   \return the value of the pin.
+    */
+    int readOwnedSC1A(uint8_t sc1a_pin) __attribute__((always_inline)) {
+        if(sc1a_pin&ADC_SC1A_PIN_MUX) { // mux a
+            atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+        } else { // mux b
+            atomic::setBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+        }
+
+        // the interrupts are disabled while owned, so nobody else changes SC1A
+        ADC_SC1A = sc1a_pin&ADC_SC1A_CHANNELS;
+
+        while(isConverting()) {
+        }
+
+        if (isComplete()) { // conversion succeded
+            return (uint16_t)ADC_RA;
+        }
+        // comparison was false
+        fail_flag |= ADC_ERROR::COMPARISON;
+        return ADC_ERROR_VALUE;
+    }
+
+
     /////////////// NON-BLOCKING CONVERSION METHODS //////////////
 
     //! Starts an analog measurement on the pin and enables interrupts.
@@ -845,6 +1287,14 @@ public:
     }
 
 
+    //! Reads the analog value of the SC1B conversion, see startPDBDual.
+    /** \return the converted value.
+    */
+    int readSingleB() __attribute__((always_inline)) {
+        return (int16_t)(int32_t)ADC_RB;
+    }
+
+
     ///////////// CONTINUOUS CONVERSION METHODS ////////////
 
     //! Starts continuous conversion on the pin.
@@ -876,23 +1326,142 @@ public:
     void stopContinuous();
 
 
+    ///////////// SCAN METHODS ////////////
+
+    //! Starts converting the pins one after the other, back to back.
+    /** The pins are checked once here, then each conversion is started by scanStep() from the adc isr
+    *   (call adc->adcX->scanStep() inside adcX_isr), so the pins aren't checked and the config isn't saved every time.
+    *   The results are stored in frames: dst[frame*num_pins + i] is the value of pins[i] in that frame.
+    *   If this function interrupts a measurement, it stores the settings in adc_config and restores them at the end.
+    *   \param pins single-ended pins to convert, they must all be valid in this ADC.
+    *   \param num_pins number of pins, up to ADC_MAX_SCAN_PINS.
+    *   \param dst buffer for the results, it must hold num_pins*frames values.
+    *   \param frames number of times to scan all pins.
+    *   \return true if the pins are valid, false otherwise.
+    */
+    bool startScan(const uint8_t* pins, uint8_t num_pins, volatile uint16_t* dst, uint32_t frames = 1);
+
+    //! Stores the last result of the scan and starts the next conversion, call it inside the adc isr.
+    /** \return true if the scan continues, false if it's finished (or there wasn't any).
+    */
+    bool scanStep();
+
+    //! Stops the scan, the values already converted remain in dst
+    /** The interrupts are enabled or disabled as they were before startScan.
+    */
+    void stopScan();
+
+    //! Is a scan in progress?
+    /** \return true if it is, false when all frames are done.
+    */
+    volatile bool isScanning() __attribute__((always_inline)) {
+        return scan_dst != nullptr;
+    }
+
+
+    ///////////// REQUEST QUEUE ////////////
+
+    //! Adds a conversion to the queue of this ADC, its callback is called with the result from the ADC interrupt.
+    /** Requests are converted one after the other, by priority and in the order they were submitted.
+    *   If the ADC is converting (startSingleRead, a continuous conversion with lower priority, see setContinuousPriority)
+    *   the conversion is stopped, the requests are converted and then the ADC is restored and the conversion restarted.
+    *   Blocking reads (analogRead, analogReadDifferential) aren't stopped, the requests start when they are done,
+    *   and a blocking read waits for the request being converted, so they take turns.
+    *   The start methods (startSingleRead, startContinuous, startScan...) also wait for the request being converted,
+    *   then the requests stop the new conversion (or wait for it, see setContinuousPriority) and restore it when they are done.
+    *   A request waits at most for the conversion in progress and the requests with the same or higher priority.
+    *   The library handles the ADC interrupt (see onComplete), don't define adcX_isr.
+    *   \param request pin(s), priority and callback, the pins are checked here.
+    *   \return true if it was added, false if the pins are wrong (ADC_ERROR::WRONG_PIN) or the queue is full (ADC_ERROR::OTHER).
+    */
+    bool submit(const ADC_Request& request);
+
+    //! Priority of the continuous conversions.
+    /** Requests with a higher priority stop them, the others wait until stopContinuous is called.
+    *   \param priority priority, 0 by default.
+    */
+    void setContinuousPriority(uint8_t priority);
+
+    //! Number of requests in the queue, including the one being converted.
+    volatile uint8_t getQueueDepth() __attribute__((always_inline)) {
+        return queue_depth;
+    }
+
+    //! Statistics of the request queue since the start or resetQueueStats.
+    ADC_QueueStats getQueueStats();
+
+    //! Resets the statistics of the request queue.
+    void resetQueueStats();
+
+    //! Removes the requests that are waiting, the one being converted finishes normally.
+    void clearQueue();
+
+
     //////////// PDB ////////////////
     //// Only works for Teensy 3.0 and 3.1, not LC (it doesn't have PDB)
     #if ADC_USE_PDB
 
     //! Start PDB triggering the ADC at the frequency
     /** Call startSingleRead or startSingleDifferential on the pin that you want to measure before calling this function.
-    *   See the example adc_pdb.ino.
-    *   \param freq is the frequency of the ADC conversion, it can't be lower that 1 Hz
+    *   See the example adc_pdb.ino. The PDB settings are the closest to freq, see solvePDB.
+    *   Both ADCs share the PDB counter (see PDBTimebase): if the other ADC is using it, this one is triggered at the same time
+    *   when the frequency is the same, otherwise it fails.
+    *   \param freq is the frequency of the ADC conversion, from 1 Hz to F_BUS.
+    *   \return false if the frequency is out of range or the other ADC uses another one (ADC_ERROR::PDB_FREQ), then the PDB isn't changed.
+    */
+    bool startPDB(uint32_t freq);
+
+    //! Start PDB triggering the ADC with settings found by solvePDB
+    /** With a constant frequency the settings can be computed at compile time:
+    *   constexpr ADC_PDBConfig pdb_44k1 = ADC_Module::solvePDB(44100);
+    *   \param config PDB settings.
+    *   \return false if the config isn't valid (ADC_ERROR::PDB_FREQ).
     */
-    void startPDB(uint32_t freq);
+    bool startPDB(const ADC_PDBConfig& config);
+
+    //! Start PDB triggering two conversions each period, pinA from SC1A and pinB from SC1B
+    /** Pretrigger A starts the conversion of pinA delayA counts after the start of each period. With back_to_back
+    *   pretrigger B starts pinB as soon as pinA is converted, otherwise it starts delayB counts after the start of the period.
+    *   The counts are periods of the PDB counter, F_BUS/(2^prescaler*mult) (see solvePDB). The CPU isn't involved.
+    *   Both conversions must fit in the period, and without back_to_back delayB-delayA must be longer than a conversion (see getConversionTimeNs).
+    *   Read the results with readSingle() (pinA) and readSingleB() (pinB). With interrupts enabled both raise the ADC interrupt,
+    *   check isComplete() and isCompleteB() in adcX_isr. onComplete receives the values of A and B alternately.
+    *   \param pinA pin converted by pretrigger A.
+    *   \param pinB pin converted by pretrigger B. If both pins are on channels 4 to 7 they must use the same mux (see getSC1A).
+    *   \param freq frequency of the pairs of conversions.
+    *   \param back_to_back start B when A finishes, delayB is ignored then.
+    *   \param delayA counts from the start of the period to pretrigger A.
+    *   \param delayB counts from the start of the period to pretrigger B.
+    *   \return false if the pins (ADC_ERROR::WRONG_PIN), the frequency (ADC_ERROR::PDB_FREQ) or the delays (ADC_ERROR::OTHER) are wrong.
+    */
+    bool startPDBDual(uint8_t pinA, uint8_t pinB, uint32_t freq, bool back_to_back = true, uint16_t delayA = 0, uint16_t delayB = 0);
+
+    //! Start PDB triggering two conversions each period, with settings found by solvePDB
+    /** See startPDBDual(uint8_t, uint8_t, uint32_t, bool, uint16_t, uint16_t).
+    */
+    bool startPDBDual(uint8_t pinA, uint8_t pinB, const ADC_PDBConfig& config, bool back_to_back = true, uint16_t delayA = 0, uint16_t delayB = 0);
 
-    //! Stop the PDB
+    //! Stop the PDB triggering this ADC
+    /** The PDB counter stops too, unless the other ADC is using it.
+    */
     void stopPDB();
 
-    //! Return the PDB's frequency
+    //! Return the PDB's frequency, rounded to Hz
     uint32_t getPDBFrequency();
 
+    //! PDB settings with the smallest frequency error
+    /** All prescaler and mult combinations are tried, with the MOD values just below and above F_BUS/(freq*prescaler*mult),
+    *   and the one with the smallest relative error is chosen.
+    *   It's constexpr, so with a constant freq it's computed at compile time.
+    *   \param freq requested frequency in Hz.
+    *   \param bus_freq frequency of the bus clock that the PDB uses.
+    *   \return the settings, the real frequency and its error.
+    */
+    static constexpr ADC_PDBConfig solvePDB(uint32_t freq, uint32_t bus_freq = F_BUS) {
+        return ((freq == 0) || (freq > bus_freq)) ? ADC_PDBConfig{0, 0, 0, 0, 0, false} :
+               pdbConfig(freq, bus_freq, pdbSearch(freq, bus_freq, 0, 0));
+    }
+
     #endif
 
 
@@ -902,6 +1471,8 @@ public:
     struct ADC_Config {
         //! ADC registers
         uint32_t savedSC1A, savedSC2, savedSC3, savedCFG1, savedCFG2;
+        //! Compare values and PGA, only saved in profiles
+        uint32_t savedCV1, savedCV2, savedPGA;
     } adc_config;
 
     //! Was the adc in use before a call?
@@ -925,8 +1496,67 @@ public:
         ADC_SC1A = config->savedSC1A; // restore last
     }
 
+    //! Settings, compare, PGA and calibration of the ADC, saved with saveProfile and written with applyProfile.
+    /** Configure the ADC once with the usual functions, save the profile, and switch between profiles with applyProfile.
+    *   All register values are computed when the profile is saved.
+    */
+    class ADC_Profile {
+    public:
+        //! Empty profile, applyProfile rejects it until saveProfile fills it.
+        ADC_Profile() : pga_value(1), calibration_id(0), valid(false) {
+            calibration.magic = 0;
+        }
+
+        //! Resolution, averaging, speeds and reference of the profile.
+        const ADC_Settings& getSettings() const {return settings;}
+
+        //! Has it been saved?
+        bool isValid() const {return valid;}
+
+        //! Does it include a calibration?
+        /** Only if the last calibration before saving it didn't fail.
+        */
+        bool isCalibrated() const {return calibration.magic == ADC_CALIBRATION_MAGIC;}
+
+    private:
+        friend class ADC_Module;
+
+        //! Register values, SC2 has only the compare and reference bits.
+        ADC_Config config;
+        //! Resolution, averaging, speeds and reference (CFG1, CFG2 and SC3).
+        ADC_Settings settings;
+        //! PGA gain.
+        uint8_t pga_value;
+        //! Calibration registers when it was saved.
+        ADC_Calibration calibration;
+        //! ADC_Module::loaded_calibration when it was saved, applyProfile doesn't write the same calibration again.
+        uint32_t calibration_id;
+        //! Set by saveProfile.
+        bool valid;
+    };
+
+    //! Save the settings, compare, PGA and calibration of the ADC to a profile
+    /** If the ADC is calibrating it waits until it's done.
+    *   To include a calibration with these settings call recalibrate() before.
+    *   \param profile where to store them.
+    */
+    void saveProfile(ADC_Profile* profile);
+
+    //! Write the settings, compare, PGA and calibration of a profile to the ADC
+    /** It only writes the registers, it doesn't wait or check anything. The settings that don't change
+    *   and a calibration that is loaded already (for example by the last profile applied) aren't written again.
+    *   If the profile has a calibration, a running calibration is stopped; if not it waits until the calibration is done.
+    *   The calibration callback is called if a running calibration is stopped.
+    *   Interrupts, DMA, continuous mode and hardware trigger aren't changed.
+    *   \param profile a profile saved by saveProfile of this ADC module.
+    *   \return true if it was applied, false if the profile wasn't saved or belongs to a different ADC.
+    */
+    bool applyProfile(const ADC_Profile& profile);
+
 
     //! Number of measurements that the ADC is performing
+    /** Blocking reads, continuous conversions and scans in progress, see getCompletionTimeNs for an estimate of the work.
+    */
     uint8_t num_measurements;
 
 
@@ -959,26 +1589,137 @@ private:
     // when this calibration is over the averages and speed will be set to default.
     uint8_t init_calib;
 
-    // resolution
-    uint8_t analog_res_bits;
+    // state of the calibration
+    volatile ADC_CALIBRATION_STATE calibration_state;
+
+    // called when the calibration is done
+    void (*calibration_callback)(void);
+
+    // settings that can be changed during the calibration without waiting for it
+    enum ADC_SETTING : uint8_t {
+        SETTING_RESOLUTION,
+        SETTING_CONVERSION_SPEED,
+        SETTING_SAMPLING_SPEED,
+        SETTING_AVERAGING,
+        SETTING_INTERRUPTS,
+        SETTING_DMA,
+        NUM_SETTINGS
+    };
+    // new values of the settings changed during the calibration
+    uint8_t pending_settings[NUM_SETTINGS];
+    // bit n is set if pending_settings[n] has to be applied
+    volatile uint8_t pending_mask;
 
-    // maximum value possible 2^res-1
-    uint32_t analog_max_val;
+    // stores the setting if the ADC is calibrating, returns true in that case
+    bool queueSetting(ADC_SETTING setting, uint8_t value);
 
-    // num of averages
-    uint8_t analog_num_average;
+    // writes the gains and applies the pending settings
+    void finish_cal();
 
-    // reference can be internal or external
-    ADC_REF_SOURCE analog_reference_internal;
+    // applies the default settings after the first calibration and the pending settings, with interrupts disabled
+    void apply_pending_settings();
+
+    // settings with the defaults after the first calibration and the pending settings
+    ADC_Settings settingsAfterCalibration();
+
+    // last successful calibration with each reference (REF_DEFAULT and REF_ALT)
+    ADC_Calibration calibration_cache[2];
+
+    // calibrations started or imported, each one gets the next number
+    uint32_t calibration_count;
+    // number of the calibration in the registers, saveProfile stores it with the calibration
+    uint32_t loaded_calibration;
+
+    // reads the calibration registers and the current settings
+    void readCalibration(ADC_Calibration* cal);
+
+    // writes the calibration registers
+    void writeCalibration(const ADC_Calibration* cal);
+
+    // changes the reference without calibrating
+    void setReferenceSource(ADC_REF_SOURCE ref_type);
+
+    // resolution, averages, speeds and reference, they are the values in the registers
+    ADC_Settings settings;
 
     // value of the pga
     uint8_t pga_value;
 
-    // conversion speed
-    ADC_CONVERSION_SPEED conversion_speed;
+    // set by onComplete, used by dispatchComplete
+    ADC_CompleteCallback complete_callback;
+    void* complete_ctx;
+    uint16_t* complete_buffer;
+    uint16_t complete_value; // buffer of batches of 1
+    uint16_t complete_batch;
+    uint16_t complete_count;
+
+    // reads the result of the conversion and calls the completion callback, in the ADC interrupt
+    void dispatchComplete();
+    // adds a result to complete_buffer, used by dispatchComplete
+    void storeComplete(uint16_t value);
+
+    // the ADC interrupt calls dispatchComplete from now on
+    void attachDispatch();
+
+    // a request waiting in the queue and when it was submitted
+    struct QueuedRequest {
+        ADC_Request request;
+        uint32_t submit_us;
+    };
+    // sorted by priority, request_queue[0] is converting if queue_active
+    QueuedRequest request_queue[ADC_REQUEST_QUEUE_SIZE];
+    volatile uint8_t queue_depth;
+    // the queue is converting its requests, from the first one until it's empty (or a continuous conversion is restored)
+    volatile bool queue_active;
+    // start methods in progress, the queue doesn't start until they set the ADC
+    volatile uint8_t queue_held;
+    // the queue stopped a conversion, it's restarted from queue_saved_config when the queue is done
+    bool queue_preempted;
+    // the stopped conversion was continuous, only requests with higher priority can keep it stopped
+    bool queue_preempted_continuous;
+    // state of the ADC before the queue started
+    ADC_Config queue_saved_config;
+    uint8_t continuous_priority;
+    ADC_QueueStats queue_stats;
+
+    // conversion time of the blocking reads in progress, in ns.
+    // Interrupts that read add and remove the same amount before returning, so += and -= don't need the interrupts disabled
+    volatile uint32_t work_ns;
+    // the continuous conversion is counted in num_measurements, so starting it twice or stopping it twice counts once
+    bool continuous_counted;
+    // settings of the cached single-ended and differential conversion times
+    uint32_t work_cfg1, work_cfg2, work_sc3;
+    uint32_t work_conversion_ns[2];
+    // getConversionTimeNs of a single conversion, only computed again when the settings change
+    uint32_t cachedConversionTimeNs(bool differential);
+
+    // starts the queue if nothing it has to wait for is converting, with interrupts disabled
+    void startQueue();
+    // a blocking read waits for the request being converted
+    void waitForRequest();
+    // a start method waits for the request being converted and stops the next one
+    void holdQueue();
+    // the start method set the ADC, the queue starts again and saves it
+    void releaseQueue();
+    // starts the conversion of request_queue[0], with interrupts disabled
+    void startNextRequest();
+    // the request is converted: remove it, start the next one and call its callback, in the ADC interrupt
+    void requestDone();
+    // restores the ADC after the last request
+    void finishQueue();
+
+    // modules with a completion callback, by ADC number
+    static ADC_Module* dispatch_table[ADC_NUM_ADCS];
+    // interrupt functions that call dispatchComplete of dispatch_table[0] or [1]
+    static void adc0_dispatch();
+    #if ADC_NUM_ADCS>1
+    static void adc1_dispatch();
+    #endif
 
-    // sampling speed
-    ADC_SAMPLING_SPEED sampling_speed;
+    // set by acquire
+    volatile bool owned;
+    // interrupts and DMA enabled before acquire
+    bool owned_interrupts, owned_dma;
 
     // translate pin number to SC1A nomenclature
     const uint8_t* const channel2sc1a;
@@ -986,6 +1727,80 @@ private:
     // same for differential pins
     const ADC_NLIST* const diff_table;
 
+    // SC1A number (with mux info) of the pins being scanned
+    uint8_t scan_sc1a[ADC_MAX_SCAN_PINS];
+    // number of pins being scanned
+    uint8_t scan_num_pins;
+    // pin being converted now, index of scan_sc1a
+    uint8_t scan_index;
+    // next value of the scan is stored here, nullptr if there's no scan
+    volatile uint16_t* volatile scan_dst;
+    // values left to convert (including the current one)
+    uint32_t scan_remaining;
+    // ADC_SC1_AIEN if the interrupts were enabled before the scan, restored by stopScan
+    uint8_t scan_aien;
+
+    #if ADC_USE_PDB
+    // solvePDB, one line each to be constexpr in C++11.
+    // A candidate is index<<17 | mod, with index = prescaler + 8*mult and mod from 1 to 65536; 0 means none.
+
+    // counter divider of the index: 2^prescaler * (1, 10, 20 or 40)
+    static constexpr uint32_t pdbDivider(uint32_t index) {
+        return (1UL << (index & 7)) * ((index >> 3) ? (10UL << ((index >> 3) - 1)) : 1UL);
+    }
+    // bus cycles of each period
+    static constexpr uint64_t pdbPeriod(uint32_t candidate) {
+        return (uint64_t)pdbDivider(candidate >> 17) * (candidate & 0x1FFFF);
+    }
+    static constexpr uint32_t pdbCandidate(uint32_t index, uint64_t mod) {
+        return (index << 17) | ((mod < 1) ? 1 : ((mod > 65536) ? 65536 : (uint32_t)mod));
+    }
+    // |bus_freq - freq*period|, the relative error is this divided by freq*period
+    static constexpr uint64_t pdbDifference(uint32_t freq, uint32_t bus_freq, uint64_t period) {
+        return (freq*period > bus_freq) ? freq*period - bus_freq : bus_freq - freq*period;
+    }
+    // candidate has a smaller relative error than best, compared cross-multiplying.
+    // Only candidates with less than 100% error are taken, so the differences are below bus_freq and the products fit in 64 bits
+    static constexpr bool pdbBetter(uint32_t freq, uint32_t bus_freq, uint32_t candidate, uint32_t best) {
+        return (freq*pdbPeriod(candidate) <= 2ULL*bus_freq)
+               && ( (best == 0) || (pdbDifference(freq, bus_freq, pdbPeriod(candidate))*pdbPeriod(best)
+                                    < pdbDifference(freq, bus_freq, pdbPeriod(best))*pdbPeriod(candidate)) );
+    }
+    static constexpr uint32_t pdbPick(uint32_t freq, uint32_t bus_freq, uint32_t candidate, uint32_t best) {
+        return pdbBetter(freq, bus_freq, candidate, best) ? candidate : best;
+    }
+    // mod just below the exact one, the one above is mod+1
+    static constexpr uint64_t pdbModBelow(uint32_t freq, uint32_t bus_freq, uint32_t index) {
+        return bus_freq/((uint64_t)freq*pdbDivider(index));
+    }
+    // best candidate of the dividers from index to 31
+    static constexpr uint32_t pdbSearch(uint32_t freq, uint32_t bus_freq, uint32_t index, uint32_t best) {
+        return (index == 32) ? best :
+               pdbSearch(freq, bus_freq, index + 1,
+                         pdbPick(freq, bus_freq, pdbCandidate(index, pdbModBelow(freq, bus_freq, index) + 1),
+                                 pdbPick(freq, bus_freq, pdbCandidate(index, pdbModBelow(freq, bus_freq, index)), best)));
+    }
+    static constexpr ADC_PDBConfig pdbConfig(uint32_t freq, uint32_t bus_freq, uint32_t best) {
+        return ADC_PDBConfig{best & 0x1FFFF, (uint8_t)((best >> 17) & 7), (uint8_t)(best >> 20),
+                             (uint32_t)((bus_freq + pdbPeriod(best)/2)/pdbPeriod(best)),
+                             (int32_t)(((int64_t)bus_freq - (int64_t)(freq*pdbPeriod(best)))*1000000/(int64_t)(freq*pdbPeriod(best))),
+                             true};
+    }
+
+    // the PDB counter shared by both modules writes PDB0_CHnC1 and the delays
+    friend class PDBTimebase;
+    #endif
+
+    //! Starts a conversion on the SC1A number (with mux info) and enables interrupts, used by the scan
+    void startScanConversion(uint8_t sc1a_pin) __attribute__((always_inline)) {
+        if(sc1a_pin&ADC_SC1A_PIN_MUX) { // mux a
+            atomic::clearBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+        } else { // mux b
+            atomic::setBitFlag(ADC_CFG2, ADC_CFG2_MUXSEL);
+        }
+        ADC_SC1A = (sc1a_pin&ADC_SC1A_CHANNELS) + ADC_SC1_AIEN;
+    }
+
 
     //! Get the SC1A value of the differential pair for this pin
     uint8_t getDifferentialPair(uint8_t pin) {
@@ -1002,7 +1817,11 @@ private:
     void analog_init();
 
     // registers point to the correct ADC module
+    #if defined(ADC_HOST_SIM)
+    typedef ADC_HostSim::Register& reg; // simulated registers, see host/ADC_HostSim.h
+    #else
     typedef volatile uint32_t& reg;
+    #endif
 
     // registers that control the adc module
     reg ADC_SC1A;
@@ -1042,6 +1861,8 @@ private:
     reg ADC_CLM0;
 
     reg PDB0_CHnC1; // PDB channel 0 or 1
+    reg PDB0_CHnDLY0; // delays of its pretriggers
+    reg PDB0_CHnDLY1;
 
     const uint8_t IRQ_ADC; // IRQ number will be IRQ_ADC0 or IRQ_ADC1
 
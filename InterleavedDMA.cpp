@@ -0,0 +1,133 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "InterleavedDMA.h"
+
+#if ADC_NUM_ADCS>1 && ADC_USE_PDB
+
+// Constructor, each frame of SyncDMA is a sample of ADC0 followed by one of ADC1
+InterleavedDMA::InterleavedDMA(ADC* a_adc, volatile uint16_t* samples, uint16_t a_num_samples) :
+        SyncDMA(a_adc, (volatile Frame*)samples, a_num_samples/2)
+        , p_samples(samples)
+        , num_samples(a_num_samples & ~1)
+        {
+
+    resetMatch();
+}
+
+bool InterleavedDMA::start(uint8_t pin, uint32_t sample_rate) {
+
+    if(!adc->adc0->checkPin(pin)) {
+        adc->adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+    if(!adc->adc1->checkPin(pin)) {
+        adc->adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    const uint32_t freq = sample_rate/2; // of each ADC
+    if(!prepare(freq, false)) {
+        return false;
+    }
+
+    // with hardware trigger writing SC1A selects the pin, the PDB starts the conversions
+    adc->adc0->startReadFast(pin);
+    adc->adc1->startReadFast(pin);
+
+    // ADC1 half a period after ADC0
+    const ADC_PDBConfig config = ADC_Module::solvePDB(freq);
+    startTrigger(config, config.mod/2);
+    return true;
+}
+
+/* Each ADC converts two references well above 0 V, the temperature sensor (about 0.72 V) and the bandgap (1 V),
+*  so a negative offset doesn't clip at 0 counts like it would with VREFL. ADC0 is the reference: the line through
+*  the two points of ADC1 is mapped onto the line of ADC0, the gain is the ratio of the differences between the
+*  references and the offset of ADC1 is its value where ADC0 reads 0. The calibration of each ADC already corrects most of it,
+*  this is what's left, and what makes the interleaved samples of a constant signal alternate.
+*/
+bool InterleavedDMA::match(uint16_t num_reads) {
+    if(isRunning() || (num_reads == 0)) {
+        adc->adc0->fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    atomic::setBitFlag(PMC_REGSC, PMC_REGSC_BGBE); // the bandgap must be enabled to read it
+
+    int64_t low[2], high[2];
+    for(uint8_t i = 0; i < 2; i++) {
+        low[i] = sumReads(i, ADC_INTERNAL_SOURCE::TEMP_SENSOR, num_reads);
+        high[i] = sumReads(i, ADC_INTERNAL_SOURCE::BANDGAP, num_reads);
+        if( (low[i] <= 0) || (high[i] <= low[i]) ) {
+            adc->adc[i]->fail_flag |= ADC_ERROR::OTHER;
+            return false;
+        }
+    }
+
+    const int64_t span0 = high[0] - low[0];
+    const int64_t span1 = high[1] - low[1];
+    // low[1]/num_reads - (low[0]/num_reads)*span1/span0, rounded
+    const int64_t num = low[1]*span0 - low[0]*span1;
+    const int64_t den = num_reads*span0;
+
+    offset[0] = 0;
+    gain[0] = 1 << 16;
+    offset[1] = ((num < 0) ? num - den/2 : num + den/2)/den;
+    gain[1] = ((span0 << 16) + span1/2)/span1;
+    return true;
+}
+
+void InterleavedDMA::resetMatch() {
+    for(uint8_t i = 0; i < 2; i++) {
+        offset[i] = 0;
+        gain[i] = 1 << 16;
+    }
+}
+
+void InterleavedDMA::copy(int32_t* dst, uint32_t first, uint16_t count) {
+    for(uint16_t i = 0; i < count; i++) {
+        dst[i] = sample(first + i);
+    }
+}
+
+int64_t InterleavedDMA::sumReads(uint8_t adc_num, ADC_INTERNAL_SOURCE source, uint16_t num_reads) {
+    ADC_Module* const adc_module = adc->adc[adc_num];
+    adc_module->analogRead(source); // the first one after changing the channel, to let it settle
+
+    int64_t sum = 0;
+    for(uint16_t i = 0; i < num_reads; i++) {
+        const int value = adc_module->analogRead(source);
+        if(value == ADC_ERROR_VALUE) {
+            return -1;
+        }
+        sum += value;
+    }
+    return sum;
+}
+
+#endif // ADC_NUM_ADCS>1 && ADC_USE_PDB
@@ -0,0 +1,131 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef INTERLEAVEDDMA_H
+#define INTERLEAVEDDMA_H
+
+#include <Arduino.h>
+#include "SyncDMA.h"
+
+#if ADC_NUM_ADCS>1 && ADC_USE_PDB
+
+/** Class InterleavedDMA samples one pin with both ADCs alternately, at twice the rate of one ADC.
+*   The PDB triggers ADC0 at the start of each period and ADC1 half a period later (see PDBTimebase),
+*   and the DMA channel of each ADC writes every other sample (see SyncDMA), so the buffer is in time order without the CPU:
+*   samples[2*i] is from ADC0 and samples[2*i+1] from ADC1.
+*   The ADCs have slightly different offsets and gains, which show up as spurs at sample_rate/2 and around it.
+*   match() measures the difference with two internal references and sample() and copy() correct the values of ADC1 to match ADC0.
+*/
+class InterleavedDMA : public SyncDMA
+{
+    public:
+
+        //! Constructor, samples has space for num_samples values, an even number up to 2*SYNC_DMA_MAX_FRAMES
+        InterleavedDMA(ADC* adc, volatile uint16_t* samples, uint16_t num_samples);
+
+        //! Start sampling pin at sample_rate Hz, each ADC converts at sample_rate/2
+        /** Both ADCs must be configured before with the same settings (resolution, averages, speed),
+        *   sample_rate/2 must be lower than getMaxSampleRate of both.
+        *   It disables the ADC interrupts, enables DMA and uses the PDB, don't use them or startPDB while it's running.
+        *   \param pin valid in both ADCs.
+        *   \param sample_rate frequency of the samples in Hz.
+        *   \return true if it started, false if the pin is wrong (ADC_ERROR::WRONG_PIN), an ADC is owned (ADC_ERROR::OWNED)
+        *           or sample_rate is too high or 0 (ADC_ERROR::OTHER).
+        */
+        bool start(uint8_t pin, uint32_t sample_rate);
+
+        //! Measure the offset and gain of ADC1 relative to ADC0
+        /** Each ADC converts the temperature sensor (about 0.72 V) and the bandgap (1 V) num_reads times with its current settings,
+        *   so call it after setting both ADCs and when they're calibrated (it waits for the calibration), but not while it's running.
+        *   Both references are well above 0 V, so offsets below 0 counts are measured too. The temperature must be stable meanwhile.
+        *   It enables the bandgap (PMC_REGSC_BGBE), it stays enabled.
+        *   \param num_reads conversions of each reference in each ADC.
+        *   \return false if it's running or a reading failed (see printError); the correction isn't changed then.
+        */
+        bool match(uint16_t num_reads = 64);
+
+        //! Forget the correction, sample() returns the values as converted
+        void resetMatch();
+
+        //! Number of samples written since start, all of them in time order
+        uint32_t sampleCount() {
+            const uint32_t count0 = frameCount(0);
+            const uint32_t count1 = frameCount(1);
+            // ADC0 converts first, so it can be one sample ahead
+            return (count0 > count1) ? 2*count1 + 1 : 2*count0;
+        }
+
+        //! Corrected value of the sample number index (index%size() in the buffer)
+        int32_t sample(uint32_t index) {
+            const uint8_t adc_num = index&1;
+            return correct(p_samples[index%num_samples], adc_num);
+        }
+
+        //! Copy count corrected samples, starting at the sample number first
+        /** \param dst destination, it must hold count values.
+        *   \param first sample number (see sampleCount), the buffer keeps the last size() samples.
+        *   \param count number of samples.
+        */
+        void copy(int32_t* dst, uint32_t first, uint16_t count);
+
+        //! Offset of an ADC relative to ADC0 that match() measured, in counts: its value where ADC0 reads 0
+        int32_t getOffset(uint8_t adc_num) {return offset[adc_num&1];}
+
+        //! Gain of an ADC relative to ADC0, from match()
+        float getGain(uint8_t adc_num) {return gain[adc_num&1]/65536.0f;}
+
+        //! Index of the sample DMA will write next
+        uint32_t position() {return sampleCount()%num_samples;}
+
+        //! Number of samples of the buffer
+        uint32_t size() {return num_samples;}
+
+    protected:
+    private:
+
+        //! Pointer to the samples, the same memory as the frames of SyncDMA
+        volatile uint16_t* const p_samples;
+
+        //! Number of samples
+        const uint16_t num_samples;
+
+        //! Offset and gain (16.16 fixed point) of each ADC relative to ADC0, those of ADC0 are 0 and 1
+        int32_t offset[2];
+        uint32_t gain[2];
+
+        //! Value of ADC adc_num in the scale of ADC0
+        int32_t correct(uint16_t value, uint8_t adc_num) {
+            return (int32_t)(((int64_t)((int32_t)value - offset[adc_num])*gain[adc_num] + 0x8000) >> 16) + offset[0];
+        }
+
+        //! Sum of num_reads conversions of source in ADC adc_num, -1 if one failed
+        int64_t sumReads(uint8_t adc_num, ADC_INTERNAL_SOURCE source, uint16_t num_reads);
+};
+
+#endif // ADC_NUM_ADCS>1 && ADC_USE_PDB
+
+#endif // INTERLEAVEDDMA_H
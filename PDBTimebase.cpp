@@ -0,0 +1,188 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/* PDBTimebase.cpp: The PDB counter, shared by both ADC modules
+ *
+ */
+
+#include "PDBTimebase.h"
+
+#if ADC_USE_PDB
+
+PDBTimebase PDBTimebase::pdb0;
+
+// frequency in Hz
+bool PDBTimebase::start(uint32_t freq) {
+    return start(ADC_Module::solvePDB(freq));
+}
+
+// settings from solvePDB
+bool PDBTimebase::start(const ADC_PDBConfig& a_config) {
+    if(!a_config.valid) {
+        return false;
+    }
+    // the pretriggers of the attached modules must happen inside the new period
+    for(uint8_t i = 0; i < ADC_NUM_ADCS; i++) {
+        if(!(attached & (1 << i))) {
+            continue;
+        }
+        const uint32_t delay0 = i ? PDB0_CH1DLY0 : PDB0_CH0DLY0;
+        const uint32_t delay1 = i ? PDB0_CH1DLY1 : PDB0_CH0DLY1;
+        if((delay0 >= a_config.mod) || (delay1 >= a_config.mod)) {
+            return false;
+        }
+    }
+
+    config = a_config;
+    startCounter();
+    return true;
+}
+
+void PDBTimebase::stop() {
+    for(uint8_t i = 0; i < ADC_NUM_ADCS; i++) {
+        if(attached & (1 << i)) {
+            detach(modules[i]);
+        }
+    }
+
+    running = false;
+    if (!(SIM_SCGC6 & SIM_SCGC6_PDB)) { // if PDB clock wasn't on, return
+        return;
+    }
+    PDB0_SC = 0;
+
+    //NVIC_DISABLE_IRQ(IRQ_PDB);
+}
+
+// pretrigger A of the module's channel, delay counts after the start of the period
+bool PDBTimebase::attach(ADC_Module* adc_module, uint16_t delay) {
+    if(adc_module->owned) { // only readOwned can be used
+        adc_module->fail_flag |= ADC_ERROR::OWNED;
+        return false;
+    }
+    if(running && (delay >= config.mod)) {
+        adc_module->fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    attachPretriggers(adc_module, PDB_CHnC1_TOS_0 | PDB_CHnC1_EN_0, delay, 0);
+    if(running) {
+        PDB0_SC |= PDB_SC_LDOK; // load the delay
+    }
+    return true;
+}
+
+void PDBTimebase::detach(ADC_Module* adc_module) {
+    attached &= ~(1 << adc_module->ADC_num);
+    if (SIM_SCGC6 & SIM_SCGC6_PDB) { // the PDB registers can't be written without its clock
+        adc_module->PDB0_CHnC1 = 0;
+    }
+    adc_module->setSoftwareTrigger();
+}
+
+bool PDBTimebase::isAttached(ADC_Module* adc_module) {
+    return attached & (1 << adc_module->ADC_num);
+}
+
+// fraction of the period in counts
+uint16_t PDBTimebase::delayOfPhase(float phase) {
+    if(phase <= 0) {
+        return 0;
+    }
+    const uint32_t delay = (uint32_t)(phase*config.mod + 0.5f);
+    return (delay >= config.mod) ? config.mod - 1 : delay;
+}
+
+// each count is 2^prescaler*mult bus cycles
+uint32_t PDBTimebase::getDelayNs(uint16_t delay) {
+    return (uint64_t)delay*ADC_Module::pdbDivider(config.prescaler + 8*config.mult)*1000000000/F_BUS;
+}
+
+// attach the module and start the counter, unless the other module uses it at another frequency
+bool PDBTimebase::startModule(ADC_Module* adc_module, const ADC_PDBConfig& a_config, uint32_t chnc1, uint16_t delay0, uint16_t delay1) {
+    if(!a_config.valid) {
+        adc_module->fail_flag |= ADC_ERROR::PDB_FREQ;
+        return false;
+    }
+
+    // attached modules other than this one
+    const uint8_t others = attached & ~(1 << adc_module->ADC_num);
+    const bool same = (a_config.mod == config.mod) && (a_config.prescaler == config.prescaler) && (a_config.mult == config.mult);
+    if(running && others && !same) { // don't change the period of the other ADC
+        adc_module->fail_flag |= ADC_ERROR::PDB_FREQ;
+        return false;
+    }
+
+    attachPretriggers(adc_module, chnc1, delay0, delay1);
+
+    if(running && others) { // keep the phase of the other ADC, only load the delays
+        PDB0_SC |= PDB_SC_LDOK;
+        return true;
+    }
+    config = a_config;
+    startCounter();
+    return true;
+}
+
+void PDBTimebase::attachPretriggers(ADC_Module* adc_module, uint32_t chnc1, uint16_t delay0, uint16_t delay1) {
+    if (!(SIM_SCGC6 & SIM_SCGC6_PDB)) { // setup PDB
+        SIM_SCGC6 |= SIM_SCGC6_PDB; // enable pdb clock
+    }
+
+    if (adc_module->calibrating) adc_module->wait_for_cal();
+    adc_module->setHardwareTrigger(); // trigger ADC with hardware
+
+    adc_module->PDB0_CHnDLY0 = delay0; // loaded with LDOK
+    adc_module->PDB0_CHnDLY1 = delay1;
+    // before the counter starts, so the first period is triggered too
+    adc_module->PDB0_CHnC1 = chnc1;
+
+    modules[adc_module->ADC_num] = adc_module;
+    attached |= 1 << adc_module->ADC_num;
+}
+
+void PDBTimebase::startCounter() {
+    if (!(SIM_SCGC6 & SIM_SCGC6_PDB)) { // setup PDB
+        SIM_SCGC6 |= SIM_SCGC6_PDB; // enable pdb clock
+    }
+
+    //                                   software trigger    enable PDB     PDB interrupt  continuous mode load immediately
+    constexpr uint32_t ADC_PDB_CONFIG = PDB_SC_TRGSEL(15) | PDB_SC_PDBEN | PDB_SC_PDBIE | PDB_SC_CONT |   PDB_SC_LDMOD(0);
+
+    PDB0_IDLY = 1; // the pdb interrupt happens when IDLY is equal to CNT+1
+
+    PDB0_MOD = (uint16_t)(config.mod-1);
+
+    PDB0_SC = ADC_PDB_CONFIG | PDB_SC_PRESCALER(config.prescaler) | PDB_SC_MULT(config.mult) | PDB_SC_LDOK; // load all new values
+
+    PDB0_SC = ADC_PDB_CONFIG | PDB_SC_PRESCALER(config.prescaler) | PDB_SC_MULT(config.mult) | PDB_SC_SWTRIG; // start the counter!
+
+    //NVIC_ENABLE_IRQ(IRQ_PDB);
+
+    running = true;
+}
+
+#endif // ADC_USE_PDB
@@ -0,0 +1,142 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/* PDBTimebase.h: The PDB counter, shared by both ADC modules
+ *
+ */
+
+#ifndef PDBTIMEBASE_H
+#define PDBTIMEBASE_H
+
+#include <Arduino.h>
+#include "ADC_Module.h"
+
+#if ADC_USE_PDB
+
+// bits of PDBx_CHnC1 for pretrigger 0 (SC1A) and 1 (SC1B)
+#define PDB_CHnC1_EN_0  (0x01) // pretrigger enable
+#define PDB_CHnC1_EN_1  (0x02)
+#define PDB_CHnC1_TOS_0 (0x0100) // trigger after the delay
+#define PDB_CHnC1_TOS_1 (0x0200)
+#define PDB_CHnC1_BB_1  (0x020000) // trigger when the conversion of pretrigger 0 is done
+
+
+/** Class PDBTimebase owns the PDB counter, there's only one (PDBTimebase::pdb0, or adc->pdb).
+*   The counter sets the period, and each ADC module attaches its PDB channel to it,
+*   with a pretrigger delay from the start of the period. So both ADCs can sample at the same time (same delay),
+*   or interleaved (ADC1 half a period after ADC0), without one reprogramming the counter of the other.
+*   ADC_Module::startPDB uses it too: it starts the counter if no other ADC is attached,
+*   otherwise it only attaches the module if the frequency is the same, and fails (ADC_ERROR::PDB_FREQ) if it isn't.
+*/
+class PDBTimebase
+{
+    public:
+
+        //! The PDB
+        static PDBTimebase pdb0;
+
+        //! Start the counter at freq Hz, or change the frequency of the attached modules
+        /** \param freq frequency in Hz, see ADC_Module::solvePDB.
+        *   \return false if freq is out of range, or it's too short for the delay of an attached module.
+        */
+        bool start(uint32_t freq);
+
+        //! Start the counter with settings found by ADC_Module::solvePDB
+        /** \param config PDB settings.
+        *   \return false if the config isn't valid, or it's too short for the delay of an attached module.
+        */
+        bool start(const ADC_PDBConfig& config);
+
+        //! Stop the counter and detach all modules
+        void stop();
+
+        //! Trigger the module delay counts after the start of each period
+        /** It sets hardware trigger, the module converts the pin set by startSingleRead or startSingleDifferential before.
+        *   It can be attached before or after start(), and again to change the delay.
+        *   \param adc_module ADC module, it uses its PDB channel (ADC0 channel 0, ADC1 channel 1).
+        *   \param delay counts of the PDB counter, less than getConfig().mod (see delayOfPhase).
+        *   \return false if the delay is too long (ADC_ERROR::OTHER) or the module is owned (ADC_ERROR::OWNED).
+        */
+        bool attach(ADC_Module* adc_module, uint16_t delay = 0);
+
+        //! Stop triggering the module, the counter keeps running
+        /** It sets software trigger again.
+        */
+        void detach(ADC_Module* adc_module);
+
+        //! Is the module attached?
+        bool isAttached(ADC_Module* adc_module);
+
+        //! Is the counter running?
+        bool isRunning() {return running;}
+
+        //! Settings of the counter, from the last start()
+        const ADC_PDBConfig& getConfig() {return config;}
+
+        //! Delay of a fraction of the period
+        /** For example delayOfPhase(0.5) is half a period, to interleave the ADCs.
+        *   \param phase fraction of the period, from 0 to 1.
+        *   \return delay in counts for attach.
+        */
+        uint16_t delayOfPhase(float phase);
+
+        //! Time of a delay in ns, with the current settings
+        uint32_t getDelayNs(uint16_t delay);
+
+    protected:
+    private:
+
+        friend class ADC_Module;
+
+        //! Only pdb0
+        constexpr PDBTimebase() : config{0, 0, 0, 0, 0, false}, running(false), attached(0), modules{} {}
+
+        //! Used by ADC_Module::startPDB and startPDBDual: attach the pretriggers chnc1 of the module,
+        //! and start the counter unless it's running for the other module at another frequency (ADC_ERROR::PDB_FREQ).
+        bool startModule(ADC_Module* adc_module, const ADC_PDBConfig& a_config, uint32_t chnc1, uint16_t delay0, uint16_t delay1);
+
+        //! Write the pretriggers and delays of the module and set hardware trigger
+        void attachPretriggers(ADC_Module* adc_module, uint32_t chnc1, uint16_t delay0, uint16_t delay1);
+
+        //! Program the counter and start it
+        void startCounter();
+
+        //! Settings of the counter
+        ADC_PDBConfig config;
+
+        //! Is the counter running?
+        bool running;
+
+        //! Attached modules, bit n is ADCn
+        uint8_t attached;
+
+        //! The modules, set when they're attached
+        ADC_Module* modules[ADC_NUM_ADCS];
+};
+
+#endif // ADC_USE_PDB
+
+#endif // PDBTIMEBASE_H
@@ -26,49 +26,493 @@
 #ifndef RINGBUFFER_H
 #define RINGBUFFER_H
 
-// include new and delete
-//#include <Arduino.h>
+#include <stdint.h>
+
+#if !defined(__arm__)
+#include <atomic> // only the host build uses std::atomic, see ADC_Buffer::AtomicIndex
+#endif
 
 // THE SIZE MUST BE A POWER OF 2!!
 #define RING_BUFFER_DEFAULT_BUFFER_SIZE 8
 
 
+//! Buffers to store the ADC conversions
+namespace ADC_Buffer {
 
-/** Class RingBuffer implements a circular buffer of fixed size (must be power of 2)
-*   Code adapted from http://en.wikipedia.org/wiki/Circular_buffer#Mirroring
-*/
-class RingBuffer
-{
-    public:
-        //! Default constructor, buffer has a size DEFAULT_BUFFER_SIZE
-        RingBuffer();
+    //! Contiguous part of a buffer: length elements starting at data
+    template<typename T>
+    struct Span {
+        T* data;
+        uint32_t length;
+    };
+
+    //! The readable region of a circular buffer is at most two contiguous parts: first and then second
+    /** second.length is 0 if the region doesn't wrap around the end of the buffer.
+    */
+    template<typename T>
+    struct Spans {
+        Span<T> first;
+        Span<T> second;
+
+        //! Total number of elements
+        uint32_t length() const {
+            return first.length + second.length;
+        }
+    };
+
+    //! Copy n elements, the compiler turns this loop into a memcpy or an unrolled copy
+    template<typename T, typename U>
+    inline void copyElements(T* dst, U* src, uint32_t n) {
+        for(uint32_t i=0; i<n; i++) {
+            dst[i] = src[i];
+        }
+    }
+
+    //! Spans covering count elements starting at position pos of a buffer of length size
+    template<typename T>
+    inline Spans<T> makeSpans(T* elems, uint32_t size, uint32_t pos, uint32_t count) {
+        const uint32_t first = (count < size-pos) ? count : size-pos;
+        Spans<T> spans = {{elems+pos, first}, {elems, count-first}};
+        return spans;
+    }
+
+    /** Class RingBuffer implements a circular buffer of N elements of type T (N must be power of 2)
+    *   The size is known at compile time, so all masks are constants and there's no vtable.
+    *   Use T=uint16_t for single-ended or T=int16_t for differential conversions to halve the RAM used.
+    *   Code adapted from http://en.wikipedia.org/wiki/Circular_buffer#Mirroring
+    */
+    template<typename T, uint32_t N>
+    class RingBuffer
+    {
+        static_assert((N > 0) && ((N & (N-1)) == 0), "RingBuffer: the size must be a power of 2");
+
+        public:
+
+            //! Returns true if the buffer is full
+            bool isFull() const {
+                return (b_end == (b_start ^ N));
+            }
+
+            //! Returns true if the buffer is empty
+            bool isEmpty() const {
+                return (b_end == b_start);
+            }
+
+            //! Write a value into the buffer, if it's full the oldest value is overwritten
+            void write(T value) {
+                elems[b_end&mask] = value;
+                if (isFull()) { /* full, overwrite moves start pointer */
+                    b_start = increase(b_start);
+                }
+                b_end = increase(b_end);
+            }
+
+            //! Read a value from the buffer, make sure it's not empty by calling isEmpty() first
+            T read() {
+                T result = elems[b_start&mask];
+                b_start = increase(b_start);
+                return result;
+            }
+
+            //! Number of values that can be read
+            uint32_t available() const {
+                return (b_end - b_start)&mirror_mask;
+            }
+
+            //! Write n values into the buffer, if it gets full the oldest values are overwritten
+            /** If n>N only the last N values are kept.
+            */
+            void writeBulk(const T* src, uint32_t n) {
+                if(n > N) {
+                    src += n - N;
+                    n = N;
+                }
+                const bool overwrite = (available() + n) > N;
+                Spans<T> spans = makeSpans(elems, N, b_end&mask, n);
+                copyElements(spans.first.data, src, spans.first.length);
+                copyElements(spans.second.data, src + spans.first.length, spans.second.length);
+                b_end = (b_end + n)&mirror_mask;
+                if(overwrite) { // full, overwrite moves start pointer
+                    b_start = b_end ^ N;
+                }
+            }
+
+            //! Read up to n values into dst
+            /** \return the number of values read, less than n if there weren't enough.
+            */
+            uint32_t readBulk(T* dst, uint32_t n) {
+                const Spans<const T> spans = peekContiguous();
+                if(n > spans.length()) {
+                    n = spans.length();
+                }
+                const uint32_t first = (n < spans.first.length) ? n : spans.first.length;
+                copyElements(dst, spans.first.data, first);
+                copyElements(dst + first, spans.second.data, n - first);
+                consume(n);
+                return n;
+            }
+
+            //! Get the values that can be read, without removing them from the buffer
+            /** Process them in place (or memcpy them) and then call consume().
+            */
+            Spans<const T> peekContiguous() const {
+                return makeSpans<const T>(elems, N, b_start&mask, available());
+            }
+
+            //! Remove the first n values from the buffer (or all values if there are less than n)
+            void consume(uint32_t n) {
+                const uint32_t count = available();
+                b_start = (b_start + ((n < count) ? n : count))&mirror_mask;
+            }
+
+            //! Length of the buffer
+            static constexpr uint32_t size() {
+                return N;
+            }
+
+        protected:
+        private:
+
+            //! Mask to get the position in elems from a pointer
+            static constexpr uint32_t mask = N-1;
+            //! Mask for the pointers, they run from 0 to 2*N-1
+            static constexpr uint32_t mirror_mask = 2*N-1;
+
+            //! Increases the pointer modulo 2*N-1
+            static uint32_t increase(uint32_t p) {
+                return (p + 1)&mirror_mask;
+            }
+
+            uint32_t b_start = 0;
+            uint32_t b_end = 0;
+            T elems[N];
+    };
+
+
+    /** Class AtomicIndex is an index shared between one writer and one reader.
+    *   The writer publishes it with storeRelease() after writing the data it refers to,
+    *   the reader loads it with loadAcquire() before reading that data.
+    *   On Cortex-M aligned 32 bit loads and stores are atomic, so only a memory barrier (dmb) is needed;
+    *   elsewhere (for example when testing in a PC) it uses std::atomic.
+    */
+    class AtomicIndex
+    {
+        public:
+
+            //! Load the value, only valid for the owner of the index
+            uint32_t loadRelaxed() const {
+                #if defined(__arm__)
+                return value;
+                #else
+                return value.load(std::memory_order_relaxed);
+                #endif
+            }
+
+            //! Load the value written by the other side, later reads can't be moved before it
+            uint32_t loadAcquire() const {
+                #if defined(__arm__)
+                const uint32_t v = value;
+                __asm__ volatile("dmb" ::: "memory");
+                return v;
+                #else
+                return value.load(std::memory_order_acquire);
+                #endif
+            }
+
+            //! Publish a new value, previous writes can't be moved after it
+            void storeRelease(uint32_t v) {
+                #if defined(__arm__)
+                __asm__ volatile("dmb" ::: "memory");
+                value = v;
+                #else
+                value.store(v, std::memory_order_release);
+                #endif
+            }
+
+        private:
+            #if defined(__arm__)
+            volatile uint32_t value = 0;
+            #else
+            std::atomic<uint32_t> value{0};
+            #endif
+    };
+
+
+    /** Class RingBufferSPSC implements a lock-free circular buffer of N elements of type T (N must be power of 2)
+    *   for a single producer and a single consumer, for example adc0_isr writing and loop() reading.
+    *   The producer owns the end pointer and the consumer the start pointer, so neither writes the other's.
+    *   When the buffer is full new values are dropped and counted in getOverflows(),
+    *   instead of moving the start pointer like RingBuffer does.
+    *   The pointers are free-running 32 bit counters, the position in the buffer is pointer&(N-1).
+    */
+    template<typename T, uint32_t N>
+    class RingBufferSPSC
+    {
+        static_assert((N > 0) && ((N & (N-1)) == 0), "RingBufferSPSC: the size must be a power of 2");
+
+        public:
 
-        /** Default destructor */
-        virtual ~RingBuffer();
+            ////// PRODUCER //////
 
-        //! Returns 1 (true) if the buffer is full
-        int isFull();
+            //! Write a value into the buffer
+            /** Call it only from the producer.
+            *   \return true if the value was stored, false if the buffer was full and the value was dropped.
+            */
+            bool write(T value) {
+                const uint32_t end = b_end.loadRelaxed();
+                if( (end - b_start.loadAcquire()) >= N ) { // full
+                    overflows.storeRelease(overflows.loadRelaxed() + 1);
+                    return false;
+                }
+                elems[end&mask] = value;
+                b_end.storeRelease(end + 1); // publish the value
+                return true;
+            }
 
-        //! Returns 1 (true) if the buffer is empty
-        int isEmpty();
+            //! Write up to n values into the buffer
+            /** Call it only from the producer. The values that don't fit are dropped and counted in getOverflows().
+            *   \return the number of values stored.
+            */
+            uint32_t writeBulk(const T* src, uint32_t n) {
+                const uint32_t end = b_end.loadRelaxed();
+                const uint32_t free = N - (end - b_start.loadAcquire());
+                if(n > free) {
+                    overflows.storeRelease(overflows.loadRelaxed() + (n - free));
+                    n = free;
+                }
+                Spans<T> spans = makeSpans(elems, N, end&mask, n);
+                copyElements(spans.first.data, src, spans.first.length);
+                copyElements(spans.second.data, src + spans.first.length, spans.second.length);
+                b_end.storeRelease(end + n); // publish the values
+                return n;
+            }
 
-        //! Write a value into the buffer
-        void write(int value);
+            ////// CONSUMER //////
 
-        //! Read a value from the buffer
-        int read();
+            //! Read a value from the buffer
+            /** Call it only from the consumer.
+            *   \param value is set to the oldest value in the buffer.
+            *   \return true if there was a value, false if the buffer was empty.
+            */
+            bool read(T& value) {
+                const uint32_t start = b_start.loadRelaxed();
+                if( b_end.loadAcquire() == start ) { // empty
+                    return false;
+                }
+                value = elems[start&mask];
+                b_start.storeRelease(start + 1); // free the slot
+                return true;
+            }
 
-    protected:
-    private:
+            //! Read a value from the buffer, make sure it's not empty by calling isEmpty() first
+            T read() {
+                T value = T();
+                read(value);
+                return value;
+            }
 
-        int increase(int p);
+            //! Read up to n values into dst
+            /** Call it only from the consumer.
+            *   \return the number of values read, less than n if there weren't enough.
+            */
+            uint32_t readBulk(T* dst, uint32_t n) {
+                const Spans<const T> spans = peekContiguous();
+                if(n > spans.length()) {
+                    n = spans.length();
+                }
+                const uint32_t first = (n < spans.first.length) ? n : spans.first.length;
+                copyElements(dst, spans.first.data, first);
+                copyElements(dst + first, spans.second.data, n - first);
+                consume(n);
+                return n;
+            }
 
-        int b_size = RING_BUFFER_DEFAULT_BUFFER_SIZE;
-        int b_start = 0;
-        int b_end = 0;
-        //int *elems;
-        int elems[RING_BUFFER_DEFAULT_BUFFER_SIZE];
-};
+            //! Get the values that can be read, without removing them from the buffer
+            /** Call it only from the consumer. Process the values in place and then call consume().
+            *   The producer doesn't touch them until they are consumed.
+            */
+            Spans<const T> peekContiguous() const {
+                const uint32_t start = b_start.loadRelaxed();
+                return makeSpans<const T>(elems, N, start&mask, b_end.loadAcquire() - start);
+            }
+
+            //! Remove the first n values from the buffer (or all values if there are less than n)
+            /** Call it only from the consumer.
+            */
+            void consume(uint32_t n) {
+                const uint32_t start = b_start.loadRelaxed();
+                const uint32_t count = b_end.loadAcquire() - start;
+                b_start.storeRelease(start + ((n < count) ? n : count));
+            }
+
+            ////// BOTH //////
+
+            //! Number of values that can be read
+            /** The producer may have added more (or the consumer removed some) by the time this returns.
+            */
+            uint32_t available() const {
+                return b_end.loadAcquire() - b_start.loadAcquire();
+            }
+
+            //! Returns true if the buffer is full
+            bool isFull() const {
+                return available() >= N;
+            }
+
+            //! Returns true if the buffer is empty
+            bool isEmpty() const {
+                return available() == 0;
+            }
+
+            //! Number of values dropped because the buffer was full
+            /** It only increases (modulo 2^32), compare it with a previous value to know if there were new overflows.
+            */
+            uint32_t getOverflows() const {
+                return overflows.loadAcquire();
+            }
+
+            //! Length of the buffer
+            static constexpr uint32_t size() {
+                return N;
+            }
+
+        protected:
+        private:
+
+            //! Mask to get the position in elems from a pointer
+            static constexpr uint32_t mask = N-1;
+
+            //! Start pointer: read here. Written only by the consumer.
+            AtomicIndex b_start;
+            //! End pointer: write here. Written only by the producer.
+            AtomicIndex b_end;
+            //! Number of values dropped. Written only by the producer.
+            AtomicIndex overflows;
+
+            T elems[N];
+    };
+
+
+    //! A value with the time it was taken and its position in the stream
+    /** Use it as the type of a RingBuffer or RingBufferSPSC to keep the time information of each conversion,
+    *   for example RingBufferSPSC<Stamped<uint16_t>, 1024>, and check the stream with a GapDetector.
+    */
+    template<typename T>
+    struct Stamped {
+        //! The conversion
+        T value;
+        //! When it was taken, for example ARM_DWT_CYCCNT
+        uint32_t timestamp;
+        //! Counts the values of the stream, the producer increases it for each value even if the buffer drops it
+        uint32_t sequence;
+    };
+
+
+    /** Class GapDetector finds the samples missing from a stream of timestamped samples or blocks of samples.
+    *   Dropped samples were taken but lost before the consumer got them, for example because the buffer was full:
+    *   they leave a hole in the sequence numbers.
+    *   Skipped samples were never taken or never stored, for example because the compare function (ACFE) rejected them:
+    *   the sequence numbers are consecutive, but the timestamps are further apart than the sample rate says.
+    *   Skipped samples are only found after calling setRate().
+    */
+    class GapDetector
+    {
+        public:
+
+            //! Set the sample rate and the frequency of the timestamps (for example F_CPU for ARM_DWT_CYCCNT), both in Hz
+            void setRate(uint32_t sample_rate, uint32_t timestamp_freq) {
+                rate = sample_rate;
+                ticks_freq = timestamp_freq;
+            }
+
+            //! Check the next samples of the stream
+            /** \param first sequence number of the first sample.
+            *   \param count number of samples, consecutive in the sequence.
+            *   \param timestamp time of sample stamp_index.
+            *   \param stamp_index sequence number of the sample taken at time timestamp,
+            *          it may be after the last one if the time is taken later (for example in the dma isr).
+            *   \return the number of samples missing (dropped or skipped) since the previous call, 0 the first time.
+            */
+            uint32_t check(uint32_t first, uint32_t count, uint32_t timestamp, uint32_t stamp_index) {
+                uint32_t dropped_now = 0, skipped_now = 0;
+                if(started) {
+                    if((int32_t)(first - next_sequence) > 0) {
+                        dropped_now = first - next_sequence;
+                    }
+                    if(rate && ticks_freq) {
+                        // samples that fit in the time elapsed, rounded to the closest one to allow for jitter in the timestamps
+                        const uint32_t periods = ((uint64_t)(timestamp - last_timestamp)*rate + ticks_freq/2)/ticks_freq;
+                        const uint32_t stored = stamp_index - last_stamp_index;
+                        if(periods > stored) {
+                            skipped_now = periods - stored;
+                        }
+                    }
+                }
+                started = true;
+                next_sequence = first + count;
+                last_timestamp = timestamp;
+                last_stamp_index = stamp_index;
+                dropped += dropped_now;
+                skipped += skipped_now;
+                if(dropped_now || skipped_now) {
+                    gaps++;
+                }
+                return dropped_now + skipped_now;
+            }
+
+            //! Check the next value of the stream, see check(first, count, timestamp, stamp_index)
+            template<typename T>
+            uint32_t check(const Stamped<T>& sample) {
+                return check(sample.sequence, 1, sample.timestamp, sample.sequence);
+            }
+
+            //! Number of samples dropped since the last reset()
+            uint32_t getDropped() const {
+                return dropped;
+            }
+
+            //! Number of samples skipped since the last reset()
+            uint32_t getSkipped() const {
+                return skipped;
+            }
+
+            //! Number of gaps (calls to check() that found missing samples) since the last reset()
+            uint32_t getGaps() const {
+                return gaps;
+            }
+
+            //! Forget the stream, the next check() starts it again. The rate is kept.
+            void reset() {
+                started = false;
+                dropped = 0;
+                skipped = 0;
+                gaps = 0;
+            }
+
+        protected:
+        private:
+
+            uint32_t rate = 0;
+            uint32_t ticks_freq = 0;
+
+            bool started = false;
+            //! Sequence number expected for the next sample
+            uint32_t next_sequence = 0;
+            uint32_t last_timestamp = 0;
+            uint32_t last_stamp_index = 0;
+
+            uint32_t dropped = 0;
+            uint32_t skipped = 0;
+            uint32_t gaps = 0;
+    };
+
+}
+
+
+//! The original RingBuffer: RING_BUFFER_DEFAULT_BUFFER_SIZE ints.
+/** Use ADC_Buffer::RingBuffer<T, N> to choose the type and size.
+*/
+typedef ADC_Buffer::RingBuffer<int, RING_BUFFER_DEFAULT_BUFFER_SIZE> RingBuffer;
 
 
 #endif // RINGBUFFER_H
@@ -24,6 +24,7 @@
  */
 
 #include "RingBufferDMA.h"
+#include "atomic.h"
 
 // Constructor
 RingBufferDMA::RingBufferDMA(volatile int16_t* elems, uint32_t len, uint8_t ADC_num) :
@@ -36,6 +37,9 @@ RingBufferDMA::RingBufferDMA(volatile int16_t* elems, uint32_t len, uint8_t ADC_
     b_start = 0;
     b_end = 0;
 
+    block_sequence = 0;
+    sample_count = 0;
+
 
     dmaChannel = new DMAChannel(); // reserve a DMA channel
 
@@ -58,7 +62,12 @@ void RingBufferDMA::start(void (*call_dma_isr)(void)) {
 
     dmaChannel->transferCount(b_size); // transfer b_size values
 
-    dmaChannel->interruptAtCompletion(); //interruptAtHalf or interruptAtCompletion
+    // interrupt at the half too, so that the buffer pointers are updated at least twice per buffer
+    // in ping-pong mode each interrupt means a half is ready
+    dmaChannel->interruptAtCompletion();
+    #if defined(KINETISK)
+    dmaChannel->interruptAtHalf();
+    #endif // the DMA of Teensy LC doesn't interrupt at the half
 
 
 	uint8_t DMAMUX_SOURCE_ADC = DMAMUX_SOURCE_ADC0;
@@ -77,6 +86,55 @@ void RingBufferDMA::start(void (*call_dma_isr)(void)) {
     //digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
 }
 
+bool RingBufferDMA::startPingPong(void (*call_dma_isr)(void)) {
+    #if defined(KINETISK)
+    // two halves, and the pointers are masked with b_size-1
+    if( (b_size < 2) || (b_size & (b_size-1)) ) {
+        return false;
+    }
+
+    block_sequence = 0;
+    sample_count = 0;
+
+    // enable the cycle counter for the timestamps
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
+    start(call_dma_isr);
+    return true;
+    #else
+    // without the half interrupt there's no way to know when a half is ready
+    return false;
+    #endif
+}
+
+RingBufferDMA::Block RingBufferDMA::finishedBlock() {
+    const uint16_t half = b_size/2;
+
+    #if defined(KINETISK)
+    const uint32_t timestamp = ARM_DWT_CYCCNT;
+    #else // no DWT on Cortex-M0+
+    const uint32_t timestamp = micros();
+    #endif
+    update();
+
+    // DMA is writing the other half now (it may have already written a few values),
+    // so if it's in the second half the first one is finished and vice versa.
+    const uint16_t position = b_end&(b_size-1);
+
+    Block block;
+    block.data = (position < half) ? p_elems + half : p_elems;
+    block.length = half;
+    block.sequence = block_sequence++;
+    block.first = sample_count - position%half - half;
+    block.timestamp = timestamp;
+    block.stamp_index = sample_count;
+
+    dmaChannel->clearInterrupt();
+
+    return block;
+}
+
 
 RingBufferDMA::~RingBufferDMA() {
 
@@ -87,17 +145,19 @@ RingBufferDMA::~RingBufferDMA() {
 
 
 bool RingBufferDMA::isFull() {
-    //b_end = uint32_t(dmaChannel->destinationAddress()) - uint32_t(p_elems);
-    //b_end /= 2; // convert from uint16_t to positions
-
-    return (b_end == (b_start ^ b_size));
+    const uint32_t primask = atomic::disableInterrupts();
+    update();
+    bool full = (b_end == (b_start ^ b_size));
+    atomic::restoreInterrupts(primask);
+    return full;
 }
 
 bool RingBufferDMA::isEmpty() {
-    //b_end = uint32_t(dmaChannel->destinationAddress()) - uint32_t(p_elems);
-    //b_end /= 2; // convert from uint16_t to positions
-
-    return (b_end == b_start);
+    const uint32_t primask = atomic::disableInterrupts();
+    update();
+    bool empty = (b_end == b_start);
+    atomic::restoreInterrupts(primask);
+    return empty;
 }
 
 // update internal pointers
@@ -105,21 +165,34 @@ bool RingBufferDMA::isEmpty() {
 void RingBufferDMA::write() {
     // using DMA:
     // call this inside the dma_isr to update the b_start and/or b_end pointers
-    if (isFull()) { /* full, overwrite moves start pointer */
-        b_start = increase(b_start);
-    }
-    b_end = increase(b_end);
+    // it's called at the half and at the end of the buffer, so update() never misses a whole buffer
+    update();
 
     dmaChannel->clearInterrupt();
+}
+
+// bring b_end up to date with the position DMA will write next
+// call it with interrupts disabled or from the dma isr
+void RingBufferDMA::update() {
+    const uint16_t position = (uint32_t(dmaChannel->destinationAddress()) - uint32_t(p_elems))/2;
 
-//    b_start = increase(b_start);
-//    b_end = uint32_t(dmaChannel->destinationAddress()) - uint32_t(p_elems);
-//    b_end /= 2; // convert from uint16_t to positions
+    // values written since the last update, less than b_size because the dma isr updates every half buffer
+    const uint16_t written = (position - b_end)&(b_size-1);
+    const uint16_t count = ((b_end - b_start)&(2*b_size-1)) + written;
+
+    b_end = (b_end + written)&(2*b_size-1);
+    sample_count += written;
+    if (count > b_size) { /* full, overwrite moves start pointer */
+        b_start = (b_end - b_size)&(2*b_size-1);
+    }
 }
 
 int16_t RingBufferDMA::read() {
 
-    if(isEmpty()) {
+    const uint32_t primask = atomic::disableInterrupts();
+    update();
+    if(b_end == b_start) { // empty
+        atomic::restoreInterrupts(primask);
         return 0;
     }
 
@@ -127,9 +200,47 @@ int16_t RingBufferDMA::read() {
     // read last value and update b_start
     int result = p_elems[b_start&(b_size-1)];
     b_start = increase(b_start);
+    atomic::restoreInterrupts(primask);
     return result;
 }
 
+uint32_t RingBufferDMA::available() {
+    const uint32_t primask = atomic::disableInterrupts();
+    update();
+    uint32_t count = (b_end - b_start)&(2*b_size-1);
+    atomic::restoreInterrupts(primask);
+    return count;
+}
+
+uint32_t RingBufferDMA::readBulk(int16_t* dst, uint32_t n) {
+    const ADC_Buffer::Spans<const volatile int16_t> spans = peekContiguous();
+    if(n > spans.length()) {
+        n = spans.length();
+    }
+    const uint32_t first = (n < spans.first.length) ? n : spans.first.length;
+    ADC_Buffer::copyElements(dst, spans.first.data, first);
+    ADC_Buffer::copyElements(dst + first, spans.second.data, n - first);
+    consume(n);
+    return n;
+}
+
+ADC_Buffer::Spans<const volatile int16_t> RingBufferDMA::peekContiguous() {
+    const uint32_t primask = atomic::disableInterrupts();
+    update();
+    ADC_Buffer::Spans<const volatile int16_t> spans =
+            ADC_Buffer::makeSpans<const volatile int16_t>(p_elems, b_size, b_start&(b_size-1), (b_end - b_start)&(2*b_size-1));
+    atomic::restoreInterrupts(primask);
+    return spans;
+}
+
+void RingBufferDMA::consume(uint32_t n) {
+    const uint32_t primask = atomic::disableInterrupts();
+    update();
+    const uint32_t count = (b_end - b_start)&(2*b_size-1);
+    b_start = (b_start + ((n < count) ? n : count))&(2*b_size-1);
+    atomic::restoreInterrupts(primask);
+}
+
 // increases the pointer modulo 2*size-1
 uint16_t RingBufferDMA::increase(uint16_t p) {
     return (p + 1)&(2*b_size-1);
@@ -28,13 +28,40 @@
 
 #include <Arduino.h> // for digitalWrite
 #include "DMAChannel.h"
+#include "RingBuffer.h" // for ADC_Buffer::Spans
 
 
 /** Class RingBufferDMA implements a DMA ping-pong buffer of fixed size
+*   The number of values available is computed from the current DMA destination address,
+*   so values can be read as soon as DMA stores them, without waiting for the dma isr.
+*   Started with start() the dma isr is called every half buffer and must call write().
+*   Started with startPingPong() the dma isr is called each time one half of the buffer is filled,
+*   get it with finishedBlock() and process it while DMA writes the other half.
 */
 class RingBufferDMA
 {
     public:
+
+        //! Half of the buffer that DMA finished writing, see startPingPong().
+        struct Block {
+            //! First value, don't write to it
+            const volatile int16_t* data;
+            //! Number of values, half the size of the buffer
+            uint16_t length;
+            //! Counts the blocks since startPingPong(), starting at 0. Even blocks are the first half of the buffer and odd ones the second, unless the isr was too late.
+            uint32_t sequence;
+            //! Position of data[0] in the stream of samples since startPingPong()
+            /** If the isr was late by less than a whole buffer the samples it missed are counted, so first jumps ahead.
+            *   Whole buffers missed can't be seen from the DMA address and aren't counted:
+            *   GapDetector::check finds them from the timestamps as skipped samples if it knows the rate.
+            */
+            uint32_t first;
+            //! ARM_DWT_CYCCNT when the block was finished (micros() in Teensy LC)
+            uint32_t timestamp;
+            //! Position in the stream of the sample DMA was about to store at timestamp, at least first+length
+            uint32_t stamp_index;
+        };
+
         //! Constructor, buffer has a size len and stores the conversions of ADC number ADC_num
         RingBufferDMA(volatile int16_t* elems, uint32_t len, uint8_t ADC_num = 0);
 
@@ -50,11 +77,45 @@ class RingBufferDMA
         //! Read a value from the buffer, make sure it's not emtpy by calling isEmpty() first
         int16_t read();
 
+        //! Number of values that can be read
+        uint32_t available();
+
+        //! Read up to n values into dst
+        /** \return the number of values read, less than n if there weren't enough.
+        */
+        uint32_t readBulk(int16_t* dst, uint32_t n);
+
+        //! Get the values that can be read, without removing them from the buffer
+        /** Process them in place and then call consume().
+        */
+        ADC_Buffer::Spans<const volatile int16_t> peekContiguous();
+
+        //! Remove the first n values from the buffer (or all values if there are less than n)
+        void consume(uint32_t n);
+
         //! Start DMA operation
+        /** In Teensy LC call_dma_isr is only called at the end of the buffer (its DMA doesn't interrupt at the half),
+        *   so read the values before DMA writes the whole buffer again.
+        */
         void start(void (*call_dma_isr)(void));
 
-        //! Write a value into the buffer
-        /** The actual value is copied by DMA, this function only updates the buffer pointers to reflect that fact.
+        //! Start DMA operation in ping-pong mode
+        /** call_dma_isr is called every time DMA fills half of the buffer, call finishedBlock() inside it.
+        *   It also enables the cycle counter for the timestamps of the blocks.
+        *   Not available in Teensy LC, its DMA doesn't interrupt at the half of the buffer.
+        *   \return false if the size of the buffer isn't a power of two (at least 2) or in Teensy LC, DMA isn't started then.
+        */
+        bool startPingPong(void (*call_dma_isr)(void));
+
+        //! Get the half of the buffer that DMA just filled and clear the interrupt
+        /** Call it only inside the dma isr in ping-pong mode.
+        *   The data is valid until DMA finishes the other half, that is, half a buffer of conversions later.
+        *   Pass first, length, timestamp and stamp_index to ADC_Buffer::GapDetector::check to find missing samples.
+        */
+        Block finishedBlock();
+
+        //! Update the buffer pointers, call it inside the dma isr
+        /** The actual values are copied by DMA, this function only updates the buffer pointers to reflect that fact.
         */
         void write();
 
@@ -95,6 +156,15 @@ class RingBufferDMA
         //! Increases the pointer modulo 2*size-1
         uint16_t increase(uint16_t p);
 
+        //! Update b_end (and b_start if DMA overwrote old values) from the DMA destination address
+        void update();
+
+        //! Number of blocks finished in ping-pong mode
+        uint32_t block_sequence;
+
+        //! Number of values written by DMA since startPingPong(), updated by update()
+        uint32_t sample_count;
+
         volatile uint32_t* const ADC_RA;
 
 
@@ -0,0 +1,131 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ScanDMA.h"
+
+// Constructor
+ScanDMA::ScanDMA(ADC_Module* a_adc, volatile uint16_t* results, uint16_t frames) :
+        adc(a_adc)
+        , p_results(results)
+        , num_frames(frames)
+        , ADC_RA(&ADC0_RA + (uint32_t)0x20000*a_adc->ADC_num)
+        , ADC_SC1A(&ADC0_SC1A + (uint32_t)0x20000*a_adc->ADC_num)
+        {
+
+    num_values = 0;
+    running = false;
+
+    resultChannel = new DMAChannel(); // reserve the DMA channels
+    sc1aChannel = new DMAChannel();
+}
+
+ScanDMA::~ScanDMA() {
+    stop();
+    delete sc1aChannel;
+    delete resultChannel;
+}
+
+bool ScanDMA::start(const uint8_t* pins, uint8_t num_pins) {
+
+    if( (num_pins==0) || (num_pins>ADC_MAX_SCAN_PINS) || ((uint32_t)num_pins*num_frames>SCAN_DMA_MAX_VALUES) ) {
+        adc->fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    // check all pins, and that they use the same mux
+    for(uint8_t i=0; i<num_pins; i++) {
+        if( !adc->checkPin(pins[i])
+            || ((adc->getSC1A(pins[i])&ADC_SC1A_PIN_MUX) != (adc->getSC1A(pins[0])&ADC_SC1A_PIN_MUX)) ) {
+            adc->fail_flag |= ADC_ERROR::WRONG_PIN;
+            return false;
+        }
+    }
+
+    stop(); // in case it was running
+
+    // the first conversion is started here, so the table is rotated by one:
+    // when the result of pins[i] is copied, the conversion of pins[i+1] starts
+    for(uint8_t i=0; i<num_pins; i++) {
+        sc1a_table[i] = adc->getSC1A(pins[(i+1)%num_pins])&ADC_SC1A_CHANNELS; // no interrupts
+    }
+    num_values = num_pins*num_frames;
+
+    // each ADC conversion triggers resultChannel, which copies ADC_RA into the results buffer
+    // the buffer starts again at the beginning when it's full
+    resultChannel->source(*ADC_RA);
+    resultChannel->destinationBuffer(p_results, 2*num_values);
+    resultChannel->transferSize(2);
+    resultChannel->transferCount(num_values);
+
+    // after each transfer of resultChannel (and its completion) sc1aChannel writes the next SC1A number
+    sc1aChannel->sourceBuffer(sc1a_table, 4*num_pins);
+    sc1aChannel->destination(*ADC_SC1A);
+    sc1aChannel->transferSize(4);
+    sc1aChannel->transferCount(num_pins);
+    sc1aChannel->triggerAtTransfersOf(*resultChannel); // after transferCount, it overwrites the link
+    sc1aChannel->triggerAtCompletionOf(*resultChannel);
+
+    uint8_t DMAMUX_SOURCE_ADC = DMAMUX_SOURCE_ADC0;
+    #if ADC_NUM_ADCS>=2
+    if(adc->ADC_num==1){
+        DMAMUX_SOURCE_ADC = DMAMUX_SOURCE_ADC1;
+    }
+    #endif // ADC_NUM_ADCS
+    resultChannel->triggerAtHardwareEvent(DMAMUX_SOURCE_ADC); // start DMA channel when ADC finishes a conversion
+
+    sc1aChannel->enable();
+    resultChannel->enable();
+
+    // set up the ADC and start the first conversion (this also sets the mux)
+    adc->wait_for_cal();
+    adc->disableInterrupts();
+    adc->singleMode();
+    adc->enableDMA();
+    adc->num_measurements++;
+    adc->startReadFast(pins[0]);
+
+    running = true;
+    return true;
+}
+
+void ScanDMA::stop() {
+    if(!running) {
+        return;
+    }
+
+    resultChannel->disable();
+    sc1aChannel->disable();
+
+    // set channel select to all 1's (31) to stop it.
+    *ADC_SC1A = ADC_SC1A_PIN_INVALID;
+    adc->disableDMA();
+    adc->num_measurements--;
+
+    running = false;
+}
+
+uint32_t ScanDMA::position() {
+    return (uint32_t(resultChannel->destinationAddress()) - uint32_t(p_results))/2;
+}
@@ -0,0 +1,109 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SCANDMA_H
+#define SCANDMA_H
+
+#include <Arduino.h>
+#include "DMAChannel.h"
+#include "ADC_Module.h"
+
+// max number of values in the results buffer of ScanDMA
+// with channel linking the major loop count has only 9 bits
+#define SCAN_DMA_MAX_VALUES (511)
+
+
+/** Class ScanDMA converts a list of pins round-robin, continuously and without any isr.
+*   It uses two DMA channels: resultChannel copies each conversion from ADC_RA to the results buffer
+*   and then triggers sc1aChannel, which writes the SC1A number of the next pin from a table to ADC_SC1A,
+*   starting the next conversion.
+*   The results buffer holds frames of all pins: results[frame*num_pins + i] is the value of pins[i],
+*   when it's full DMA starts again at the beginning.
+*   DMA can't change the mux, so all pins must use the same mux (A or B) of the ADC.
+*/
+class ScanDMA
+{
+    public:
+        //! Constructor, results has space for frames*num_pins values of the ADC module adc
+        ScanDMA(ADC_Module* adc, volatile uint16_t* results, uint16_t frames);
+
+        //! Destructor
+        ~ScanDMA();
+
+        //! Start converting the pins round-robin
+        /** The ADC must be configured before (resolution, averages, speed).
+        *   It disables the ADC interrupts and enables DMA.
+        *   \param pins single-ended pins to convert, all valid in this ADC and using the same mux.
+        *   \param num_pins number of pins, up to ADC_MAX_SCAN_PINS, and num_pins*frames up to SCAN_DMA_MAX_VALUES.
+        *   \return true if the pins are valid, false otherwise.
+        */
+        bool start(const uint8_t* pins, uint8_t num_pins);
+
+        //! Stop the conversions and the DMA channels
+        void stop();
+
+        //! Index of the results buffer that DMA will write next
+        uint32_t position();
+
+        //! Number of values of the results buffer
+        uint32_t size() {return num_values;}
+
+        //! Pointer to the results
+        volatile uint16_t* const buffer() {return p_results;}
+
+        //! DMAChannel that copies the results
+        DMAChannel* resultChannel;
+
+        //! DMAChannel that starts the next conversion
+        DMAChannel* sc1aChannel;
+
+    protected:
+    private:
+
+        //! ADC module converting the pins
+        ADC_Module* const adc;
+
+        //! Pointer to the results
+        volatile uint16_t* const p_results;
+
+        //! Number of frames of the results buffer
+        const uint16_t num_frames;
+
+        //! Number of values of the results buffer, frames*num_pins
+        uint32_t num_values;
+
+        //! Is DMA converting the pins?
+        bool running;
+
+        //! SC1A numbers DMA writes to ADC_SC1A, sc1a_table[i] starts the conversion of pins[i+1]
+        uint32_t sc1a_table[ADC_MAX_SCAN_PINS];
+
+        volatile uint32_t* const ADC_RA;
+        volatile uint32_t* const ADC_SC1A;
+
+};
+
+
+#endif // SCANDMA_H
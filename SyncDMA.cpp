@@ -0,0 +1,244 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "SyncDMA.h"
+
+#if ADC_NUM_ADCS>1 && ADC_USE_PDB
+
+SyncDMA* SyncDMA::active = nullptr;
+
+// Constructor
+SyncDMA::SyncDMA(ADC* a_adc, volatile Frame* frames, uint16_t a_num_frames) :
+        adc(a_adc)
+        , p_frames(frames)
+        , num_frames(a_num_frames)
+        {
+
+    running = false;
+    wraps[0] = 0;
+    wraps[1] = 0;
+
+    adc0Channel = new DMAChannel(); // reserve the DMA channels
+    adc1Channel = new DMAChannel();
+}
+
+SyncDMA::~SyncDMA() {
+    stop();
+    delete adc1Channel;
+    delete adc0Channel;
+}
+
+bool SyncDMA::start(uint8_t pin0, uint8_t pin1, uint32_t freq) {
+
+    if(!adc->adc0->checkPin(pin0)) {
+        adc->adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+    if(!adc->adc1->checkPin(pin1)) {
+        adc->adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    if(!prepare(freq, false)) {
+        return false;
+    }
+
+    // with hardware trigger writing SC1A selects the pin, the PDB starts the conversions
+    adc->adc0->startReadFast(pin0);
+    adc->adc1->startReadFast(pin1);
+
+    startTrigger(ADC_Module::solvePDB(freq), 0);
+    return true;
+}
+
+bool SyncDMA::startDifferential(uint8_t pin0P, uint8_t pin0N, uint8_t pin1P, uint8_t pin1N, uint32_t freq) {
+
+    if(!adc->adc0->checkDifferentialPins(pin0P, pin0N)) {
+        adc->adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+    if(!adc->adc1->checkDifferentialPins(pin1P, pin1N)) {
+        adc->adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    if(!prepare(freq, true)) {
+        return false;
+    }
+
+    adc->adc0->startDifferentialFast(pin0P, pin0N);
+    adc->adc1->startDifferentialFast(pin1P, pin1N);
+
+    startTrigger(ADC_Module::solvePDB(freq), 0);
+    return true;
+}
+
+bool SyncDMA::prepare(uint32_t freq, bool differential) {
+
+    if( (num_frames==0) || (num_frames>SYNC_DMA_MAX_FRAMES) ) {
+        adc->adc0->fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    ADC_Module* const modules[2] = {adc->adc0, adc->adc1};
+    for(uint8_t i=0; i<2; i++) {
+        if(modules[i]->isOwned()) {
+            modules[i]->fail_flag |= ADC_ERROR::OWNED;
+            return false;
+        }
+    }
+
+    stop(); // in case it was running
+
+    for(uint8_t i=0; i<2; i++) {
+        modules[i]->wait_for_cal(); // the sample rate depends on the settings after the calibration
+        // each trigger must find the ADC idle, or the conversion is lost
+        if( (freq==0) || (freq>modules[i]->getMaxSampleRate(differential)) ) {
+            modules[i]->fail_flag |= ADC_ERROR::OTHER;
+            return false;
+        }
+    }
+
+    for(uint8_t i=0; i<2; i++) {
+        modules[i]->disableInterrupts();
+        modules[i]->singleMode();
+        modules[i]->setHardwareTrigger(); // before selecting the pin, so that no conversion starts
+        modules[i]->enableDMA();
+        modules[i]->num_measurements++;
+        setupChannel(i);
+    }
+
+    return true;
+}
+
+void SyncDMA::setupChannel(uint8_t adc_num) {
+    DMAChannel* const channel = adc_num ? adc1Channel : adc0Channel;
+
+    // the channel copies RA into its half of each frame, so the destination advances a whole frame
+    if(adc_num) {
+        channel->source(ADC1_RA);
+        channel->destinationBuffer(&p_frames[0].result_adc1, 2*num_frames);
+    } else {
+        channel->source(ADC0_RA);
+        channel->destinationBuffer(&p_frames[0].result_adc0, 2*num_frames);
+    }
+    channel->transferSize(2);
+    channel->transferCount(num_frames);
+    channel->TCD->DOFF = sizeof(Frame); // after transferSize, it sets it to the transfer size
+    channel->TCD->DLASTSGA = -(int32_t)(sizeof(Frame)*num_frames);
+
+    wraps[adc_num] = 0;
+    channel->interruptAtCompletion(); // each time the buffer is full, to count the frames
+    channel->attachInterrupt(adc_num ? adc1_dma_isr : adc0_dma_isr);
+
+    channel->triggerAtHardwareEvent(adc_num ? DMAMUX_SOURCE_ADC1 : DMAMUX_SOURCE_ADC0); // start DMA channel when ADC finishes a conversion
+    channel->enable();
+}
+
+void SyncDMA::startTrigger(const ADC_PDBConfig& config, uint16_t adc1_delay) {
+    active = this;
+    running = true;
+
+    // both modules are attached before the counter starts, so the first frame isn't lost in one ADC
+    adc->pdb->stop();
+    adc->pdb->attach(adc->adc0);
+    adc->pdb->attach(adc->adc1, adc1_delay);
+    adc->pdb->start(config);
+}
+
+void SyncDMA::stop() {
+    if(!running) {
+        return;
+    }
+
+    adc->pdb->stop(); // this also sets software trigger on both ADCs
+
+    adc0Channel->disable();
+    adc1Channel->disable();
+
+    // set channel select to all 1's (31) to stop it.
+    ADC0_SC1A = ADC_SC1A_PIN_INVALID;
+    ADC1_SC1A = ADC_SC1A_PIN_INVALID;
+    adc->adc0->disableDMA();
+    adc->adc1->disableDMA();
+    adc->adc0->num_measurements--;
+    adc->adc1->num_measurements--;
+
+    // a wrap just before disable() leaves an interrupt pending, the isrs ignore it once active is null
+    adc0Channel->clearInterrupt();
+    adc1Channel->clearInterrupt();
+
+    active = nullptr;
+    running = false;
+}
+
+/* Wraps counted by the isr and the destination address of DMA.
+*  If the buffer was filled again but the isr didn't run yet (DONE is set) that wrap is counted too.
+*/
+uint32_t SyncDMA::frameCount(uint8_t adc_num) {
+    DMAChannel* const channel = adc_num ? adc1Channel : adc0Channel;
+    const uint32_t first = adc_num ? uint32_t(&p_frames[0].result_adc1) : uint32_t(&p_frames[0].result_adc0);
+
+    __disable_irq();
+    bool wrapped = channel->complete();
+    uint32_t index = (uint32_t(channel->destinationAddress()) - first)/sizeof(Frame);
+    if(!wrapped && channel->complete()) { // DMA wrapped between the reads, the index is from the previous round
+        wrapped = true;
+        index = (uint32_t(channel->destinationAddress()) - first)/sizeof(Frame);
+    }
+    const uint32_t count = (wraps[adc_num] + (wrapped ? 1 : 0))*num_frames + index;
+    __enable_irq();
+
+    return count;
+}
+
+int32_t SyncDMA::getSkew() {
+    const uint32_t count0 = frameCount(0);
+    const uint32_t count1 = frameCount(1);
+    return (int32_t)(count0 - count1);
+}
+
+void SyncDMA::adc0_dma_isr() {
+    SyncDMA* const sync = active;
+    if(sync == nullptr) { // stopped, stop() cleared the interrupt
+        return;
+    }
+    sync->wraps[0]++;
+    sync->adc0Channel->clearComplete();
+    sync->adc0Channel->clearInterrupt();
+}
+
+void SyncDMA::adc1_dma_isr() {
+    SyncDMA* const sync = active;
+    if(sync == nullptr) { // stopped, stop() cleared the interrupt
+        return;
+    }
+    sync->wraps[1]++;
+    sync->adc1Channel->clearComplete();
+    sync->adc1Channel->clearInterrupt();
+}
+
+#endif // ADC_NUM_ADCS>1 && ADC_USE_PDB
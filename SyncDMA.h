@@ -0,0 +1,164 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef SYNCDMA_H
+#define SYNCDMA_H
+
+#include <Arduino.h>
+#include "DMAChannel.h"
+#include "ADC.h"
+
+#if ADC_NUM_ADCS>1 && ADC_USE_PDB
+
+// max number of frames of SyncDMA, the major loop count has 15 bits
+#define SYNC_DMA_MAX_FRAMES (32767)
+
+
+/** Class SyncDMA streams synchronized conversions of both ADCs into a buffer of frames.
+*   The PDB triggers ADC0 and ADC1 at the same time (pretrigger A of both PDB channels),
+*   and each ADC has a DMA channel that copies its result into its half of the frame,
+*   so frames[i] holds the values of both pins sampled at the same instant, without any ADC isr.
+*   When the buffer is full DMA starts again at the beginning, the DMA isr only counts these wraps.
+*   Each DMA channel counts its frames, if they differ when both ADCs are idle a conversion was lost (see getSkew).
+*/
+class SyncDMA
+{
+    public:
+
+        //! Results of both ADCs triggered at the same time, like ADC::Sync_result with the values DMA copies.
+        /** Cast them to int16_t for differential conversions.
+        */
+        struct Frame {
+            uint16_t result_adc0, result_adc1;
+        };
+
+        //! Constructor, frames has space for num_frames frames, up to SYNC_DMA_MAX_FRAMES
+        SyncDMA(ADC* adc, volatile Frame* frames, uint16_t num_frames);
+
+        //! Destructor
+        ~SyncDMA();
+
+        //! Start converting pin0 in ADC0 and pin1 in ADC1 at freq Hz
+        /** Both ADCs must be configured before (resolution, averages, speed), freq must be lower than getMaxSampleRate of both.
+        *   It disables the ADC interrupts, enables DMA and uses the PDB, don't use them or startPDB while it's running.
+        *   \param pin0 pin in ADC0.
+        *   \param pin1 pin in ADC1.
+        *   \param freq frequency of the frames in Hz.
+        *   \return true if it started, false if a pin is wrong (ADC_ERROR::WRONG_PIN), an ADC is owned (ADC_ERROR::OWNED)
+        *           or freq is too high or 0 (ADC_ERROR::OTHER).
+        */
+        bool start(uint8_t pin0, uint8_t pin1, uint32_t freq);
+
+        //! Start differential conversions of pin0P-pin0N in ADC0 and pin1P-pin1N in ADC1 at freq Hz
+        /** See start.
+        *   \param pin0P positive pin in ADC0.
+        *   \param pin0N negative pin in ADC0.
+        *   \param pin1P positive pin in ADC1.
+        *   \param pin1N negative pin in ADC1.
+        *   \param freq frequency of the frames in Hz.
+        *   \return true if it started, false otherwise.
+        */
+        bool startDifferential(uint8_t pin0P, uint8_t pin0N, uint8_t pin1P, uint8_t pin1N, uint32_t freq);
+
+        //! Stop the PDB, the conversions and the DMA channels
+        void stop();
+
+        //! Number of frames of both ADCs written since start
+        uint32_t frameCount() {
+            const uint32_t count0 = frameCount(0);
+            const uint32_t count1 = frameCount(1);
+            return (count0 < count1) ? count0 : count1;
+        }
+
+        //! Number of results of an ADC written since start
+        /** \param adc_num ADC number (0 or 1).
+        */
+        uint32_t frameCount(uint8_t adc_num);
+
+        //! Results of ADC0 written since start minus those of ADC1
+        /** Both ADCs finish their conversions at about the same time, so it can be +-1 during a conversion.
+        *   Any other value means that an ADC missed a trigger or DMA missed a result.
+        */
+        int32_t getSkew();
+
+        //! Index of the frame DMA will write next, the frames before it (and after it, if DMA wrapped) are complete
+        uint32_t position() {return frameCount()%num_frames;}
+
+        //! Number of frames of the buffer
+        uint32_t size() {return num_frames;}
+
+        //! Pointer to the frames
+        volatile Frame* const buffer() {return p_frames;}
+
+        //! Is it converting?
+        bool isRunning() {return running;}
+
+        //! DMAChannel that copies the results of ADC0
+        DMAChannel* adc0Channel;
+
+        //! DMAChannel that copies the results of ADC1
+        DMAChannel* adc1Channel;
+
+    protected:
+
+        //! ADC object, both modules are used
+        ADC* const adc;
+
+        //! Pointer to the frames
+        volatile Frame* const p_frames;
+
+        //! Number of frames
+        const uint16_t num_frames;
+
+        //! Checks freq and the modules, sets up the DMA channels and the ADCs; the conversions start with startTrigger
+        bool prepare(uint32_t freq, bool differential);
+
+        //! Attaches both ADCs to the PDB and starts it, ADC1 adc1_delay counts after ADC0 (see PDBTimebase::attach)
+        void startTrigger(const ADC_PDBConfig& config, uint16_t adc1_delay);
+
+    private:
+
+        //! Is the PDB triggering the conversions?
+        bool running;
+
+        //! Times DMA filled the buffer, by ADC
+        volatile uint32_t wraps[2];
+
+        //! Sets up the DMA channel that copies the results of ADC adc_num
+        void setupChannel(uint8_t adc_num);
+
+        //! Instance that the DMA isrs update, only one can run because it uses both ADCs
+        static SyncDMA* active;
+
+        //! DMA isrs, they count the wraps of each channel
+        static void adc0_dma_isr();
+        static void adc1_dma_isr();
+
+};
+
+#endif // ADC_NUM_ADCS>1 && ADC_USE_PDB
+
+#endif // SYNCDMA_H
@@ -11,7 +11,49 @@ namespace atomic
     *   We can change this functions depending on the board.
     *   Teensy 3.x use bitband while Teensy LC has a more advanced bit manipulation engine.
     */
-    #if defined(KINETISK) // Teensy 3.x
+    #if defined(ADC_HOST_SIM) // simulated registers, see host/ADC_HostSim.h
+    // Plain read-modify-write, the simulated registers have no bit-band or BME aliases.
+    // The register type R is a volatile integer or an ADC_HostSim::Register.
+
+    template<typename R>
+    inline void setBit(R& reg, uint8_t bit) {
+        reg = reg | (1<<bit);
+    }
+    template<typename R, typename T>
+    inline void setBitFlag(R& reg, T flag) {
+        reg = reg | flag;
+    }
+
+    template<typename R>
+    inline void clearBit(R& reg, uint8_t bit) {
+        reg = reg & ~(1<<bit);
+    }
+    template<typename R, typename T>
+    inline void clearBitFlag(R& reg, T flag) {
+        reg = reg & ~flag;
+    }
+
+    template<typename R>
+    inline void changeBit(R& reg, uint8_t bit, bool state) {
+        state ? setBit(reg, bit) : clearBit(reg, bit);
+    }
+    template<typename R, typename T, typename S>
+    inline void changeBitFlag(R& reg, T flag, S state) {
+        reg = (reg & ~flag) | (state & flag);
+    }
+
+    template<typename R>
+    inline bool getBit(R& reg, uint8_t bit) {
+        return (reg >> bit) & 0x1;
+    }
+    template<typename R, typename T>
+    inline bool getBitFlag(R& reg, T flag) {
+        return (reg & flag) != 0;
+    }
+
+
+
+    #elif defined(KINETISK) // Teensy 3.x
     //! Bitband address
     /** Gets the aliased address of the bit-band register
     *   \param reg  Register in the bit-band area
@@ -121,6 +163,35 @@ namespace atomic
 
     #endif
 
+
+    /////// Interrupt mask
+    /* Disable the interrupts and return the previous mask (PRIMASK), restoreInterrupts(mask) puts it back.
+    *   Unlike __disable_irq()/__enable_irq() they don't enable the interrupts if the caller had disabled them.
+    */
+    #if defined(ADC_HOST_SIM)
+    inline uint32_t disableInterrupts() {
+        const uint32_t primask = ADC_HostSim::irqMasked();
+        __disable_irq();
+        return primask;
+    }
+    inline void restoreInterrupts(uint32_t primask) {
+        if(!primask) {
+            __enable_irq();
+        }
+    }
+
+    #else
+    __attribute__((always_inline)) inline uint32_t disableInterrupts() {
+        uint32_t primask;
+        __asm__ volatile("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+        return primask;
+    }
+    __attribute__((always_inline)) inline void restoreInterrupts(uint32_t primask) {
+        __asm__ volatile("msr primask, %0" :: "r" (primask) : "memory");
+    }
+
+    #endif
+
 }
 
 #endif // ATOMIC_H
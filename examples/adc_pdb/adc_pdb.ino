@@ -60,18 +60,23 @@ void loop() {
             if (freq == 0) {
                 Serial.println("Stop pdb.");
                 adc->adc0->stopPDB();
+                #if ADC_NUM_ADCS>1
                 adc->adc1->stopPDB();
+                #endif
             }
             else {
                 Serial.print("Start pdb with frequency ");
                 Serial.print(freq);
                 Serial.println(" Hz.");
+                // both ADCs share the PDB counter, stop both before changing the frequency
                 adc->adc0->stopPDB();
+                #if ADC_NUM_ADCS>1
+                adc->adc1->stopPDB();
+                #endif
                 adc->adc0->startSingleRead(readPin); // call this to setup everything before the pdb starts, differential is also possible
                 adc->enableInterrupts(ADC_0);
                 adc->adc0->startPDB(freq); //frequency in Hz
                 #if ADC_NUM_ADCS>1
-                adc->adc1->stopPDB();
                 adc->adc1->startSingleRead(readPin2); // call this to setup everything before the pdb starts
                 adc->enableInterrupts(ADC_1);
                 adc->adc1->startPDB(freq); //frequency in Hz
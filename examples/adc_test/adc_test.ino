@@ -77,6 +77,57 @@ bool test_pullup_down(bool pullup) {
     return pass_test;
 }
 
+// the first calibration starts in the constructor and finishes by itself,
+// settings set after that must be written to the registers right away, even if nobody waited for it
+bool test_settings() {
+    bool pass_test = true;
+
+    delay(100); // longer than the calibration
+    adc->setResolution(12, ADC_0);
+
+    if((ADC0_CFG1 & ADC_CFG1_MODE(3)) != ADC_CFG1_MODE(1)) { // 12 bits single-ended
+        Serial.print("ADC0_CFG1 doesn't have 12 bits: 0x"); Serial.println((uint32_t)ADC0_CFG1, HEX);
+        pass_test = false;
+    }
+    if(adc->getResolution(ADC_0) != 12) {
+        Serial.print("Resolution should be 12, but it's "); Serial.println(adc->getResolution(ADC_0));
+        pass_test = false;
+    }
+
+    return pass_test;
+}
+
+// applyProfile skips the calibration of the profile if it's loaded already,
+// but it must write it again after another calibration was loaded
+bool test_profiles() {
+    bool pass_test = true;
+
+    ADC_Module::ADC_Calibration original;
+    if(!adc->adc0->exportCalibration(&original)) {
+        Serial.println("No calibration to export");
+        return false;
+    }
+
+    ADC_Module::ADC_Profile profile;
+    adc->saveProfile(&profile, ADC_0);
+    adc->applyProfile(profile, ADC_0); // same calibration
+
+    ADC_Module::ADC_Calibration other = original;
+    other.ofs = original.ofs + 1;
+    adc->adc0->importCalibration(&other);
+
+    adc->applyProfile(profile, ADC_0);
+    if(ADC0_OFS != original.ofs) {
+        Serial.print("ADC0_OFS should be "); Serial.print(original.ofs);
+        Serial.print(", but it's "); Serial.println((uint32_t)ADC0_OFS);
+        pass_test = false;
+    }
+
+    adc->adc0->importCalibration(&original);
+
+    return pass_test;
+}
+
 const uint8_t pin_cmp = A0;
 
 bool test_compare() {
@@ -195,6 +246,9 @@ void setup() {
 
     Serial.begin(9600);
 
+    // before any other setting
+    bool settings_test = test_settings();
+
 
     ///// ADC0 ////
     // reference can be ADC_REFERENCE::REF_3V3, ADC_REFERENCE::REF_1V2 (not for Teensy LC) or ADC_REFERENCE::REF_EXT.
@@ -239,6 +293,7 @@ void setup() {
 
     ////// START TESTS /////////////
 
+    Serial.print("SETTINGS TEST "); Serial.println(settings_test ? "PASS" : "FAIL");
     bool pullup_test = test_pullup_down(true);
     Serial.print("PULLUP TEST "); Serial.println(pullup_test ? "PASS" : "FAIL");
     bool pulldown_test = test_pullup_down(false);
@@ -249,6 +304,8 @@ void setup() {
     Serial.print("COMPARE RANGE TEST "); Serial.println(compare_range_test ? "PASS" : "FAIL");
     bool averages_test = test_averages();
     Serial.print("AVERAGES TEST "); Serial.println(averages_test ? "PASS" : "FAIL");
+    bool profiles_test = test_profiles();
+    Serial.print("PROFILES TEST "); Serial.println(profiles_test ? "PASS" : "FAIL");
 }
 
 
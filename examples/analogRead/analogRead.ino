@@ -89,6 +89,8 @@ void loop() {
 
     #if ADC_NUM_ADCS>1
     value2 = adc->analogRead(readPin2, ADC_1);
+    // if the pin and ADC are known at compile time this is faster, and a wrong pin is a compile error:
+    //value2 = adc->analogRead<A2, ADC_1>();
 
     Serial.print("Pin: ");
     Serial.print(readPin2);
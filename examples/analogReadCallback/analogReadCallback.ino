@@ -0,0 +1,90 @@
+/* Example for onComplete
+*  ADC0 converts continuously and the library calls a function with every block of BATCH values,
+*  there's no adc0_isr in the sketch. The function gets a pointer to the statistics of the pin (ctx)
+*  and updates them, loop() prints them once per second.
+*/
+
+#include <ADC.h>
+
+const int readPin = A9; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+#define BATCH 64
+uint16_t batch_buffer[BATCH]; // the library keeps the values here until the block is full
+
+// statistics of the pin, updated in the ADC interrupt
+struct Stats {
+    volatile uint32_t blocks;
+    volatile uint16_t min, max;
+    volatile uint32_t mean;
+};
+Stats stats;
+
+void block_done(const uint16_t* values, uint16_t count, void* ctx) {
+    Stats* s = (Stats*)ctx;
+    uint16_t block_min = 0xFFFF, block_max = 0;
+    uint32_t sum = 0;
+    for(uint16_t i = 0; i < count; i++) {
+        if(values[i] < block_min) {
+            block_min = values[i];
+        }
+        if(values[i] > block_max) {
+            block_max = values[i];
+        }
+        sum += values[i];
+    }
+    s->min = block_min;
+    s->max = block_max;
+    s->mean = sum/count;
+    s->blocks++;
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    adc->setAveraging(4, ADC_0);
+    adc->setResolution(12, ADC_0);
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::MED_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::MED_SPEED, ADC_0);
+
+    // call block_done with &stats every BATCH conversions, it also enables the interrupts
+    if(!adc->onComplete(block_done, &stats, BATCH, batch_buffer, ADC_0)) {
+        Serial.println("Wrong batch");
+    }
+
+    adc->startContinuous(readPin, ADC_0);
+
+    delay(500);
+}
+
+void loop() {
+
+    __disable_irq(); // read the statistics of the same block
+    const uint32_t blocks = stats.blocks;
+    const float mean = stats.mean*3.3/adc->getMaxValue(ADC_0);
+    const float min_value = stats.min*3.3/adc->getMaxValue(ADC_0);
+    const float max_value = stats.max*3.3/adc->getMaxValue(ADC_0);
+    __enable_irq();
+
+    Serial.print("Blocks: ");
+    Serial.print(blocks);
+    Serial.print(", mean: ");
+    Serial.print(mean, 3);
+    Serial.print(" V, min: ");
+    Serial.print(min_value, 3);
+    Serial.print(" V, max: ");
+    Serial.print(max_value, 3);
+    Serial.println(" V");
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
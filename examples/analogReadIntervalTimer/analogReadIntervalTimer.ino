@@ -9,12 +9,11 @@
         startSingleRead, startSingleDifferential, startSynchronizedSingleRead, startSynchronizedSingleDifferential
     you can use the ADC0 or ADC1 (only for Teensy 3.1).
 
-    When the measurement is done, the adc_isr is executed:
+    When the measurement is done, the library's adc interrupt calls the function set with onComplete, adc0_complete:
         - If you have more than one timer per ADC module you need to know which pin was measured.
         - Then you store/process the data
-        - Finally, if you have more than one timer you can check whether the last measurement interruped a
-          a previous one (using adc->adcX->adcWasInUse), and restart it if so.
-          The settings of the interrupted measurement are stored in the adc->adcX->adc_config struct.
+    After that, if the last measurement interrupted a previous one, the library restarts it.
+    (If you write your own adc0_isr instead, check adc->adcX->adcWasInUse there and load adc->adcX->adc_config if it's true.)
 
 
 */
@@ -39,9 +38,15 @@ const int readPeriod = 100000; // us
 ADC *adc = new ADC(); // adc object
 
 IntervalTimer timer0, timer1; // timers
+void timer0_callback(void);
+void timer1_callback(void);
+void adc0_complete(const uint16_t* values, uint16_t count, void* ctx);
 
-RingBuffer *buffer0 = new RingBuffer; // buffers to store the values
-RingBuffer *buffer1 = new RingBuffer;
+// buffers to store the values, written in adc0_complete (producer) and read in loop() (consumer)
+// RingBufferSPSC doesn't need to disable interrupts, if loop() is too slow new values are dropped and counted.
+typedef ADC_Buffer::RingBufferSPSC<int, RING_BUFFER_DEFAULT_BUFFER_SIZE> SampleBuffer;
+SampleBuffer *buffer0 = new SampleBuffer;
+SampleBuffer *buffer1 = new SampleBuffer;
 
 int startTimerValue0 = 0, startTimerValue1 = 0;
 
@@ -51,8 +56,8 @@ void setup() {
 
     pinMode(ledPin+1, OUTPUT); // timer0 starts a measurement
     pinMode(ledPin+2, OUTPUT); // timer1 starts a measurement
-    pinMode(ledPin+3, OUTPUT); // adc0_isr, measurement finished for readPin0
-    pinMode(ledPin+4, OUTPUT); // adc0_isr, measurement finished for readPin1
+    pinMode(ledPin+3, OUTPUT); // adc0_complete, measurement finished for readPin0
+    pinMode(ledPin+4, OUTPUT); // adc0_complete, measurement finished for readPin1
 
     pinMode(readPin0, INPUT);
     pinMode(readPin1, INPUT);
@@ -96,8 +101,8 @@ void setup() {
     // You can check with an oscilloscope:
     // Pin 14 corresponds to the timer0 initiating a measurement
     // Pin 15 the same for the timer1
-    // Pin 16 is the adc_isr when there's a new measurement on readpin0
-    // Pin 17 is the adc_isr when there's a new measurement on readpin1
+    // Pin 16 is adc0_complete when there's a new measurement on readpin0
+    // Pin 17 is adc0_complete when there's a new measurement on readpin1
 
     // Timer0 starts a comversion and 25 us later timer1 starts a new one, "pausing" the first, about 36 us later timer1's conversion
     // is done, and timer0's is restarted, 36 us later timer0's conversion finishes. About 14 us later timer0 starts a new conversion again.
@@ -106,7 +111,8 @@ void setup() {
     // if you change the periods, make sure you don't go into a loop, with the timers always interrupting each other
     startTimerValue1 = timer1.begin(timer1_callback, period1);
 
-    adc->enableInterrupts(ADC_0);
+    // the library handles the interrupts of ADC0 and calls adc0_complete with each value
+    adc->onComplete(adc0_complete, nullptr, 1, nullptr, ADC_0);
 
     Serial.println("Timers started");
 
@@ -183,35 +189,24 @@ void timer1_callback(void) {
 
 // when the measurement finishes, this will be called
 // first: see which pin finished and then save the measurement into the correct buffer
-void adc0_isr() {
+void adc0_complete(const uint16_t* values, uint16_t count, void* ctx) {
 
     uint8_t pin = ADC::sc1a2channelADC0[ADC0_SC1A&ADC_SC1A_CHANNELS]; // the bits 0-4 of ADC0_SC1A have the channel
 
     // add value to correct buffer
     if(pin==readPin0) {
         digitalWriteFast(ledPin+3, HIGH);
-        buffer0->write(adc->readSingle());
+        buffer0->write(values[0]);
         digitalWriteFast(ledPin+3, LOW);
     } else if(pin==readPin1) {
         digitalWriteFast(ledPin+4, HIGH);
-        buffer1->write(adc->readSingle());
+        buffer1->write(values[0]);
         if(adc->adc0->isConverting()) {
             digitalWriteFast(LED_BUILTIN, 1);
         }
         digitalWriteFast(ledPin+4, LOW);
-    } else { // clear interrupt anyway
-        adc->readSingle();
     }
 
-    // restore ADC config if it was in use before being interrupted by the analog timer
-    if (adc->adc0->adcWasInUse) {
-        // restore ADC config, and restart conversion
-        adc->adc0->loadConfig(&adc->adc0->adc_config);
-        // avoid a conversion started by this isr to repeat itself
-        adc->adc0->adcWasInUse = false;
-    }
-
-
-    //digitalWriteFast(ledPin+2, !digitalReadFast(ledPin+2));
+    // the library restores the interrupted measurement, if any, after this
 
 }
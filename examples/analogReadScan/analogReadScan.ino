@@ -0,0 +1,81 @@
+/* Example for startScan
+*  It converts A0 to A9 one after the other with ADC0, 4 times,
+*  and prints the 4 frames of results once per second.
+*  The pins are checked and the ADC is configured once in startScan,
+*  each conversion is started from adc0_isr, so loop() is free while the scan runs.
+*/
+
+#include <ADC.h>
+
+ADC *adc = new ADC(); // adc object
+
+#define PINS 10
+#define FRAMES 4
+const uint8_t scan_pins[PINS] = {A0,A1,A2,A3,A4,A5,A6,A7,A8,A9};
+
+// results of the scan: scan_values[frame*PINS + i] is the value of scan_pins[i]
+volatile uint16_t scan_values[PINS*FRAMES];
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+
+    for (int i=0;i<PINS;i++) {
+        pinMode(scan_pins[i], INPUT);
+    }
+
+    Serial.begin(9600);
+
+    adc->setAveraging(4, ADC_0); // set number of averages
+    adc->setResolution(12, ADC_0); // set bits of resolution
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, ADC_0);
+
+    // the scan is driven by the adc interrupt
+    adc->enableInterrupts(ADC_0);
+
+    delay(500);
+}
+
+void loop() {
+
+    uint32_t t = micros();
+    if(!adc->startScan(scan_pins, PINS, scan_values, FRAMES, ADC_0)) {
+        Serial.println("Wrong pins");
+        adc->printError();
+        adc->resetError();
+        delay(1000);
+        return;
+    }
+
+    while(adc->isScanning(ADC_0)) {
+        // do something useful here
+        yield();
+    }
+    t = micros() - t;
+
+    Serial.print("Scan of ");
+    Serial.print(PINS*FRAMES);
+    Serial.print(" conversions took ");
+    Serial.print(t);
+    Serial.println(" us");
+
+    for(int frame=0; frame<FRAMES; frame++) {
+        for(int i=0; i<PINS; i++) {
+            Serial.print(scan_values[frame*PINS + i]*3.3/adc->getMaxValue(ADC_0), 2);
+            Serial.print(". ");
+        }
+        Serial.println();
+    }
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
+
+// each conversion of the scan ends here
+void adc0_isr(void) {
+    if(!adc->adc0->scanStep()) { // not scanning, clear the interrupt
+        adc->adc0->readSingle();
+    }
+}
@@ -0,0 +1,69 @@
+/* Example for exportCalibration and importCalibration
+*  The first time it runs it waits for the calibration and stores it in the EEPROM,
+*  after that the calibration at startup is skipped by loading the stored one.
+*  Send 'c' through the serial port to calibrate again and store the new calibration.
+*/
+
+#include <ADC.h>
+#include <EEPROM.h>
+
+const int readPin = A9; // ADC0
+const int eeprom_address = 0; // where the calibration is stored
+
+ADC *adc = new ADC(); // adc object
+
+void store_calibration() {
+    ADC_Module::ADC_Calibration cal;
+    adc->adc0->wait_for_cal();
+    if(adc->adc0->exportCalibration(&cal)) {
+        EEPROM.put(eeprom_address, cal);
+        Serial.println("Calibration stored");
+    } else {
+        Serial.println("Calibration failed");
+    }
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    // the calibration started by the constructor is stopped if there's a valid stored one
+    // (the magic number of an empty EEPROM is 0xFFFF)
+    ADC_Module::ADC_Calibration cal;
+    EEPROM.get(eeprom_address, cal);
+    if(adc->adc0->importCalibration(&cal)) {
+        Serial.println("Calibration loaded");
+    } else {
+        adc->resetError(); // importCalibration sets ADC_ERROR::CALIB
+        store_calibration();
+    }
+
+    // these settings are applied right away if the calibration was loaded,
+    // or when the calibration is done otherwise
+    adc->setAveraging(8, ADC_0);
+    adc->setResolution(12, ADC_0);
+
+    delay(500);
+}
+
+void loop() {
+
+    if(Serial.available() && (Serial.read() == 'c')) {
+        adc->adc0->recalibrate();
+        store_calibration();
+    }
+
+    int value = adc->analogRead(readPin, ADC_0);
+    Serial.print("Value: ");
+    Serial.println(value*3.3/adc->getMaxValue(ADC_0), DEC);
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(500);
+}
@@ -0,0 +1,99 @@
+/* Measures how many conversions per second ADC0 does with different resolutions and speeds,
+*  with blocking analogRead calls and with continuous conversions read in adc0_isr.
+*  The conversion times predicted by getConversionTimeNs are printed too, analogRead adds the time of the code.
+*  It also compiles for the host simulation (see README), there the times are simulated ADC times.
+*/
+
+#include <ADC.h>
+
+const uint8_t readPin = A9; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t NUM_READS = 1000; // analogRead calls per test
+const uint32_t CONTINUOUS_TIME_MS = 100; // length of the continuous test
+
+volatile uint32_t isr_count = 0;
+
+struct Setting {
+    uint8_t resolution;
+    uint8_t averages;
+    ADC_CONVERSION_SPEED conversion_speed;
+    ADC_SAMPLING_SPEED sampling_speed;
+    const char* name;
+};
+
+const Setting settings[] = {
+    {16, 32, ADC_CONVERSION_SPEED::VERY_LOW_SPEED, ADC_SAMPLING_SPEED::VERY_LOW_SPEED, "16 bits, 32 avg, very low speed"},
+    {16, 4, ADC_CONVERSION_SPEED::MED_SPEED, ADC_SAMPLING_SPEED::MED_SPEED, "16 bits, 4 avg, medium speed"},
+    {12, 4, ADC_CONVERSION_SPEED::HIGH_SPEED, ADC_SAMPLING_SPEED::HIGH_SPEED, "12 bits, 4 avg, high speed"},
+    {12, 1, ADC_CONVERSION_SPEED::HIGH_SPEED, ADC_SAMPLING_SPEED::HIGH_SPEED, "12 bits, no avg, high speed"},
+    {8, 1, ADC_CONVERSION_SPEED::VERY_HIGH_SPEED, ADC_SAMPLING_SPEED::VERY_HIGH_SPEED, "8 bits, no avg, very high speed"},
+};
+const uint8_t NUM_SETTINGS = sizeof(settings)/sizeof(settings[0]);
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+    delay(1000);
+}
+
+void loop() {
+
+    for(uint8_t i = 0; i < NUM_SETTINGS; i++) {
+        const Setting& s = settings[i];
+        adc->setResolution(s.resolution, ADC_0);
+        adc->setAveraging(s.averages, ADC_0);
+        adc->setConversionSpeed(s.conversion_speed, ADC_0);
+        adc->setSamplingSpeed(s.sampling_speed, ADC_0);
+
+        Serial.println(s.name);
+        Serial.print("  predicted: ");
+        Serial.print(adc->getConversionTimeNs(false, false, ADC_0)/1000.0, 3);
+        Serial.print(" us/conversion, continuous: ");
+        Serial.print(adc->getConversionTimeNs(false, true, ADC_0)/1000.0, 3);
+        Serial.println(" us/conversion");
+
+        // blocking reads
+        adc->disableInterrupts(ADC_0);
+        uint32_t t = micros();
+        for(uint32_t n = 0; n < NUM_READS; n++) {
+            adc->analogRead(readPin, ADC_0);
+        }
+        t = micros() - t;
+        Serial.print("  analogRead: ");
+        Serial.print((float)t/NUM_READS, 3);
+        Serial.print(" us/conversion, ");
+        Serial.print(1000.0*NUM_READS/t, 1);
+        Serial.println(" kHz");
+
+        // continuous conversions, each one read in the isr
+        isr_count = 0;
+        adc->enableInterrupts(ADC_0);
+        adc->startContinuous(readPin, ADC_0);
+        delay(CONTINUOUS_TIME_MS);
+        adc->stopContinuous(ADC_0);
+        adc->disableInterrupts(ADC_0);
+        Serial.print("  continuous: ");
+        Serial.print(1000.0*CONTINUOUS_TIME_MS/isr_count, 3);
+        Serial.print(" us/conversion, ");
+        Serial.print((float)isr_count/CONTINUOUS_TIME_MS, 1);
+        Serial.println(" kHz");
+
+        adc->printError();
+        adc->resetError();
+    }
+    Serial.println();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(2000);
+}
+
+void adc0_isr(void) {
+    adc->adc0->readSingle();
+    isr_count++;
+}
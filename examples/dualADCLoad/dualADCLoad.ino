@@ -0,0 +1,134 @@
+/* Shows how the conversions of a pin that both ADCs can read are shared between them.
+*  ADC0 is slower (16 bits) than ADC1 (12 bits). A timer submits requests (see submit)
+*  without choosing the ADC and loop() reads the same pin with analogRead, letting the library choose the ADC or forcing one.
+*  The library uses the ADC that would finish the conversion first (see getCompletionTimeNs),
+*  counting the conversion time with its settings, the reads in progress and the requests in its queue.
+*  Every second loop() prints the rates and checks that:
+*  ROUTING: the requests were shared by both ADCs and none was lost or rejected.
+*  THROUGHPUT: letting the library choose is at least as fast (within 5%) as forcing the best ADC.
+*  It also compiles for the host simulation (see README).
+*/
+
+#include <ADC.h>
+#include <IntervalTimer.h>
+
+const int readPin = A2; // ADC0 or ADC1
+
+ADC *adc = new ADC(); // adc object
+
+IntervalTimer timer;
+
+const uint32_t NUM_READS = 2000;
+
+volatile uint32_t request_count;
+
+void request_done(const uint16_t* values, uint16_t count, void* ctx) {
+    request_count++;
+}
+
+void submit_request() {
+    adc->submit({readPin, 0, false, 0, request_done, nullptr});
+}
+
+// reads per second with adc_num, -1 lets the library choose
+float read_rate(int8_t adc_num) {
+    uint32_t t = micros();
+    for(uint32_t i = 0; i < NUM_READS; i++) {
+        adc->analogRead(readPin, adc_num);
+    }
+    t = micros() - t;
+    return NUM_READS*1e6/t;
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    adc->setResolution(16, ADC_0);
+    adc->setAveraging(4, ADC_0);
+
+    #if ADC_NUM_ADCS>1
+    adc->setResolution(12, ADC_1);
+    adc->setAveraging(4, ADC_1);
+    #endif
+
+    // the settings are applied when the first calibration is over, measure after that
+    adc->adc0->wait_for_cal();
+    #if ADC_NUM_ADCS>1
+    adc->adc1->wait_for_cal();
+    #endif
+
+    Serial.print("Conversion time ADC0: ");
+    Serial.print(adc->adc0->getConversionTimeNs());
+    #if ADC_NUM_ADCS>1
+    Serial.print(" ns, ADC1: ");
+    Serial.print(adc->adc1->getConversionTimeNs());
+    #endif
+    Serial.println(" ns");
+}
+
+void loop() {
+
+    adc->adc0->resetQueueStats();
+    #if ADC_NUM_ADCS>1
+    adc->adc1->resetQueueStats();
+    #endif
+    request_count = 0;
+    timer.begin(submit_request, 20); // us
+
+    const float rate_any = read_rate(-1);
+    const float rate_adc0 = read_rate(ADC_0);
+    float rate_best = rate_adc0;
+    Serial.print("Reads/s, any ADC: ");
+    Serial.print(rate_any, 0);
+    Serial.print(", ADC0: ");
+    Serial.print(rate_adc0, 0);
+    #if ADC_NUM_ADCS>1
+    const float rate_adc1 = read_rate(ADC_1);
+    if(rate_adc1 > rate_best) {
+        rate_best = rate_adc1;
+    }
+    Serial.print(", ADC1: ");
+    Serial.print(rate_adc1, 0);
+    #endif
+    Serial.println();
+
+    // no new requests, wait for the ones in the queues so the counts match
+    timer.end();
+    delay(10);
+
+    const uint32_t completed0 = adc->adc0->getQueueStats().completed;
+    uint32_t completed = completed0;
+    uint32_t rejected = adc->adc0->getQueueStats().rejected;
+    Serial.print("Requests ADC0: ");
+    Serial.print(completed0);
+    #if ADC_NUM_ADCS>1
+    const uint32_t completed1 = adc->adc1->getQueueStats().completed;
+    completed += completed1;
+    rejected += adc->adc1->getQueueStats().rejected;
+    Serial.print(", ADC1: ");
+    Serial.print(completed1);
+    #endif
+    Serial.print(", total: ");
+    Serial.print(request_count);
+    Serial.print(", rejected: ");
+    Serial.println(rejected);
+
+    bool routing_test = (completed0 > 0) && (completed == request_count) && (rejected == 0);
+    #if ADC_NUM_ADCS>1
+    routing_test = routing_test && (completed1 > 0);
+    #endif
+    Serial.print("ROUTING TEST "); Serial.println(routing_test ? "PASS" : "FAIL");
+    const bool throughput_test = (rate_any >= 0.95*rate_best);
+    Serial.print("THROUGHPUT TEST "); Serial.println(throughput_test ? "PASS" : "FAIL");
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
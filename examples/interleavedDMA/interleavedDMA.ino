@@ -0,0 +1,83 @@
+/* Example for InterleavedDMA
+*  ADC0 and ADC1 sample the same pin alternately, half a period apart, so the pin is sampled at twice the rate of one ADC.
+*  DMA writes the samples of both ADCs in time order into one buffer, no isr is called for the conversions.
+*  match() measures the offset and gain of ADC1 relative to ADC0 first, and sample() corrects the values.
+*  loop() prints the mean difference between the samples of ADC1 and ADC0 without and with the correction every second.
+*  With a constant or slow signal on the pin it should be close to 0 with the correction.
+*  Only for Teensy 3.1, 3.2, 3.5 and 3.6 (two ADCs and PDB).
+*/
+
+#include <ADC.h>
+#include <InterleavedDMA.h>
+
+const int readPin = A2; // ADC0 and ADC1
+
+ADC *adc = new ADC(); // adc object
+
+#define SAMPLES 512
+DMAMEM static volatile uint16_t samples[SAMPLES];
+
+InterleavedDMA *stream = new InterleavedDMA(adc, samples, SAMPLES);
+
+const uint32_t SAMPLE_RATE = 200000; // Hz, each ADC converts at half of it
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    // both ADCs with the same settings
+    for(int8_t i = ADC_0; i <= ADC_1; i++) {
+        adc->setAveraging(1, i);
+        adc->setResolution(12, i);
+        adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, i);
+        adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, i);
+    }
+
+    delay(500);
+
+    if(stream->match()) {
+        Serial.print("ADC1 offset: ");
+        Serial.print(stream->getOffset(ADC_1) - stream->getOffset(ADC_0));
+        Serial.print(", gain: ");
+        Serial.println(stream->getGain(ADC_1), 5);
+    } else {
+        Serial.println("Couldn't measure the ADCs");
+        adc->printError();
+    }
+
+    if(!stream->start(readPin, SAMPLE_RATE)) {
+        Serial.println("Wrong pin or sample rate too high");
+        adc->printError();
+    }
+}
+
+void loop() {
+
+    // the last complete samples, in pairs of ADC0 and ADC1
+    const uint32_t count = stream->sampleCount() & ~1;
+    const uint32_t pairs = SAMPLES/4; // well behind DMA
+    int32_t raw_difference = 0, difference = 0;
+    for(uint32_t i = count - 2*pairs; i < count; i += 2) {
+        raw_difference += samples[(i + 1)%SAMPLES] - samples[i%SAMPLES];
+        difference += stream->sample(i + 1) - stream->sample(i);
+    }
+
+    Serial.print("Samples: ");
+    Serial.print(count);
+    Serial.print(", skew: ");
+    Serial.print(stream->getSkew());
+    Serial.print(", ADC1-ADC0 raw: ");
+    Serial.print((float)raw_difference/pairs, 2);
+    Serial.print(", corrected: ");
+    Serial.println((float)difference/pairs, 2);
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
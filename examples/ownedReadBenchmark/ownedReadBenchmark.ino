@@ -0,0 +1,86 @@
+/* Compares the CPU cycles of analogRead and readOwned on ADC0.
+*  Cycles are counted with the DWT cycle counter (ARM_DWT_CYCCNT), on Teensy LC they're computed from micros().
+*  The fastest settings are used so the time of the code is a large part of the total,
+*  the time of the conversion itself (getConversionTimeNs) is subtracted to get the overhead of each call.
+*  It also compiles for the host simulation (see README), there every register access takes one bus cycle.
+*/
+
+#include <ADC.h>
+
+const uint8_t readPin = A9; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t NUM_READS = 1000;
+
+#if defined(KINETISL) // no DWT on Cortex-M0+
+uint32_t cycles() {
+    return micros()*(F_CPU/1000000);
+}
+#else
+uint32_t cycles() {
+    return ARM_DWT_CYCCNT;
+}
+#endif
+
+void print_cycles(const char* name, uint32_t total, float conversion_cycles) {
+    Serial.print(name);
+    Serial.print((float)total/NUM_READS, 1);
+    Serial.print(" cycles/read, overhead: ");
+    Serial.print((float)total/NUM_READS - conversion_cycles, 1);
+    Serial.println(" cycles/read");
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    #if !defined(KINETISL)
+    ARM_DEMCR |= ARM_DEMCR_TRCENA; // enable the cycle counter
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+    #endif
+
+    adc->setResolution(8, ADC_0);
+    adc->setAveraging(1, ADC_0);
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::VERY_HIGH_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::VERY_HIGH_SPEED, ADC_0);
+
+    delay(1000);
+}
+
+void loop() {
+
+    const float conversion_cycles = adc->getConversionTimeNs(false, false, ADC_0)*(F_CPU/1e9);
+    Serial.print("Conversion: ");
+    Serial.print(conversion_cycles, 1);
+    Serial.println(" cycles");
+
+    uint32_t t = cycles();
+    for(uint32_t i = 0; i < NUM_READS; i++) {
+        adc->adc0->analogRead(readPin);
+    }
+    t = cycles() - t;
+    print_cycles("analogRead: ", t, conversion_cycles);
+
+    if(adc->adc0->acquire()) {
+        t = cycles();
+        for(uint32_t i = 0; i < NUM_READS; i++) {
+            adc->adc0->readOwned(readPin);
+        }
+        t = cycles() - t;
+        adc->adc0->release();
+        print_cycles("readOwned: ", t, conversion_cycles);
+    } else {
+        Serial.println("ADC0 is busy");
+    }
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(2000);
+}
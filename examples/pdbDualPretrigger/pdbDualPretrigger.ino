@@ -0,0 +1,77 @@
+/* Example for startPDBDual
+*  Each period the PDB starts two conversions on ADC0: pretrigger A converts readPinA (SC1A) and,
+*  back to back, pretrigger B converts readPinB (SC1B) as soon as A is done. The CPU doesn't start any conversion.
+*  onComplete gets the values of A and B alternately, so with batches of 2 each call has one pair.
+*  loop() prints the last pair and the number of pairs per second.
+*  It also compiles for the host simulation (see README). Not for Teensy LC (no PDB).
+*/
+
+#include <ADC.h>
+
+const int readPinA = A9; // ADC0
+const int readPinB = A3; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t FREQ = 20000; // pairs per second
+
+uint16_t pair_buffer[2];
+
+volatile uint16_t value_a, value_b;
+volatile uint32_t pairs;
+
+void pair_done(const uint16_t* values, uint16_t count, void* ctx) {
+    value_a = values[0];
+    value_b = values[1];
+    pairs++;
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPinA, INPUT);
+    pinMode(readPinB, INPUT);
+
+    Serial.begin(9600);
+
+    adc->setAveraging(1, ADC_0);
+    adc->setResolution(12, ADC_0);
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, ADC_0);
+
+    // it also enables the interrupts of both pretriggers
+    adc->adc0->onComplete(pair_done, nullptr, 2, pair_buffer);
+
+    // without back to back, B would start at a fixed delay after the start of the period:
+    // adc->adc0->startPDBDual(readPinA, readPinB, FREQ, false, 0, delayB);
+    if(!adc->adc0->startPDBDual(readPinA, readPinB, FREQ)) {
+        Serial.println("Wrong pins or the conversions don't fit in the period");
+        adc->printError();
+    }
+
+    delay(500);
+}
+
+void loop() {
+
+    __disable_irq(); // the values of the same pair
+    const uint16_t a = value_a;
+    const uint16_t b = value_b;
+    const uint32_t count = pairs;
+    pairs = 0;
+    __enable_irq();
+
+    Serial.print("A: ");
+    Serial.print(a*3.3/adc->getMaxValue(ADC_0), 3);
+    Serial.print(" V, B: ");
+    Serial.print(b*3.3/adc->getMaxValue(ADC_0), 3);
+    Serial.print(" V, pairs: ");
+    Serial.println(count);
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
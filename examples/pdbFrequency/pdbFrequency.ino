@@ -0,0 +1,136 @@
+/* Example for solvePDB
+*  The PDB settings for a frequency are computed at compile time (constexpr) and checked with static_assert,
+*  then ADC0 is triggered by the PDB at 44.1 kHz and loop() prints the real frequency.
+*  setup() also checks solvePDB against a search of every prescaler, mult and MOD for the bus frequencies of all boards,
+*  and prints PASS or FAIL for each one. It also compiles for the host simulation (see README),
+*  where a FAIL ends the program with exit status 1, so it can run as a test.
+*  Not for Teensy LC (no PDB).
+*/
+
+#include <ADC.h>
+
+const int readPin = A9; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+// 48 MHz/48 kHz is 1000 bus cycles, so it's exact
+static_assert(ADC_Module::solvePDB(48000, 48000000).error_ppm == 0, "48 kHz should be exact at 48 MHz");
+static_assert(!ADC_Module::solvePDB(0).valid, "0 Hz isn't valid");
+
+constexpr ADC_PDBConfig pdb_44k1 = ADC_Module::solvePDB(44100);
+
+// every F_BUS of kinetis.h, for all F_CPU options of Teensy 3.0 to 3.6
+const uint32_t BUS_FREQS[] = {2000000, 4000000, 8000000, 16000000, 24000000, 36000000, 48000000,
+                              54000000, 56000000, 60000000, 64000000, 72000000, 80000000};
+const uint32_t FREQS[] = {1, 7, 100, 1000, 8000, 44100, 48000, 96000, 123457, 1000000};
+
+volatile uint32_t conversions;
+
+void adc0_isr() {
+    adc->adc0->readSingle();
+    conversions++;
+}
+
+void pdb_isr() {
+    PDB0_SC &=~PDB_SC_PDBIF; // clear interrupt
+}
+
+// smallest |bus_freq - freq*period|/(freq*period) of all settings, as a fraction num/den.
+// Settings with more than 100% error are skipped, the closest mod without dividers is always better than them
+void best_error(uint32_t freq, uint32_t bus_freq, uint64_t& num, uint64_t& den) {
+    num = 1;
+    den = 0;
+    for(uint8_t mult = 0; mult < 4; mult++) {
+        for(uint8_t prescaler = 0; prescaler < 8; prescaler++) {
+            const uint32_t divider = (1UL << prescaler) * (mult ? (10UL << (mult - 1)) : 1);
+            for(uint32_t mod = 1; mod <= 65536; mod++) {
+                const uint64_t product = (uint64_t)freq*divider*mod;
+                if(product > 2ULL*bus_freq) { // more than 100% error, larger mods are worse
+                    break;
+                }
+                const uint64_t diff = (product > bus_freq) ? product - bus_freq : bus_freq - product;
+                if((den == 0) || (diff*den < num*product)) {
+                    num = diff;
+                    den = product;
+                }
+            }
+        }
+    }
+}
+
+bool check_bus(uint32_t bus_freq) {
+    bool ok = true;
+    for(uint32_t freq : FREQS) {
+        const ADC_PDBConfig config = ADC_Module::solvePDB(freq, bus_freq);
+        const uint64_t product = (uint64_t)freq*config.mod*(1UL << config.prescaler)*(config.mult ? (10UL << (config.mult - 1)) : 1);
+        const uint64_t diff = (product > bus_freq) ? product - bus_freq : bus_freq - product;
+        uint64_t num, den;
+        best_error(freq, bus_freq, num, den);
+        if(!config.valid || (diff*den != num*product)) {
+            Serial.print("FAIL: ");
+            Serial.print(freq);
+            Serial.println(" Hz");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    bool all_pass = true;
+    for(uint32_t bus_freq : BUS_FREQS) {
+        const bool pass = check_bus(bus_freq);
+        all_pass = all_pass && pass;
+        Serial.print("Bus ");
+        Serial.print(bus_freq/1000000);
+        Serial.print(" MHz, 44.1 kHz: ");
+        Serial.print(ADC_Module::solvePDB(44100, bus_freq).error_ppm);
+        Serial.print(" ppm, 48 kHz: ");
+        Serial.print(ADC_Module::solvePDB(48000, bus_freq).error_ppm);
+        Serial.print(" ppm, check: ");
+        Serial.println(pass ? "PASS" : "FAIL");
+    }
+    #if defined(ADC_HOST_SIM)
+    if(!all_pass) {
+        Serial.flush();
+        exit(1);
+    }
+    #endif
+
+    adc->setAveraging(1, ADC_0);
+    adc->setResolution(12, ADC_0);
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, ADC_0);
+
+    adc->enableInterrupts(ADC_0);
+    adc->adc0->startSingleRead(readPin);
+    if(!adc->adc0->startPDB(pdb_44k1)) {
+        adc->printError();
+    }
+
+    delay(500);
+}
+
+void loop() {
+
+    Serial.print("PDB: ");
+    Serial.print(adc->adc0->getPDBFrequency());
+    Serial.print(" Hz (");
+    Serial.print(pdb_44k1.error_ppm);
+    Serial.print(" ppm), conversions: ");
+    Serial.println(conversions);
+    conversions = 0;
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
@@ -0,0 +1,104 @@
+/* Example for PDBTimebase
+*  Both ADCs convert the same pin, triggered by the PDB counter they share (adc->pdb).
+*  ADC1 is attached half a period after ADC0, so the pin is sampled at twice the frequency of the counter (interleaved).
+*  Every second loop() switches between interleaved and simultaneous sampling (both with delay 0),
+*  and prints the conversions of each ADC and the time from an ADC0 result to the next ADC1 result.
+*  It also compiles for the host simulation (see README). Only for Teensy 3.1, 3.2, 3.5 and 3.6 (two ADCs and PDB).
+*/
+
+#include <ADC.h>
+
+const int readPin = A2; // ADC0 or ADC1
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t FREQ = 10000; // Hz, of each ADC
+
+volatile uint32_t conversions[2];
+volatile uint32_t last_result_cycles[2];
+
+void result_done(const uint16_t* values, uint16_t count, void* ctx) {
+    #if ADC_NUM_ADCS>1 // Teensy 3.x, the others have no cycle counter
+    const uint8_t adc_num = (uintptr_t)ctx;
+    last_result_cycles[adc_num] = ARM_DWT_CYCCNT;
+    conversions[adc_num]++;
+    #endif
+}
+
+bool interleaved = true;
+
+void start() {
+    #if ADC_NUM_ADCS>1
+    adc->pdb->stop(); // detaches both
+    adc->adc0->startSingleRead(readPin); // the pin the PDB converts
+    adc->adc1->startSingleRead(readPin);
+    if(!adc->pdb->start(FREQ)) {
+        Serial.println("Wrong frequency");
+    }
+    adc->pdb->attach(adc->adc0);
+    adc->pdb->attach(adc->adc1, interleaved ? adc->pdb->delayOfPhase(0.5) : 0);
+    #endif
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    #if ADC_NUM_ADCS>1
+    ARM_DEMCR |= ARM_DEMCR_TRCENA; // enable the cycle counter
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
+    for(int8_t i = ADC_0; i <= ADC_1; i++) {
+        adc->setAveraging(1, i);
+        adc->setResolution(12, i);
+        adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, i);
+        adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, i);
+    }
+
+    adc->adc0->onComplete(result_done, (void*)0);
+    adc->adc1->onComplete(result_done, (void*)1);
+    #endif
+
+    start();
+
+    delay(500);
+}
+
+void loop() {
+
+    #if ADC_NUM_ADCS>1
+    __disable_irq(); // the results of the same period
+    const uint32_t count0 = conversions[0];
+    const uint32_t count1 = conversions[1];
+    // the last result of ADC1 can be from the period before, so the time is modulo the period
+    const int32_t period_cycles = F_CPU/FREQ;
+    const int32_t skew_cycles = (((int32_t)(last_result_cycles[1] - last_result_cycles[0]))%period_cycles + period_cycles)%period_cycles;
+    conversions[0] = 0;
+    conversions[1] = 0;
+    __enable_irq();
+
+    Serial.print(interleaved ? "Interleaved, " : "Simultaneous, ");
+    Serial.print("ADC0: ");
+    Serial.print(count0);
+    Serial.print(", ADC1: ");
+    Serial.print(count1);
+    Serial.print(" conversions, ADC1 delay: ");
+    Serial.print(adc->pdb->getDelayNs(adc->pdb->delayOfPhase(interleaved ? 0.5 : 0)));
+    Serial.print(" ns, measured: ");
+    Serial.print(skew_cycles*(1e9/F_CPU), 0);
+    Serial.println(" ns");
+
+    interleaved = !interleaved;
+    start();
+    #endif
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
@@ -0,0 +1,164 @@
+/* Example for submit
+*  ADC0 converts readPin continuously, two timers submit requests for other pins to its queue.
+*  The fast timer has a higher priority than the continuous conversion, so it stops it while its pin is converted,
+*  the slow one has the same priority and waits until the continuous conversion is stopped in loop().
+*  The callbacks are called from the ADC interrupt, the library handles it (see onComplete).
+*  startContinuous can be called while a request is converting: it waits for it, and the requests restore the new conversion.
+*  It also compiles for the host simulation (see README), where each pin has a different voltage: the callbacks check
+*  that they get the value of their pin and loop() that the continuous conversion is restored, it exits with status 1 if not.
+*/
+
+#include <ADC.h>
+#include <IntervalTimer.h>
+
+const int readPin = A9; // ADC0
+const int fastPin = A2; // ADC0
+const int slowPin = A3; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+IntervalTimer fastTimer, slowTimer;
+
+volatile uint16_t fast_value, slow_value;
+volatile uint32_t fast_count, slow_count;
+
+#if defined(ADC_HOST_SIM)
+// input voltages of readPin, fastPin and slowPin (SC1A channels 4, 8 and 9)
+const double READ_V = 1.0, FAST_V = 3.0, SLOW_V = 2.0;
+volatile uint32_t wrong_values = 0;
+
+// the value is within 0.1 V of the pin's voltage
+void check_value(uint16_t value, double voltage) {
+    if(fabs(value*3.3/adc->getMaxValue(ADC_0) - voltage) > 0.1) {
+        wrong_values++;
+    }
+}
+
+// the continuous conversion of readPin is running when the queue is empty
+bool check_continuous() {
+    elapsedMillis waiting;
+    while(adc->adc0->getQueueDepth() && (waiting < 100)) {
+    }
+    if(!adc->adc0->isContinuous() || !adc->adc0->isConverting()) {
+        return false;
+    }
+    while(!adc->adc0->isComplete()) {
+        if(waiting >= 100) {
+            return false;
+        }
+    }
+    const double voltage = adc->analogReadContinuous(ADC_0)*3.3/adc->getMaxValue(ADC_0);
+    return fabs(voltage - READ_V) <= 0.1;
+}
+
+void test_result(const char* name, bool pass) {
+    Serial.print(name); Serial.println(pass ? " PASS" : " FAIL");
+    if(!pass) {
+        Serial.flush();
+        exit(1);
+    }
+}
+#endif
+
+void fast_done(const uint16_t* values, uint16_t count, void* ctx) {
+    fast_value = values[0];
+    fast_count++;
+    #if defined(ADC_HOST_SIM)
+    check_value(values[0], FAST_V);
+    #endif
+}
+
+void slow_done(const uint16_t* values, uint16_t count, void* ctx) {
+    slow_value = values[0];
+    slow_count++;
+    #if defined(ADC_HOST_SIM)
+    check_value(values[0], SLOW_V);
+    #endif
+}
+
+void fast_tick() {
+    adc->submit({fastPin, 0, false, 2, fast_done, nullptr}, ADC_0);
+}
+
+void slow_tick() {
+    adc->submit({slowPin, 0, false, 1, slow_done, nullptr}, ADC_0);
+}
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+    pinMode(fastPin, INPUT);
+    pinMode(slowPin, INPUT);
+
+    Serial.begin(9600);
+
+    #if defined(ADC_HOST_SIM)
+    ADC_HostSim::adc0().voltage[4] = READ_V;
+    ADC_HostSim::adc0().voltage[8] = FAST_V;
+    ADC_HostSim::adc0().voltage[9] = SLOW_V;
+    #endif
+
+    adc->setAveraging(4, ADC_0);
+    adc->setResolution(12, ADC_0);
+
+    adc->adc0->setContinuousPriority(1); // only the fast requests stop the continuous conversion
+
+    #if defined(ADC_HOST_SIM)
+    // start the continuous conversion while a request is converting
+    adc->submit({fastPin, 0, false, 2, fast_done, nullptr}, ADC_0);
+    adc->startContinuous(readPin, ADC_0);
+    test_result("START DURING REQUEST TEST", check_continuous() && (fast_count == 1) && (wrong_values == 0));
+    #else
+    adc->startContinuous(readPin, ADC_0);
+    #endif
+
+    fastTimer.begin(fast_tick, 1000); // us
+    slowTimer.begin(slow_tick, 200000);
+
+    delay(500);
+}
+
+void loop() {
+
+    Serial.print("Continuous: ");
+    Serial.print(adc->analogReadContinuous(ADC_0)*3.3/adc->getMaxValue(ADC_0), 3);
+    Serial.print(" V, fast: ");
+    Serial.print(fast_value*3.3/adc->getMaxValue(ADC_0), 3);
+    Serial.print(" V (");
+    Serial.print(fast_count);
+    Serial.print("), slow: ");
+    Serial.print(slow_value*3.3/adc->getMaxValue(ADC_0), 3);
+    Serial.print(" V (");
+    Serial.print(slow_count);
+    Serial.println(")");
+
+    // the slow requests are converted now
+    adc->stopContinuous(ADC_0);
+    delay(50);
+    adc->startContinuous(readPin, ADC_0);
+
+    ADC_QueueStats stats = adc->adc0->getQueueStats();
+    Serial.print("Completed: ");
+    Serial.print(stats.completed);
+    Serial.print(", rejected: ");
+    Serial.print(stats.rejected);
+    Serial.print(", max depth: ");
+    Serial.print(stats.max_depth);
+    Serial.print(", mean wait: ");
+    Serial.print(stats.completed ? (float)stats.total_wait_us/stats.completed : 0.0f, 1);
+    Serial.print(" us, max wait: ");
+    Serial.print(stats.max_wait_us);
+    Serial.println(" us");
+
+    #if defined(ADC_HOST_SIM)
+    test_result("QUEUE TEST", check_continuous() && (slow_count > 0) && (wrong_values == 0));
+    #endif
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
@@ -5,7 +5,10 @@ const int readPin = A9;
 
 ADC *adc = new ADC(); // adc object
 
-RingBuffer *buffer = new RingBuffer;
+// buffer of 16 uint16_t values, the size must be a power of 2
+ADC_Buffer::RingBuffer<uint16_t, 16> *buffer = new ADC_Buffer::RingBuffer<uint16_t, 16>;
+// the old buffer of 8 ints is still available as:
+//RingBuffer *buffer = new RingBuffer;
 
 
 void setup() {
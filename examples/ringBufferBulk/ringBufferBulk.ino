@@ -0,0 +1,96 @@
+/* Compare the time it takes to move samples through a RingBuffer one by one
+*  with the bulk functions writeBulk, readBulk and peekContiguous/consume.
+*  No ADC conversions are done, the buffer is filled with fake samples.
+*  In the host simulation micros() only advances with register accesses and delay(), so build it with
+*  ADC_HOST_SIM_REAL_TIME defined to measure the time the code takes (see README).
+*/
+
+#include "RingBuffer.h"
+
+const uint32_t BUFFER_SIZE = 1024; // must be a power of 2
+const uint32_t BLOCK = 1000; // samples written and read each round
+const uint32_t ROUNDS = 1000;
+
+ADC_Buffer::RingBuffer<uint16_t, BUFFER_SIZE> *buffer = new ADC_Buffer::RingBuffer<uint16_t, BUFFER_SIZE>;
+
+uint16_t samples[BLOCK]; // fake samples
+uint16_t values[BLOCK]; // samples read from the buffer
+
+volatile uint32_t sum = 0; // so the compiler doesn't remove the reads
+
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+
+    Serial.begin(9600);
+    delay(1000);
+
+    for(uint32_t i=0; i<BLOCK; i++) {
+        samples[i] = i;
+    }
+}
+
+// print the time per sample and the samples per second
+void printResult(const char* name, uint32_t time_us) {
+    Serial.print(name);
+    Serial.print(": ");
+    if(time_us == 0) { // host simulation without ADC_HOST_SIM_REAL_TIME
+        Serial.println("too fast to measure");
+        return;
+    }
+    Serial.print(1000.0*time_us/(ROUNDS*BLOCK));
+    Serial.print(" ns/sample, ");
+    Serial.print((float)ROUNDS*BLOCK/time_us);
+    Serial.println(" Msamples/s");
+}
+
+void loop() {
+
+    uint32_t t;
+
+    // one sample per call
+    t = micros();
+    for(uint32_t r=0; r<ROUNDS; r++) {
+        for(uint32_t i=0; i<BLOCK; i++) {
+            buffer->write(samples[i]);
+        }
+        uint32_t n = 0;
+        while(!buffer->isEmpty()) {
+            values[n++] = buffer->read();
+        }
+        sum += values[r%BLOCK];
+    }
+    printResult("write/read", micros() - t);
+
+    // copy blocks
+    t = micros();
+    for(uint32_t r=0; r<ROUNDS; r++) {
+        buffer->writeBulk(samples, BLOCK);
+        buffer->readBulk(values, BLOCK);
+        sum += values[r%BLOCK];
+    }
+    printResult("writeBulk/readBulk", micros() - t);
+
+    // process the samples in place, without copying them out of the buffer
+    t = micros();
+    for(uint32_t r=0; r<ROUNDS; r++) {
+        buffer->writeBulk(samples, BLOCK);
+        ADC_Buffer::Spans<const uint16_t> spans = buffer->peekContiguous();
+        uint32_t partial = 0;
+        for(uint32_t i=0; i<spans.first.length; i++) {
+            partial += spans.first.data[i];
+        }
+        for(uint32_t i=0; i<spans.second.length; i++) {
+            partial += spans.second.data[i];
+        }
+        buffer->consume(spans.length());
+        sum += partial;
+    }
+    printResult("peekContiguous/consume", micros() - t);
+
+    Serial.println();
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(2000);
+}
@@ -12,10 +12,10 @@ ADC *adc = new ADC(); // adc object
 
 // Define the array that holds the conversions here.
 // buffer_size must be a power of two.
-// The buffer is stored with the correct alignment in the DMAMEM section
+// The buffer is stored with the correct alignment (its size in bytes) in the DMAMEM section
 // the +0 in the aligned attribute is necessary b/c of a bug in gcc.
 const uint8_t buffer_size = 8;
-DMAMEM static volatile int16_t __attribute__((aligned(buffer_size+0))) buffer[buffer_size];
+DMAMEM static volatile int16_t __attribute__((aligned(2*buffer_size+0))) buffer[buffer_size];
 
 // use dma with ADC0
 RingBufferDMA *dmaBuffer = new RingBufferDMA(buffer, buffer_size, ADC_0);
@@ -90,8 +90,8 @@ void loop() {
 void dmaBuffer_isr() {
     //digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
     Serial.println("dmaBuffer_isr");
-    // update the internal buffer positions
-    dmaBuffer->dmaChannel->clearInterrupt();
+    // update the internal buffer positions and clear the interrupt
+    dmaBuffer->write();
 }
 
 
@@ -0,0 +1,77 @@
+/* Continuous conversions stored by DMA in a ping-pong buffer.
+*  Each time DMA fills one half of the buffer dmaBuffer_isr gets it and computes its average,
+*  while DMA keeps writing the other half. No values are copied.
+*  A GapDetector counts the values lost because the isr was too late and DMA overwrote a block before it was read.
+*   Not for Teensy LC, its DMA doesn't interrupt at the half of the buffer.
+*/
+
+#include "ADC.h"
+#include "RingBufferDMA.h"
+
+const int readPin = A9;
+
+ADC *adc = new ADC(); // adc object
+
+// Define the array that holds the conversions here.
+// buffer_size must be a power of two, each half has buffer_size/2 values.
+// The buffer is stored with the correct alignment (its size in bytes) in the DMAMEM section
+// the +0 in the aligned attribute is necessary b/c of a bug in gcc.
+const uint16_t buffer_size = 512;
+DMAMEM static volatile int16_t __attribute__((aligned(2*buffer_size+0))) buffer[buffer_size];
+
+// use dma with ADC0
+RingBufferDMA *dmaBuffer = new RingBufferDMA(buffer, buffer_size, ADC_0);
+
+// results of the last block, written in the isr
+volatile uint32_t blockAverage = 0;
+volatile uint32_t blockSequence = 0;
+
+ADC_Buffer::GapDetector gaps;
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    adc->setAveraging(1); // set number of averages
+    adc->setResolution(12); // set bits of resolution
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+
+    // enable DMA
+    adc->enableDMA(ADC_0);
+
+    if(!dmaBuffer->startPingPong(&dmaBuffer_isr)) {
+        Serial.println("Ping-pong mode not available, check buffer_size");
+    }
+
+    adc->startContinuous(readPin, ADC_0);
+}
+
+void loop() {
+
+    Serial.print("Block ");
+    Serial.print(blockSequence);
+    Serial.print(", average: ");
+    Serial.print(blockAverage*3.3/adc->getMaxValue(ADC_0), 4);
+    Serial.print(" V, values lost: ");
+    Serial.println(gaps.getDropped());
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+    delay(500);
+}
+
+// called when DMA has filled one half of the buffer
+void dmaBuffer_isr() {
+    RingBufferDMA::Block block = dmaBuffer->finishedBlock();
+    gaps.check(block.first, block.length, block.timestamp, block.stamp_index);
+
+    uint32_t sum = 0;
+    for(uint16_t i = 0; i < block.length; i++) {
+        sum += block.data[i];
+    }
+    blockAverage = sum/block.length;
+    blockSequence = block.sequence;
+}
@@ -0,0 +1,62 @@
+/* Example for ScanDMA
+*  ADC0 converts A0, A1, A2 and A3 round-robin as fast as it can, DMA stores the results
+*  and starts the next conversion, no isr is called.
+*  loop() prints the last 8 frames every second.
+*   It doesn't work for Teensy LC yet!
+*/
+
+#include "ADC.h"
+#include "ScanDMA.h"
+
+ADC *adc = new ADC(); // adc object
+
+// all pins must use the same mux of the ADC, ScanDMA::start returns false otherwise
+#define PINS 4
+const uint8_t scan_pins[PINS] = {A0, A1, A2, A3};
+
+// results: scan_values[frame*PINS + i] is the value of scan_pins[i]
+#define FRAMES 8
+DMAMEM static volatile uint16_t scan_values[PINS*FRAMES];
+
+ScanDMA *scan = new ScanDMA(adc->adc0, scan_values, FRAMES);
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+
+    for (int i=0;i<PINS;i++) {
+        pinMode(scan_pins[i], INPUT);
+    }
+
+    Serial.begin(9600);
+
+    adc->setAveraging(4, ADC_0); // set number of averages
+    adc->setResolution(12, ADC_0); // set bits of resolution
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, ADC_0);
+
+    delay(500);
+
+    if(!scan->start(scan_pins, PINS)) {
+        Serial.println("Wrong pins");
+        adc->printError();
+    }
+}
+
+void loop() {
+
+    Serial.print("DMA position: ");
+    Serial.println(scan->position());
+
+    for(int frame=0; frame<FRAMES; frame++) {
+        for(int i=0; i<PINS; i++) {
+            Serial.print(scan_values[frame*PINS + i]*3.3/adc->getMaxValue(ADC_0), 2);
+            Serial.print(". ");
+        }
+        Serial.println();
+    }
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
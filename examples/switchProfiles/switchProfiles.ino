@@ -0,0 +1,111 @@
+/* Example for saveProfile and applyProfile
+*  ADC0 alternates between a precise profile (16 bits, 32 averages, low speed) and a fast one (8 bits, no averages, very high speed).
+*  Each profile is configured and calibrated once in setup, after that applyProfile only writes the registers.
+*  The time it takes is compared to calling the setters, which keep the calibration of the fast profile.
+*  A third profile, fast with a compare function, shares the calibration of the fast one, so switching between them
+*  doesn't write the calibration again. It also compiles for the host simulation (see README).
+*/
+
+#include <ADC.h>
+
+const int readPin = A9; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+ADC_Module::ADC_Profile precise, fast, fast_compare;
+
+const uint32_t NUM_SWITCHES = 100;
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    adc->setResolution(16, ADC_0);
+    adc->setAveraging(32, ADC_0);
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::LOW_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::LOW_SPEED, ADC_0);
+    adc->adc0->recalibrate(); // calibrate with these settings
+    adc->saveProfile(&precise, ADC_0);
+
+    adc->setResolution(8, ADC_0);
+    adc->setAveraging(1, ADC_0);
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::VERY_HIGH_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::VERY_HIGH_SPEED, ADC_0);
+    adc->adc0->recalibrate();
+    adc->saveProfile(&fast, ADC_0);
+
+    // the same calibration, only conversions above half the range complete
+    adc->enableCompare(adc->getMaxValue(ADC_0)/2, 1, ADC_0);
+    adc->saveProfile(&fast_compare, ADC_0);
+    adc->disableCompare(ADC_0);
+
+    Serial.print("Precise profile calibrated: ");
+    Serial.println(precise.isCalibrated());
+    Serial.print("Fast profile calibrated: ");
+    Serial.println(fast.isCalibrated());
+
+    delay(500);
+}
+
+void loop() {
+
+    // the usual way: each setter checks the calibration and writes its registers
+    uint32_t t = micros();
+    for(uint32_t i = 0; i < NUM_SWITCHES; i++) {
+        adc->setResolution(16, ADC_0);
+        adc->setAveraging(32, ADC_0);
+        adc->setConversionSpeed(ADC_CONVERSION_SPEED::LOW_SPEED, ADC_0);
+        adc->setSamplingSpeed(ADC_SAMPLING_SPEED::LOW_SPEED, ADC_0);
+
+        adc->setResolution(8, ADC_0);
+        adc->setAveraging(1, ADC_0);
+        adc->setConversionSpeed(ADC_CONVERSION_SPEED::VERY_HIGH_SPEED, ADC_0);
+        adc->setSamplingSpeed(ADC_SAMPLING_SPEED::VERY_HIGH_SPEED, ADC_0);
+    }
+    t = micros() - t;
+    Serial.print("Setters: ");
+    Serial.print((float)t/(2*NUM_SWITCHES), 3);
+    Serial.println(" us/switch");
+
+    // the profiles also restore the calibration of each one
+    t = micros();
+    for(uint32_t i = 0; i < NUM_SWITCHES; i++) {
+        adc->applyProfile(precise, ADC_0);
+        adc->applyProfile(fast, ADC_0);
+    }
+    t = micros() - t;
+    Serial.print("applyProfile: ");
+    Serial.print((float)t/(2*NUM_SWITCHES), 3);
+    Serial.println(" us/switch");
+
+    // the calibration is loaded already
+    t = micros();
+    for(uint32_t i = 0; i < NUM_SWITCHES; i++) {
+        adc->applyProfile(fast_compare, ADC_0);
+        adc->applyProfile(fast, ADC_0);
+    }
+    t = micros() - t;
+    Serial.print("applyProfile, same calibration: ");
+    Serial.print((float)t/(2*NUM_SWITCHES), 3);
+    Serial.println(" us/switch");
+
+    adc->applyProfile(precise, ADC_0);
+    int value = adc->analogRead(readPin, ADC_0);
+    Serial.print("Precise value: ");
+    Serial.println(value*3.3/adc->getMaxValue(ADC_0), DEC);
+
+    adc->applyProfile(fast, ADC_0);
+    value = adc->analogRead(readPin, ADC_0);
+    Serial.print("Fast value: ");
+    Serial.println(value*3.3/adc->getMaxValue(ADC_0), DEC);
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
@@ -0,0 +1,70 @@
+/* Example for SyncDMA
+*  The PDB triggers ADC0 (A9) and ADC1 (A2) at the same time FREQ times per second,
+*  DMA stores each pair of values in a frame of the buffer, no isr is called for the conversions.
+*  loop() prints the last frames, the number of frames and the skew between the ADCs every second.
+*  Only for Teensy 3.1, 3.2, 3.5 and 3.6 (two ADCs and PDB).
+*/
+
+#include <ADC.h>
+#include <SyncDMA.h>
+
+const int readPin0 = A9; // ADC0
+const int readPin1 = A2; // ADC1
+
+ADC *adc = new ADC(); // adc object
+
+#define FRAMES 256
+DMAMEM static volatile SyncDMA::Frame frames[FRAMES];
+
+SyncDMA *stream = new SyncDMA(adc, frames, FRAMES);
+
+const uint32_t FREQ = 50000; // Hz
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin0, INPUT);
+    pinMode(readPin1, INPUT);
+
+    Serial.begin(9600);
+
+    // both ADCs with the same settings, so that they finish at the same time
+    for(int8_t i = ADC_0; i <= ADC_1; i++) {
+        adc->setAveraging(1, i);
+        adc->setResolution(12, i);
+        adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, i);
+        adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, i);
+    }
+
+    delay(500);
+
+    if(!stream->start(readPin0, readPin1, FREQ)) {
+        Serial.println("Wrong pins or frequency too high");
+        adc->printError();
+    }
+}
+
+void loop() {
+
+    const uint32_t count = stream->frameCount();
+    Serial.print("Frames: ");
+    Serial.print(count);
+    Serial.print(", skew: ");
+    Serial.println(stream->getSkew());
+
+    // the last 4 complete frames
+    for(uint32_t i = 4; i > 0; i--) {
+        const uint32_t index = (count - i)%FRAMES;
+        Serial.print(frames[index].result_adc0*3.3/adc->getMaxValue(ADC_0), 3);
+        Serial.print(" V, ");
+        Serial.print(frames[index].result_adc1*3.3/adc->getMaxValue(ADC_1), 3);
+        Serial.println(" V");
+    }
+
+    adc->printError();
+    adc->resetError();
+
+    digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+
+    delay(1000);
+}
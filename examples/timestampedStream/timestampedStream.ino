@@ -0,0 +1,131 @@
+/* Timestamped stream of conversions with gap detection
+*  The PDB triggers ADC0 FREQ times per second, adc0_isr stores each value with its time (cycle counter, micros() on Teensy LC)
+*  and its sequence number in a RingBufferSPSC, and loop() checks the stream with a GapDetector.
+*  The compare function only completes the conversions above 1/4 of the range, so while the pin is below it
+*  the isr isn't called and those samples are skipped: the sequence numbers don't show it, the timestamps do.
+*  If loop() doesn't read the buffer fast enough the values are dropped: that leaves a hole in the sequence numbers.
+*  Every second loop() prints the samples received in that second, and the samples dropped and skipped and the gaps since the start.
+*  It also compiles for the host simulation (see README), where the pin has a 2 Hz sine wave that is below 1/4 of the range
+*  a third of the time: loop() checks that those samples are skipped and none is dropped, and exits with status 1 if not.
+*  Not for Teensy LC (no PDB).
+*/
+
+#include <ADC.h>
+#include <RingBuffer.h>
+
+const int readPin = A9; // ADC0
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t FREQ = 10000; // Hz
+
+ADC_Buffer::RingBufferSPSC<ADC_Buffer::Stamped<uint16_t>, 1024> *buffer = new ADC_Buffer::RingBufferSPSC<ADC_Buffer::Stamped<uint16_t>, 1024>;
+
+ADC_Buffer::GapDetector gaps;
+
+volatile uint32_t sequence = 0;
+
+#if defined(KINETISL) // no DWT on Cortex-M0+
+const uint32_t TIMESTAMP_FREQ = 1000000; // Hz
+uint32_t timestamp() {
+    return micros();
+}
+#else
+const uint32_t TIMESTAMP_FREQ = F_CPU; // Hz
+uint32_t timestamp() {
+    return ARM_DWT_CYCCNT;
+}
+#endif
+
+void adc0_isr() {
+    ADC_Buffer::Stamped<uint16_t> sample;
+    sample.value = adc->adc0->readSingle();
+    sample.timestamp = timestamp();
+    sample.sequence = sequence++; // also when the buffer is full
+    buffer->write(sample);
+}
+
+uint32_t received = 0;
+elapsedMillis since_print;
+
+#if defined(ADC_HOST_SIM)
+// 2 Hz sine wave from 0.05 V to 3.25 V
+double sine_input(uint8_t adc_num, uint8_t channel, bool differential, uint64_t time_ps) {
+    return 1.65 + 1.6*sin(2*M_PI*2*(time_ps*1e-12));
+}
+#endif
+
+void setup() {
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(readPin, INPUT);
+
+    Serial.begin(9600);
+
+    #if defined(ADC_HOST_SIM)
+    ADC_HostSim::adc0().input = sine_input;
+    #endif
+
+    #if !defined(KINETISL)
+    ARM_DEMCR |= ARM_DEMCR_TRCENA; // enable the cycle counter
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+    #endif
+
+    adc->setAveraging(1, ADC_0);
+    adc->setResolution(12, ADC_0);
+    adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED, ADC_0);
+    adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED, ADC_0);
+
+    // only conversions >= 1/4 of the range complete
+    adc->enableCompare(adc->getMaxValue(ADC_0)/4, 1, ADC_0);
+
+    gaps.setRate(FREQ, TIMESTAMP_FREQ);
+
+    adc->enableInterrupts(ADC_0);
+    adc->adc0->startSingleRead(readPin); // the pin the PDB converts
+    if(!adc->adc0->startPDB(FREQ)) {
+        Serial.println("Wrong frequency");
+        adc->printError();
+    }
+}
+
+void loop() {
+
+    ADC_Buffer::Stamped<uint16_t> sample;
+    while(buffer->read(sample)) {
+        received++;
+        if(gaps.check(sample)) {
+            // the samples before this one are missing, resample or flag the dropout here
+        }
+    }
+
+    if(since_print >= 1000) {
+        since_print = 0;
+
+        Serial.print("Received: ");
+        Serial.print(received);
+        Serial.print(", dropped: ");
+        Serial.print(gaps.getDropped());
+        Serial.print(", skipped: ");
+        Serial.print(gaps.getSkipped());
+        Serial.print(", gaps: ");
+        Serial.println(gaps.getGaps());
+        received = 0;
+
+        #if defined(ADC_HOST_SIM)
+        const bool gap_test = (gaps.getSkipped() > 0) && (gaps.getDropped() == 0);
+        Serial.print("GAP TEST "); Serial.println(gap_test ? "PASS" : "FAIL");
+        if(!gap_test) {
+            Serial.flush();
+            exit(1);
+        }
+        #endif
+
+        adc->printError();
+        adc->resetError();
+
+        digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+    }
+
+    delay(10); // 100 samples each time, the buffer has room for 1024
+}
@@ -0,0 +1,830 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* ADC_HostSim.cpp: Simulated ADC, PDB and VREF peripherals and the Arduino functions of host/Arduino.h
+*
+*/
+
+#if defined(ADC_HOST_SIM)
+
+#include "Arduino.h"
+#include "ADC.h" // for the pin to channel tables
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#if defined(ADC_HOST_SIM_REAL_TIME)
+#include <time.h>
+#endif
+
+// ADC cycles of a conversion, from the "conversion time" section of the reference manual
+namespace {
+    // base conversion time, for single-ended and differential conversions
+    // indexed by CFG1[MODE]: 8 (9) bits, 12 (13) bits, 10 (11) bits and 16 bits
+    const uint8_t BCT_SINGLE[4] = {17, 20, 20, 25};
+    const uint8_t BCT_DIFF[4] = {27, 30, 30, 34};
+    const uint8_t BITS_SINGLE[4] = {8, 12, 10, 16};
+    const uint8_t BITS_DIFF[4] = {9, 13, 11, 16};
+    // long sample time adder, indexed by CFG2[ADLSTS]
+    const uint8_t LST_ADDER[4] = {20, 12, 6, 2};
+    // asynchronous clock frequency in Hz, indexed by CFG1[ADLPC]*2 + CFG2[ADHSC]
+    const double ADACK_HZ[4] = {5.2e6, 6.2e6, 2.4e6, 4.0e6};
+    // alternate clock (OSCERCLK)
+    const double ALTCLK_HZ = 16e6;
+
+    // reset values of the calibration registers, CLPD, CLPS, CLP4, ... CLP0 (CLMx are the same)
+    const uint16_t CL_RESET[7] = {0x0A, 0x20, 0x200, 0x100, 0x80, 0x40, 0x20};
+
+    // default channel voltages of the internal sources
+    const double V_DEFAULT = 1.65;
+    const double V_VREF_OUT = 1.195;
+    const double V_TEMP_SENSOR = 0.719;
+    const double V_BANDGAP = 1.0;
+
+    const uint64_t PS_PER_S = 1000000000000ULL;
+
+    const uint8_t NUM_TIMERS = 4;
+
+    // simulation state, all zero-initialized so it's ready before any constructor runs
+    uint64_t time_ps;
+    bool irq_masked;
+    bool in_isr;
+    uint32_t num_pending;
+    bool irq_enabled[ADC_HostSim::NUM_IRQS];
+    bool irq_pending[ADC_HostSim::NUM_IRQS];
+    void (*vectors[ADC_HostSim::NUM_IRQS])(void);
+
+    struct Timer {
+        void (*function)(void);
+        uint64_t period, next;
+        bool pending;
+    };
+    Timer timers[NUM_TIMERS];
+
+    uint8_t pin_state[64];
+    uint8_t pin_mode[64];
+
+    // default interrupt function of an irq
+    void (*defaultVector(uint8_t irq))(void) {
+        switch(irq) {
+            case IRQ_ADC0: return adc0_isr;
+            case IRQ_ADC1: return adc1_isr;
+            case IRQ_PDB: return pdb_isr;
+            default: return nullptr;
+        }
+    }
+
+    uint64_t min(uint64_t a, uint64_t b) {
+        return a < b ? a : b;
+    }
+
+    // pin with a pullup or pulldown connected to the channel of the ADC, or -1
+    int8_t pulledPin(uint8_t adc_num, uint8_t channel, bool mux_a) {
+        for(uint8_t pin = 0; pin <= ADC_MAX_PIN; pin++) {
+            if(pin_mode[pin] != INPUT_PULLUP && pin_mode[pin] != INPUT_PULLDOWN) continue;
+            const uint8_t sc1a = ADC::getSC1A(pin, adc_num);
+            if((sc1a & ADC_SC1A_CHANNELS) != channel) continue;
+            // channels 4 to 7 have a and b pins, selected by CFG2[MUXSEL]
+            if(channel >= 4 && channel <= 7 && (bool)(sc1a & ADC_SC1A_PIN_MUX) != mux_a) continue;
+            return pin;
+        }
+        return -1;
+    }
+
+    #if defined(ADC_HOST_SIM_REAL_TIME)
+    // host time in ps
+    uint64_t realTime() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec*PS_PER_S + (uint64_t)ts.tv_nsec*1000;
+    }
+    #endif
+}
+
+extern "C" {
+    __attribute__((weak)) void adc0_isr(void) {}
+    __attribute__((weak)) void adc1_isr(void) {}
+    __attribute__((weak)) void pdb_isr(void) {}
+}
+
+namespace ADC_HostSim
+{
+    volatile uint32_t sim_scgc3, sim_scgc6;
+    volatile uint8_t vref_trm, pmc_regsc;
+    volatile uint32_t arm_demcr, arm_dwt_ctrl;
+
+    ADCModel& adc0() {
+        static ADCModel adc(0, IRQ_ADC0);
+        return adc;
+    }
+    ADCModel& adc1() {
+        static ADCModel adc(1, IRQ_ADC1);
+        return adc;
+    }
+    PDBModel& pdb0() {
+        static PDBModel pdb;
+        return pdb;
+    }
+    VREFModel& vref() {
+        static VREFModel vref_model;
+        return vref_model;
+    }
+
+
+    //////// Registers
+
+    Register::operator uint32_t() const {
+        busCycles(1);
+        return owner ? owner->read(*this, id) : value;
+    }
+
+    Register& Register::operator=(uint32_t new_value) {
+        busCycles(1);
+        if(owner) {
+            owner->write(*this, id, new_value);
+        } else {
+            value = new_value;
+        }
+        return *this;
+    }
+
+
+    //////// Time and interrupts
+
+    uint64_t now() {
+        return time_ps;
+    }
+
+    uint64_t busCycle() {
+        return PS_PER_S/F_BUS;
+    }
+
+    // run the pending interrupts, one at a time and never nested
+    static void runInterrupts() {
+        if(irq_masked || in_isr) {
+            return;
+        }
+        bool done = false;
+        while(!done) {
+            done = true;
+            if(num_pending) {
+                for(uint8_t irq = 0; irq < NUM_IRQS; irq++) {
+                    if(!irq_pending[irq] || !irq_enabled[irq]) continue;
+                    irq_pending[irq] = false;
+                    num_pending--;
+                    void (*function)(void) = vectors[irq] ? vectors[irq] : defaultVector(irq);
+                    if(function) {
+                        in_isr = true;
+                        function();
+                        in_isr = false;
+                    }
+                    done = false;
+                }
+            }
+            for(uint8_t i = 0; i < NUM_TIMERS; i++) {
+                if(!timers[i].pending) continue;
+                timers[i].pending = false;
+                in_isr = true;
+                timers[i].function();
+                in_isr = false;
+                done = false;
+            }
+        }
+    }
+
+    void advance(uint64_t ps) {
+        #if defined(ADC_HOST_SIM_REAL_TIME)
+        // the code between calls takes the time it took to run on the host
+        static uint64_t last_real_time = 0;
+        const uint64_t real_time = realTime();
+        if(last_real_time && real_time - last_real_time > ps) {
+            ps = real_time - last_real_time;
+        }
+        last_real_time = real_time;
+        #endif
+        const uint64_t target = time_ps + ps;
+        Peripheral* const peripherals[] = {&adc0(), &adc1(), &pdb0()};
+
+        while(true) {
+            uint64_t next = Peripheral::NO_EVENT;
+            for(Peripheral* p : peripherals) {
+                next = min(next, p->nextEvent());
+            }
+            for(uint8_t i = 0; i < NUM_TIMERS; i++) {
+                if(timers[i].function) next = min(next, timers[i].next);
+            }
+            if(next > target) {
+                break;
+            }
+            if(next > time_ps) {
+                time_ps = next;
+            }
+            for(Peripheral* p : peripherals) {
+                p->runEvents();
+            }
+            for(uint8_t i = 0; i < NUM_TIMERS; i++) {
+                if(!timers[i].function) continue;
+                while(timers[i].next <= time_ps) {
+                    timers[i].pending = true;
+                    timers[i].next += timers[i].period;
+                }
+            }
+            runInterrupts();
+        }
+        // interrupts run from the loop above can take us past target
+        if(target > time_ps) {
+            time_ps = target;
+        }
+        runInterrupts();
+    }
+
+    uint32_t cpuCycles() {
+        return (uint32_t)(now()/(PS_PER_S/F_CPU));
+    }
+
+    void busCycles(uint32_t cycles) {
+        advance(cycles*busCycle());
+    }
+
+    void disableIrq() {
+        irq_masked = true;
+    }
+
+    void enableIrq() {
+        irq_masked = false;
+        runInterrupts();
+    }
+
+    bool irqMasked() {
+        return irq_masked;
+    }
+
+    void enableInterrupt(uint8_t irq) {
+        irq_enabled[irq] = true;
+        runInterrupts();
+    }
+
+    void disableInterrupt(uint8_t irq) {
+        irq_enabled[irq] = false;
+    }
+
+    void setPending(uint8_t irq) {
+        if(!irq_pending[irq]) {
+            irq_pending[irq] = true;
+            num_pending++;
+        }
+    }
+
+    void setVector(uint8_t irq, void (*function)(void)) {
+        vectors[irq] = function;
+    }
+
+    int8_t startTimer(void (*function)(void), uint64_t period_ps) {
+        for(uint8_t i = 0; i < NUM_TIMERS; i++) {
+            if(timers[i].function) continue;
+            timers[i].function = function;
+            timers[i].period = period_ps;
+            timers[i].next = time_ps + period_ps;
+            timers[i].pending = false;
+            return i;
+        }
+        return -1;
+    }
+
+    void stopTimer(int8_t id) {
+        timers[id].function = nullptr;
+        timers[id].pending = false;
+    }
+
+
+    //////// ADC
+
+    ADCModel::ADCModel(uint8_t adc_num, uint8_t irq) :
+            input(nullptr), num_conversions(0), num_calibrations(0),
+            ADC_num(adc_num), IRQ_ADC(irq),
+            converting(false), converting_sc1n(0), conversion_end(0),
+            calibrating(false), calibration_end(0) {
+
+        for(uint8_t i = 0; i < NUM_REGS; i++) {
+            regs[i].attach(this, i);
+        }
+        // reset values
+        regs[SC1A].value = ADC_SC1_ADCH(31);
+        regs[SC1B].value = ADC_SC1_ADCH(31);
+        regs[OFS].value = 0x4;
+        regs[PG].value = 0x8200;
+        regs[MG].value = 0x8200;
+        for(uint8_t i = 0; i < 7; i++) {
+            regs[CLPD + i].value = CL_RESET[i];
+            regs[CLMD + i].value = CL_RESET[i];
+        }
+
+        for(uint8_t ch = 0; ch < 32; ch++) {
+            voltage[ch] = V_DEFAULT;
+        }
+        voltage[22] = V_VREF_OUT;
+        voltage[26] = V_TEMP_SENSOR;
+        voltage[27] = V_BANDGAP;
+        voltage[30] = 0; // VREFL
+    }
+
+    uint32_t ADCModel::read(const Register& reg, uint8_t id) {
+        switch(id) {
+            case SC2:
+                return reg.value | ((converting || calibrating) ? ADC_SC2_ADACT : 0);
+            case RA:
+            case RB: // reading the result clears COCO
+                regs[id - RA + SC1A].value &= ~ADC_SC1_COCO;
+                return reg.value;
+            default:
+                return reg.value;
+        }
+    }
+
+    void ADCModel::write(Register& reg, uint8_t id, uint32_t new_value) {
+        // writing any register other than SC3 aborts the calibration
+        if(calibrating && id != SC3) {
+            calibrating = false;
+            regs[SC3].value = (regs[SC3].value & ~ADC_SC3_CAL) | ADC_SC3_CALF;
+        }
+        switch(id) {
+            case SC1A:
+            case SC1B:
+                reg.value = new_value & ~ADC_SC1_COCO; // writing SC1n clears COCO
+                if(id == SC1B) {
+                    return;
+                }
+                // writing SC1A aborts the current conversion
+                converting = false;
+                // and starts a new one with software trigger
+                if((new_value & ADC_SC1_ADCH(31)) != ADC_SC1_ADCH(31) && !(regs[SC2].value & ADC_SC2_ADTRG)) {
+                    startConversion(0, true);
+                }
+                return;
+            case SC2:
+                reg.value = new_value & ~ADC_SC2_ADACT; // read only
+                return;
+            case SC3: {
+                // CALF is cleared by writing a 1, CAL can't be cleared during a calibration
+                const uint32_t calf = (new_value & ADC_SC3_CALF) ? 0 : (reg.value & ADC_SC3_CALF);
+                reg.value = (new_value & ~(ADC_SC3_CAL | ADC_SC3_CALF)) | calf;
+                if(!calibrating && (new_value & ADC_SC3_CAL)) {
+                    converting = false;
+                    calibrating = true;
+                    // the calibration converts the plus and minus side registers with the current settings
+                    calibration_end = now() + 14*conversionTime(true);
+                }
+                if(calibrating) {
+                    reg.value |= ADC_SC3_CAL;
+                }
+                return;
+            }
+            case RA:
+            case RB:
+                return; // read only
+            default:
+                reg.value = new_value;
+                return;
+        }
+    }
+
+    uint64_t ADCModel::conversionTime(bool first) {
+        const uint32_t cfg1 = regs[CFG1].value;
+        const uint32_t cfg2 = regs[CFG2].value;
+        const uint32_t sc3 = regs[SC3].value;
+        const bool diff = regs[converting_sc1n].value & ADC_SC1_DIFF;
+
+        const uint8_t adiclk = cfg1 & ADC_CFG1_ADICLK(3);
+        double adck_hz;
+        switch(adiclk) {
+            case 0: adck_hz = F_BUS; break;
+            case 1: adck_hz = F_BUS/2.0; break;
+            case 2: adck_hz = ALTCLK_HZ; break;
+            default: adck_hz = ADACK_HZ[((cfg1 & ADC_CFG1_ADLPC) ? 2 : 0) + ((cfg2 & ADC_CFG2_ADHSC) ? 1 : 0)]; break;
+        }
+        adck_hz /= 1 << ((cfg1 >> 5) & 3); // ADIV
+        const double adck_ps = PS_PER_S/adck_hz;
+
+        const uint8_t mode = (cfg1 >> 2) & 3;
+        const uint32_t bct = diff ? BCT_DIFF[mode] : BCT_SINGLE[mode];
+        const uint32_t lst = (cfg1 & ADC_CFG1_ADLSMP) ? LST_ADDER[cfg2 & ADC_CFG2_ADLSTS(3)] : 0;
+        const uint32_t hsc = (cfg2 & ADC_CFG2_ADHSC) ? 2 : 0;
+        const uint32_t averages = (sc3 & ADC_SC3_AVGE) ? (4 << (sc3 & ADC_SC3_AVGS(3))) : 1;
+
+        double time = averages*(bct + lst + hsc)*adck_ps;
+        if(first) { // single or first continuous conversion adder
+            if(adiclk == 3 && !(cfg2 & ADC_CFG2_ADACKEN)) {
+                time += 5e6 + 5*busCycle(); // the asynchronous clock has to start (5 us)
+            } else {
+                time += 3*adck_ps + 5*busCycle();
+            }
+        }
+        return (uint64_t)time;
+    }
+
+    void ADCModel::startConversion(uint8_t sc1n, bool first) {
+        converting = true;
+        converting_sc1n = sc1n;
+        conversion_end = now() + conversionTime(first);
+    }
+
+    void ADCModel::hardwareTrigger(uint8_t sc1n) {
+        if(calibrating || !(regs[SC2].value & ADC_SC2_ADTRG)) {
+            return;
+        }
+        if((regs[sc1n].value & ADC_SC1_ADCH(31)) == ADC_SC1_ADCH(31)) {
+            return; // module disabled
+        }
+        regs[sc1n].value &= ~ADC_SC1_COCO;
+        startConversion(sc1n, true);
+    }
+
+    int32_t ADCModel::convert(uint8_t sc1n) {
+        const uint32_t sc1 = regs[sc1n].value;
+        const uint8_t channel = sc1 & ADC_SC1_ADCH(31);
+        const bool diff = sc1 & ADC_SC1_DIFF;
+        const uint8_t mode = (regs[CFG1].value >> 2) & 3;
+        const uint32_t sc3 = regs[SC3].value;
+        const uint32_t averages = (sc3 & ADC_SC3_AVGE) ? (4 << (sc3 & ADC_SC3_AVGS(3))) : 1;
+        const double vref = ((regs[SC2].value & ADC_SC2_REFSEL(3)) == 1) ? V_VREF_OUT : 3.3;
+
+        double gain = 1;
+        if(diff && (regs[PGA].value & ADC_PGA_PGAEN)) {
+            gain = 1 << ((regs[PGA].value >> 16) & 0xF);
+        }
+
+        int32_t sum = 0;
+        for(uint32_t i = 0; i < averages; i++) {
+            double v;
+            if(input) {
+                v = input(ADC_num, channel, diff, now());
+            } else if(diff) {
+                v = 0; // both inputs of the pair at the same voltage
+            } else if(channel == 29) { // VREFH
+                v = vref;
+            } else {
+                const int8_t pin = pulledPin(ADC_num, channel, !(regs[CFG2].value & ADC_CFG2_MUXSEL));
+                if(pin >= 0) {
+                    v = (pin_mode[pin] == INPUT_PULLUP) ? 3.3 : 0;
+                } else {
+                    v = voltage[channel];
+                }
+            }
+            v *= gain;
+
+            int32_t code;
+            if(diff) {
+                const int32_t half = 1 << (BITS_DIFF[mode] - 1);
+                code = (int32_t)lround(v/vref*half);
+                code = code < -half ? -half : (code > half - 1 ? half - 1 : code);
+            } else {
+                const int32_t full = 1 << BITS_SINGLE[mode];
+                code = (int32_t)lround(v/vref*full);
+                code = code < 0 ? 0 : (code > full - 1 ? full - 1 : code);
+            }
+            sum += code;
+        }
+        return sum/(int32_t)averages;
+    }
+
+    // compare function of SC2[ACFE], true if the result is stored
+    bool ADCModel::compare(int32_t result) {
+        const uint32_t sc2 = regs[SC2].value;
+        if(!(sc2 & ADC_SC2_ACFE)) {
+            return true;
+        }
+        // the compare values are signed for differential conversions
+        const bool diff = regs[converting_sc1n].value & ADC_SC1_DIFF;
+        const int32_t cv1 = diff ? (int16_t)regs[CV1].value : (uint16_t)regs[CV1].value;
+        const int32_t cv2 = diff ? (int16_t)regs[CV2].value : (uint16_t)regs[CV2].value;
+        const bool greater = sc2 & ADC_SC2_ACFGT;
+
+        if(!(sc2 & ADC_SC2_ACREN)) {
+            return greater ? (result >= cv1) : (result < cv1);
+        }
+        if(cv1 <= cv2) {
+            return greater ? (result >= cv1 && result <= cv2) : (result < cv1 || result > cv2);
+        }
+        return greater ? (result >= cv1 || result <= cv2) : (result < cv1 && result > cv2);
+    }
+
+    void ADCModel::finishConversion() {
+        const uint8_t sc1n = converting_sc1n;
+        int32_t result = convert(sc1n);
+        num_conversions++;
+
+        if(regs[SC3].value & ADC_SC3_ADCO) { // continuous conversions, start the next one
+            conversion_end += conversionTime(false);
+        } else {
+            converting = false;
+        }
+
+        if(!compare(result)) {
+            return;
+        }
+        // differential results are sign extended to 16 bits
+        regs[RA + sc1n].value = (uint16_t)result;
+        regs[SC1A + sc1n].value |= ADC_SC1_COCO;
+        if(regs[SC1A + sc1n].value & ADC_SC1_AIEN) {
+            setPending(IRQ_ADC);
+        }
+        if(regs[SC2].value & ADC_SC2_ADTRG) { // started by the PDB
+            pdb0().acknowledge(ADC_num, sc1n);
+        }
+    }
+
+    void ADCModel::finishCalibration() {
+        calibrating = false;
+        num_calibrations++;
+        regs[SC3].value &= ~ADC_SC3_CAL;
+        // the calibration fails if it's started with hardware trigger
+        if(regs[SC2].value & ADC_SC2_ADTRG) {
+            regs[SC3].value |= ADC_SC3_CALF;
+        }
+
+        // slightly different results for each module and reference
+        const uint16_t delta = ADC_num + 2*(regs[SC2].value & ADC_SC2_REFSEL(3));
+        for(uint8_t i = 0; i < 7; i++) {
+            regs[CLPD + i].value = CL_RESET[i] + delta;
+            regs[CLMD + i].value = CL_RESET[i] + delta;
+        }
+        regs[OFS].value = 0x4 + delta;
+
+        // COCO is set at the end of the calibration
+        regs[SC1A].value |= ADC_SC1_COCO;
+        if(regs[SC1A].value & ADC_SC1_AIEN) {
+            setPending(IRQ_ADC);
+        }
+    }
+
+    uint64_t ADCModel::nextEvent() {
+        uint64_t next = NO_EVENT;
+        if(converting) next = min(next, conversion_end);
+        if(calibrating) next = min(next, calibration_end);
+        return next;
+    }
+
+    void ADCModel::runEvents() {
+        while(true) {
+            if(calibrating && calibration_end <= now()) {
+                finishCalibration();
+            } else if(converting && conversion_end <= now()) {
+                finishConversion();
+            } else {
+                return;
+            }
+        }
+    }
+
+
+    //////// PDB
+
+    PDBModel::PDBModel() : num_sequences(0), running(false), sequence_start(0), sequence_end(NO_EVENT), interrupt(NO_EVENT) {
+        for(uint8_t i = 0; i < NUM_REGS; i++) {
+            regs[i].attach(this, i);
+        }
+        regs[MOD].value = 0xFFFF;
+        for(uint8_t ch = 0; ch < 2; ch++) {
+            pretrigger[ch][0] = pretrigger[ch][1] = NO_EVENT;
+        }
+    }
+
+    uint64_t PDBModel::counterPeriod() {
+        const uint32_t sc = regs[SC].value;
+        const uint32_t prescaler = 1 << ((sc >> 12) & 7);
+        const uint32_t mult_factor[4] = {1, 10, 20, 40};
+        return busCycle()*prescaler*mult_factor[(sc >> 2) & 3];
+    }
+
+    uint32_t PDBModel::read(const Register& reg, uint8_t id) {
+        if(id == CNT) {
+            return running ? (uint32_t)((now() - sequence_start)/counterPeriod()) : 0;
+        }
+        return reg.value;
+    }
+
+    void PDBModel::write(Register& reg, uint8_t id, uint32_t new_value) {
+        if(id == CNT) {
+            return; // read only
+        }
+        if(id != SC) {
+            reg.value = new_value;
+            return;
+        }
+        // PDBIF is cleared by writing a 0, SWTRIG and LDOK aren't stored
+        const uint32_t pdbif = reg.value & new_value & PDB_SC_PDBIF;
+        reg.value = (new_value & ~(PDB_SC_SWTRIG | PDB_SC_LDOK | PDB_SC_PDBIF)) | pdbif;
+
+        if(!(new_value & PDB_SC_PDBEN)) {
+            running = false;
+            return;
+        }
+        // software trigger
+        if((new_value & PDB_SC_SWTRIG) && ((new_value & PDB_SC_TRGSEL(15)) == PDB_SC_TRGSEL(15))) {
+            running = true;
+            startSequence(now());
+        }
+    }
+
+    void PDBModel::startSequence(uint64_t start) {
+        const uint64_t period = counterPeriod();
+        num_sequences++;
+        sequence_start = start;
+        sequence_end = start + (uint64_t)((regs[MOD].value & 0xFFFF) + 1)*period;
+        for(uint8_t ch = 0; ch < 2; ch++) {
+            const uint32_t c1 = regs[CH0C1 + 4*ch].value;
+            for(uint8_t n = 0; n < 2; n++) {
+                // TOS selects the delay, otherwise the pretrigger happens when the counter starts
+                const uint32_t delay = (c1 & (0x100 << n)) ? (regs[CH0DLY0 + 4*ch + n].value & 0xFFFF) : 0;
+                pretrigger[ch][n] = start + delay*period;
+                if((n == 1) && (c1 & (0x10000 << n))) { // back-to-back, see acknowledge
+                    pretrigger[ch][n] = NO_EVENT;
+                }
+            }
+        }
+        interrupt = start + (uint64_t)(regs[IDLY].value & 0xFFFF)*period;
+    }
+
+    void PDBModel::acknowledge(uint8_t ch, uint8_t n) {
+        if(!running || (n != 0)) {
+            return;
+        }
+        if(regs[CH0C1 + 4*ch].value & (0x10000 << 1)) {
+            pretrigger[ch][1] = now();
+        }
+    }
+
+    uint64_t PDBModel::nextEvent() {
+        if(!running) {
+            return NO_EVENT;
+        }
+        uint64_t next = min(sequence_end, interrupt);
+        for(uint8_t ch = 0; ch < 2; ch++) {
+            next = min(next, min(pretrigger[ch][0], pretrigger[ch][1]));
+        }
+        return next;
+    }
+
+    void PDBModel::runEvents() {
+        while(running) {
+            const uint64_t t = nextEvent();
+            if(t > now()) {
+                return;
+            }
+            bool handled = false;
+            for(uint8_t ch = 0; ch < 2 && !handled; ch++) {
+                for(uint8_t n = 0; n < 2 && !handled; n++) {
+                    if(pretrigger[ch][n] != t) continue;
+                    pretrigger[ch][n] = NO_EVENT;
+                    // channel n triggers ADCn, pretrigger A converts SC1A and B converts SC1B
+                    if(regs[CH0C1 + 4*ch].value & (1 << n)) {
+                        (ch ? adc1() : adc0()).hardwareTrigger(n);
+                    }
+                    handled = true;
+                }
+            }
+            if(handled) continue;
+            if(interrupt == t) {
+                interrupt = NO_EVENT;
+                regs[SC].value |= PDB_SC_PDBIF;
+                if(regs[SC].value & PDB_SC_PDBIE) {
+                    setPending(IRQ_PDB);
+                }
+                continue;
+            }
+            // end of the counter
+            if(regs[SC].value & PDB_SC_CONT) {
+                startSequence(sequence_end);
+            } else {
+                running = false;
+            }
+        }
+    }
+
+
+    //////// VREF
+
+    VREFModel::VREFModel() {
+        sc.attach(this, 0);
+    }
+
+    uint32_t VREFModel::read(const Register& reg, uint8_t id) {
+        // the reference is stable as soon as it's enabled
+        return reg.value | ((reg.value & VREF_SC_VREFEN) ? VREF_SC_VREFST : 0);
+    }
+
+}
+
+
+//////// Arduino functions
+
+HostSerial Serial;
+
+void yield(void) {
+    ADC_HostSim::busCycles(1);
+}
+
+void delay(uint32_t ms) {
+    ADC_HostSim::advance((uint64_t)ms*1000000000ULL);
+}
+
+void delayMicroseconds(uint32_t us) {
+    ADC_HostSim::advance((uint64_t)us*1000000ULL);
+}
+
+uint32_t micros(void) {
+    ADC_HostSim::busCycles(1);
+    return (uint32_t)(ADC_HostSim::now()/1000000ULL);
+}
+
+uint32_t millis(void) {
+    ADC_HostSim::busCycles(1);
+    return (uint32_t)(ADC_HostSim::now()/1000000000ULL);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    pin_mode[pin & 63] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    pin_state[pin & 63] = val;
+}
+
+uint8_t digitalRead(uint8_t pin) {
+    return pin_state[pin & 63];
+}
+
+void HostSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HostSerial::print(const char* s) {
+    return fputs(s, stdout) < 0 ? 0 : strlen(s);
+}
+
+size_t HostSerial::print(char c) {
+    return putchar(c) == EOF ? 0 : 1;
+}
+
+size_t HostSerial::print(long long n, int base) {
+    if(base == DEC && n < 0) {
+        return print('-') + print((unsigned long long)-n, base);
+    }
+    return print((unsigned long long)n, base);
+}
+
+size_t HostSerial::print(unsigned long long n, int base) {
+    if(base < 2) base = DEC;
+    char buf[8*sizeof(n) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    do {
+        const char digit = n % base;
+        n /= base;
+        *--str = digit < 10 ? digit + '0' : digit + 'A' - 10;
+    } while(n);
+    return print(str);
+}
+
+size_t HostSerial::print(double n, int digits) {
+    return printf("%.*f", digits, n);
+}
+
+
+#if !defined(ADC_HOST_SIM_NO_MAIN)
+// Run the sketch: setup() once and loop() forever, or the number of times given as the first argument.
+// Define ADC_HOST_SIM_NO_MAIN to use your own main().
+int main(int argc, char** argv) {
+    const long loops = (argc > 1) ? atol(argv[1]) : -1;
+    setup();
+    for(long i = 0; loops < 0 || i < loops; i++) {
+        loop();
+    }
+    Serial.flush();
+    return 0;
+}
+#endif
+
+#endif // ADC_HOST_SIM
@@ -0,0 +1,262 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* ADC_HostSim.h: Simulated ADC, PDB and VREF peripherals for host (Linux) builds.
+*
+*   Only used when ADC_HOST_SIM is defined, see the host/Arduino.h shim.
+*/
+
+#ifndef ADC_HOSTSIM_H
+#define ADC_HOSTSIM_H
+
+#include <stdint.h>
+
+//! Simulated Kinetis peripherals, used instead of the real registers when ADC_HOST_SIM is defined.
+/** The registers are objects that forward every read and write to a model of the peripheral,
+*   so writing SC1A starts a conversion, reading RA clears COCO, etc.
+*   Time is virtual: each register access, yield() and micros() take one bus cycle,
+*   delay() and delayMicroseconds() advance the time by the given amount.
+*   Conversions, calibrations, PDB triggers and interrupts happen when the time advances past them.
+*   Not simulated: DMA, the PDB load modes (LDOK/LDMOD), the offset (OFS) and gain (PG/MG) corrections,
+*   the ADC registers of the Teensy LC and of the second PDB.
+*/
+namespace ADC_HostSim
+{
+    //! Number of interrupt vectors
+    const uint8_t NUM_IRQS = 128;
+
+    class Peripheral;
+
+    //! A simulated 32 bit register
+    /** Reads and writes go through the Peripheral that owns it.
+    *   Registers without owner behave like memory.
+    */
+    class Register {
+    public:
+        Register() : value(0), owner(nullptr), id(0) {}
+
+        //! Read the register
+        operator uint32_t() const;
+
+        //! Write the register
+        Register& operator=(uint32_t new_value);
+        //! Copy the value of another register
+        Register& operator=(const Register& other) {
+            return *this = (uint32_t)other;
+        }
+
+        Register& operator|=(uint32_t bits) {
+            return *this = (uint32_t)*this | bits;
+        }
+        Register& operator&=(uint32_t bits) {
+            return *this = (uint32_t)*this & bits;
+        }
+
+        //! Make the peripheral owner handle the reads and writes
+        void attach(Peripheral* owner_, uint8_t id_) {
+            owner = owner_;
+            id = id_;
+        }
+
+        //! Stored value, the peripheral models change it directly (no bus cycle is spent)
+        uint32_t value;
+
+    private:
+        Register(const Register&) = delete;
+
+        Peripheral* owner;
+        uint8_t id;
+    };
+
+    //! Base class of the peripheral models
+    class Peripheral {
+    public:
+        //! Value read from the register
+        virtual uint32_t read(const Register& reg, uint8_t id) { return reg.value; }
+        //! Write new_value to the register
+        virtual void write(Register& reg, uint8_t id, uint32_t new_value) { reg.value = new_value; }
+        //! Time of the next event in ps, or NO_EVENT
+        virtual uint64_t nextEvent() { return NO_EVENT; }
+        //! Handle all events scheduled at or before the current time
+        virtual void runEvents() {}
+
+        static const uint64_t NO_EVENT = UINT64_MAX;
+
+    protected:
+        ~Peripheral() {}
+    };
+
+
+    //! Input voltage of an ADC channel
+    /** \param adc_num ADC number.
+    *   \param channel SC1A channel (ADCH) that is being converted.
+    *   \param differential true for differential conversions.
+    *   \param time_ps time of the conversion.
+    *   \return the voltage of the channel, or the difference of the voltages of the pair for differential conversions.
+    */
+    typedef double (*InputFunction)(uint8_t adc_num, uint8_t channel, bool differential, uint64_t time_ps);
+
+    //! Simulated ADC module
+    class ADCModel : public Peripheral {
+    public:
+        //! Register ids
+        enum REG_ID {SC1A, SC1B, CFG1, CFG2, RA, RB, CV1, CV2, SC2, SC3, OFS, PG, MG,
+                     CLPD, CLPS, CLP4, CLP3, CLP2, CLP1, CLP0, PGA, CLMD, CLMS, CLM4, CLM3, CLM2, CLM1, CLM0,
+                     NUM_REGS};
+
+        ADCModel(uint8_t adc_num, uint8_t irq);
+
+        Register regs[NUM_REGS];
+
+        //! Input voltages of the single-ended channels, in V
+        double voltage[32];
+        //! Optional function that overrides voltage[], for example to simulate a signal
+        InputFunction input;
+
+        //! Start a conversion of SC1A (0) or SC1B (1), used by the PDB pretriggers.
+        void hardwareTrigger(uint8_t sc1n);
+
+        //! Conversion time in ps of the current configuration
+        /** \param first true for the first conversion of a sequence (single or the first continuous).
+        */
+        uint64_t conversionTime(bool first);
+
+        //! Number of conversions and of calibrations done
+        uint32_t num_conversions, num_calibrations;
+
+        uint32_t read(const Register& reg, uint8_t id) override;
+        void write(Register& reg, uint8_t id, uint32_t new_value) override;
+        uint64_t nextEvent() override;
+        void runEvents() override;
+
+    private:
+        void startConversion(uint8_t sc1n, bool first);
+        void finishConversion();
+        void finishCalibration();
+        int32_t convert(uint8_t sc1n);
+        bool compare(int32_t result);
+
+        const uint8_t ADC_num;
+        const uint8_t IRQ_ADC;
+
+        bool converting; // a conversion is in progress
+        uint8_t converting_sc1n; // of SC1A (0) or SC1B (1)
+        uint64_t conversion_end;
+
+        bool calibrating;
+        uint64_t calibration_end;
+    };
+
+    //! Simulated programmable delay block
+    class PDBModel : public Peripheral {
+    public:
+        enum REG_ID {SC, MOD, CNT, IDLY, CH0C1, CH0S, CH0DLY0, CH0DLY1, CH1C1, CH1S, CH1DLY0, CH1DLY1, NUM_REGS};
+
+        PDBModel();
+
+        Register regs[NUM_REGS];
+
+        //! Number of times the counter has started
+        uint32_t num_sequences;
+
+        //! The ADC of channel ch finished the conversion started by pretrigger n (back-to-back acknowledge)
+        /** With CHnC1[BB] of pretrigger 1 set, it starts pretrigger 1 when pretrigger 0 is done.
+        *   The back-to-back chain of pretrigger 0 (from the other channel) isn't simulated, it uses its delay.
+        */
+        void acknowledge(uint8_t ch, uint8_t n);
+
+        uint32_t read(const Register& reg, uint8_t id) override;
+        void write(Register& reg, uint8_t id, uint32_t new_value) override;
+        uint64_t nextEvent() override;
+        void runEvents() override;
+
+    private:
+        void startSequence(uint64_t start);
+        uint64_t counterPeriod(); // one count in ps
+
+        bool running;
+        // times in ps of the start and end of the counter sequence,
+        // of the pretriggers A and B of channels 0 and 1, and of the interrupt
+        uint64_t sequence_start, sequence_end;
+        uint64_t pretrigger[2][2];
+        uint64_t interrupt;
+    };
+
+    //! Simulated voltage reference, VREFST is set while the reference is enabled
+    class VREFModel : public Peripheral {
+    public:
+        VREFModel();
+
+        Register sc; // VREF_SC
+
+        uint32_t read(const Register& reg, uint8_t id) override;
+    };
+
+    // The models are created the first time they are used,
+    // so the registers work in the constructors of global objects, like ADC.
+    ADCModel& adc0();
+    ADCModel& adc1();
+    PDBModel& pdb0();
+    VREFModel& vref();
+
+    // registers without model
+    extern volatile uint32_t sim_scgc3, sim_scgc6;
+    extern volatile uint8_t vref_trm, pmc_regsc;
+    extern volatile uint32_t arm_demcr, arm_dwt_ctrl;
+
+    //! Virtual time in ps
+    uint64_t now();
+    //! Virtual time in CPU cycles, for ARM_DWT_CYCCNT
+    uint32_t cpuCycles();
+    //! Advance the virtual time by ps picoseconds, running all events and interrupts in between
+    void advance(uint64_t ps);
+    //! Advance the virtual time by a number of bus cycles
+    void busCycles(uint32_t cycles);
+    //! Length of a bus cycle in ps
+    uint64_t busCycle();
+
+    //! Mask interrupts (__disable_irq)
+    void disableIrq();
+    //! Unmask interrupts (__enable_irq) and run the pending ones
+    void enableIrq();
+    //! True if the interrupts are masked (PRIMASK)
+    bool irqMasked();
+    //! Enable an interrupt in the NVIC
+    void enableInterrupt(uint8_t irq);
+    //! Disable an interrupt in the NVIC
+    void disableInterrupt(uint8_t irq);
+    //! Mark an interrupt as pending, it runs as soon as it's enabled and not masked
+    void setPending(uint8_t irq);
+    //! Set the function called by an interrupt
+    void setVector(uint8_t irq, void (*function)(void));
+
+    //! Add a periodic interrupt, returns its id or -1 if there are none left (used by IntervalTimer)
+    int8_t startTimer(void (*function)(void), uint64_t period_ps);
+    //! Remove a periodic interrupt
+    void stopTimer(int8_t id);
+
+}
+
+#endif // ADC_HOSTSIM_H
@@ -0,0 +1,348 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Arduino.h: The parts of the Teensyduino core used by the library and its examples,
+*   for host builds with the simulated registers of ADC_HostSim.h.
+*
+*   Build with: g++ -DADC_HOST_SIM -I. -Ihost ..., see README.md
+*/
+
+#ifndef ADC_HOST_ARDUINO_H
+#define ADC_HOST_ARDUINO_H
+
+#if !defined(ADC_HOST_SIM)
+#error "host/Arduino.h is only for host builds, define ADC_HOST_SIM"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "ADC_HostSim.h"
+
+// Simulate a Teensy 3.1/3.2 unless another board is selected
+#if !defined(__MK20DX128__) && !defined(__MK20DX256__) && !defined(__MK64FX512__) && !defined(__MK66FX1M0__)
+#define __MK20DX256__ 1
+#endif
+#define KINETISK
+
+#ifndef F_CPU
+#define F_CPU 96000000
+#endif
+#ifndef F_BUS
+#define F_BUS 48000000
+#endif
+
+#define DMAMEM
+
+
+//////// Registers
+
+#define ADC0_SC1A (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::SC1A])
+#define ADC0_SC1B (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::SC1B])
+#define ADC0_CFG1 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CFG1])
+#define ADC0_CFG2 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CFG2])
+#define ADC0_RA   (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::RA])
+#define ADC0_RB   (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::RB])
+#define ADC0_CV1  (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CV1])
+#define ADC0_CV2  (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CV2])
+#define ADC0_SC2  (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::SC2])
+#define ADC0_SC3  (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::SC3])
+#define ADC0_OFS  (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::OFS])
+#define ADC0_PG   (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::PG])
+#define ADC0_MG   (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::MG])
+#define ADC0_CLPD (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLPD])
+#define ADC0_CLPS (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLPS])
+#define ADC0_CLP4 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLP4])
+#define ADC0_CLP3 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLP3])
+#define ADC0_CLP2 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLP2])
+#define ADC0_CLP1 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLP1])
+#define ADC0_CLP0 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLP0])
+#define ADC0_PGA  (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::PGA])
+#define ADC0_CLMD (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLMD])
+#define ADC0_CLMS (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLMS])
+#define ADC0_CLM4 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLM4])
+#define ADC0_CLM3 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLM3])
+#define ADC0_CLM2 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLM2])
+#define ADC0_CLM1 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLM1])
+#define ADC0_CLM0 (ADC_HostSim::adc0().regs[ADC_HostSim::ADCModel::CLM0])
+
+#define ADC1_SC1A (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::SC1A])
+#define ADC1_SC1B (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::SC1B])
+#define ADC1_CFG1 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CFG1])
+#define ADC1_CFG2 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CFG2])
+#define ADC1_RA   (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::RA])
+#define ADC1_RB   (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::RB])
+#define ADC1_CV1  (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CV1])
+#define ADC1_CV2  (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CV2])
+#define ADC1_SC2  (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::SC2])
+#define ADC1_SC3  (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::SC3])
+#define ADC1_OFS  (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::OFS])
+#define ADC1_PG   (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::PG])
+#define ADC1_MG   (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::MG])
+#define ADC1_CLPD (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLPD])
+#define ADC1_CLPS (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLPS])
+#define ADC1_CLP4 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLP4])
+#define ADC1_CLP3 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLP3])
+#define ADC1_CLP2 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLP2])
+#define ADC1_CLP1 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLP1])
+#define ADC1_CLP0 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLP0])
+#define ADC1_PGA  (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::PGA])
+#define ADC1_CLMD (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLMD])
+#define ADC1_CLMS (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLMS])
+#define ADC1_CLM4 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLM4])
+#define ADC1_CLM3 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLM3])
+#define ADC1_CLM2 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLM2])
+#define ADC1_CLM1 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLM1])
+#define ADC1_CLM0 (ADC_HostSim::adc1().regs[ADC_HostSim::ADCModel::CLM0])
+
+#define PDB0_SC      (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::SC])
+#define PDB0_MOD     (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::MOD])
+#define PDB0_CNT     (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CNT])
+#define PDB0_IDLY    (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::IDLY])
+#define PDB0_CH0C1   (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH0C1])
+#define PDB0_CH0S    (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH0S])
+#define PDB0_CH0DLY0 (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH0DLY0])
+#define PDB0_CH0DLY1 (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH0DLY1])
+#define PDB0_CH1C1   (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH1C1])
+#define PDB0_CH1S    (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH1S])
+#define PDB0_CH1DLY0 (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH1DLY0])
+#define PDB0_CH1DLY1 (ADC_HostSim::pdb0().regs[ADC_HostSim::PDBModel::CH1DLY1])
+
+#define SIM_SCGC3 (ADC_HostSim::sim_scgc3)
+#define SIM_SCGC6 (ADC_HostSim::sim_scgc6)
+#define VREF_TRM  (ADC_HostSim::vref_trm)
+#define VREF_SC   (ADC_HostSim::vref().sc)
+#define PMC_REGSC (ADC_HostSim::pmc_regsc)
+
+// the cycle counter counts the virtual time, it's always enabled
+#define ARM_DEMCR      (ADC_HostSim::arm_demcr)
+#define ARM_DWT_CTRL   (ADC_HostSim::arm_dwt_ctrl)
+#define ARM_DWT_CYCCNT (ADC_HostSim::cpuCycles())
+
+
+//////// Register bits, same values as kinetis.h
+
+#define SIM_SCGC3_ADC1          ((uint32_t)0x08000000)
+#define SIM_SCGC6_ADC0          ((uint32_t)0x08000000)
+#define SIM_SCGC6_PDB           ((uint32_t)0x00400000)
+
+#define ARM_DEMCR_TRCENA        ((uint32_t)0x01000000)
+#define ARM_DWT_CTRL_CYCCNTENA  ((uint32_t)0x00000001)
+
+#define ADC_SC1_COCO            ((uint32_t)0x80)
+#define ADC_SC1_AIEN            ((uint32_t)0x40)
+#define ADC_SC1_DIFF            ((uint32_t)0x20)
+#define ADC_SC1_ADCH(n)         ((uint32_t)(((n) & 0x1F) << 0))
+#define ADC_CFG1_ADLPC          ((uint32_t)0x80)
+#define ADC_CFG1_ADIV(n)        ((uint32_t)(((n) & 3) << 5))
+#define ADC_CFG1_ADLSMP         ((uint32_t)0x10)
+#define ADC_CFG1_MODE(n)        ((uint32_t)(((n) & 3) << 2))
+#define ADC_CFG1_ADICLK(n)      ((uint32_t)(((n) & 3) << 0))
+#define ADC_CFG2_MUXSEL         ((uint32_t)0x10)
+#define ADC_CFG2_ADACKEN        ((uint32_t)0x08)
+#define ADC_CFG2_ADHSC          ((uint32_t)0x04)
+#define ADC_CFG2_ADLSTS(n)      ((uint32_t)(((n) & 3) << 0))
+#define ADC_SC2_ADACT           ((uint32_t)0x80)
+#define ADC_SC2_ADTRG           ((uint32_t)0x40)
+#define ADC_SC2_ACFE            ((uint32_t)0x20)
+#define ADC_SC2_ACFGT           ((uint32_t)0x10)
+#define ADC_SC2_ACREN           ((uint32_t)0x08)
+#define ADC_SC2_DMAEN           ((uint32_t)0x04)
+#define ADC_SC2_REFSEL(n)       ((uint32_t)(((n) & 3) << 0))
+#define ADC_SC3_CAL             ((uint32_t)0x80)
+#define ADC_SC3_CALF            ((uint32_t)0x40)
+#define ADC_SC3_ADCO            ((uint32_t)0x08)
+#define ADC_SC3_AVGE            ((uint32_t)0x04)
+#define ADC_SC3_AVGS(n)         ((uint32_t)(((n) & 3) << 0))
+#define ADC_PGA_PGAEN           ((uint32_t)0x00800000)
+#define ADC_PGA_PGALPB          ((uint32_t)0x00100000)
+#define ADC_PGA_PGAG(n)         ((uint32_t)(((n) & 15) << 16))
+
+#define PDB_SC_LDMOD(n)         (((n) & 3) << 18)
+#define PDB_SC_PDBEIE           0x00020000
+#define PDB_SC_SWTRIG           0x00010000
+#define PDB_SC_DMAEN            0x00008000
+#define PDB_SC_PRESCALER(n)     (((n) & 7) << 12)
+#define PDB_SC_TRGSEL(n)        (((n) & 15) << 8)
+#define PDB_SC_PDBEN            0x00000080
+#define PDB_SC_PDBIF            0x00000040
+#define PDB_SC_PDBIE            0x00000020
+#define PDB_SC_MULT(n)          (((n) & 3) << 2)
+#define PDB_SC_CONT             0x00000002
+#define PDB_SC_LDOK             0x00000001
+
+#define VREF_TRM_CHOPEN         ((uint8_t)0x40)
+#define VREF_SC_VREFEN          ((uint8_t)0x80)
+#define VREF_SC_REGEN           ((uint8_t)0x40)
+#define VREF_SC_ICOMPEN         ((uint8_t)0x20)
+#define VREF_SC_VREFST          ((uint8_t)0x04)
+#define VREF_SC_MODE_LV(n)      ((uint8_t)(((n) & 3) << 0))
+#define VREF_SC_MODE_LV_BANDGAPONLY     0
+#define VREF_SC_MODE_LV_HIGHPOWERBUF    1
+#define VREF_SC_MODE_LV_LOWPOWERBUF     2
+#define PMC_REGSC_BGBE          ((uint8_t)0x01)
+
+
+//////// Interrupts
+
+enum IRQ_NUMBER_t {
+    IRQ_ADC0 = 57,
+    IRQ_ADC1 = 58,
+    IRQ_PDB = 72
+};
+
+extern "C" {
+    // weak, define them to handle the interrupts
+    void adc0_isr(void);
+    void adc1_isr(void);
+    void pdb_isr(void);
+}
+
+#define __disable_irq() ADC_HostSim::disableIrq()
+#define __enable_irq() ADC_HostSim::enableIrq()
+#define NVIC_ENABLE_IRQ(n) ADC_HostSim::enableInterrupt(n)
+#define NVIC_DISABLE_IRQ(n) ADC_HostSim::disableInterrupt(n)
+#define NVIC_SET_PRIORITY(irqnum, priority) ((void)(irqnum), (void)(priority))
+
+inline void attachInterruptVector(enum IRQ_NUMBER_t irq, void (*function)(void)) {
+    ADC_HostSim::setVector(irq, function);
+}
+
+
+//////// Time
+
+void yield(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+uint32_t micros(void);
+uint32_t millis(void);
+
+//! Counts the microseconds since it was created or set
+class elapsedMicros {
+public:
+    elapsedMicros() : us(micros()) {}
+    elapsedMicros(uint32_t val) : us(micros() - val) {}
+    operator uint32_t() const { return micros() - us; }
+    elapsedMicros& operator=(uint32_t val) { us = micros() - val; return *this; }
+private:
+    uint32_t us;
+};
+
+//! Counts the milliseconds since it was created or set
+class elapsedMillis {
+public:
+    elapsedMillis() : ms(millis()) {}
+    elapsedMillis(uint32_t val) : ms(millis() - val) {}
+    operator uint32_t() const { return millis() - ms; }
+    elapsedMillis& operator=(uint32_t val) { ms = millis() - val; return *this; }
+private:
+    uint32_t ms;
+};
+
+
+//////// Pins
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+
+#define LED_BUILTIN 13
+
+const static uint8_t A0 = 14;
+const static uint8_t A1 = 15;
+const static uint8_t A2 = 16;
+const static uint8_t A3 = 17;
+const static uint8_t A4 = 18;
+const static uint8_t A5 = 19;
+const static uint8_t A6 = 20;
+const static uint8_t A7 = 21;
+const static uint8_t A8 = 22;
+const static uint8_t A9 = 23;
+const static uint8_t A10 = 34;
+const static uint8_t A11 = 35;
+const static uint8_t A12 = 36;
+const static uint8_t A13 = 37;
+const static uint8_t A14 = 40;
+const static uint8_t A15 = 26;
+const static uint8_t A16 = 27;
+const static uint8_t A17 = 28;
+const static uint8_t A18 = 29;
+const static uint8_t A19 = 30;
+const static uint8_t A20 = 31;
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint8_t digitalRead(uint8_t pin);
+inline void digitalWriteFast(uint8_t pin, uint8_t val) { digitalWrite(pin, val); }
+inline uint8_t digitalReadFast(uint8_t pin) { return digitalRead(pin); }
+
+
+//////// Serial, prints to stdout
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class HostSerial {
+public:
+    void begin(uint32_t baud) {}
+    operator bool() { return true; }
+    int available() { return 0; }
+    int read() { return -1; }
+    long parseInt() { return 0; }
+    void flush();
+
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long long)n, base); }
+    size_t print(int n, int base = DEC) { return print((long long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long long)n, base); }
+    size_t print(long n, int base = DEC) { return print((long long)n, base); }
+    size_t print(unsigned long n, int base = DEC) { return print((unsigned long long)n, base); }
+    size_t print(long long n, int base = DEC);
+    size_t print(unsigned long long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println() { return print('\n'); }
+    template<typename T>
+    size_t println(T value) { size_t n = print(value); return n + println(); }
+    template<typename T>
+    size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+extern HostSerial Serial;
+
+// Arduino sketch functions, called by main()
+void setup(void);
+void loop(void);
+
+#endif // ADC_HOST_ARDUINO_H
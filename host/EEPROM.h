@@ -23,42 +23,50 @@
  * SOFTWARE.
  */
 
-#include "RingBuffer.h"
 
+/* EEPROM.h: EEPROM for host builds, it's kept in memory so it's erased (0xFF) every time the program starts.
+*/
 
-RingBuffer::RingBuffer()
-{
-    //ctor
-}
+#ifndef ADC_HOST_EEPROM_H
+#define ADC_HOST_EEPROM_H
 
-RingBuffer::~RingBuffer()
-{
-    // dtor
-}
+#include "Arduino.h"
 
-int RingBuffer::isFull() {
-    return (b_end == (b_start ^ b_size));
-}
+#define E2END 0x7FF
 
-int RingBuffer::isEmpty() {
-    return (b_end == b_start);
-}
+//! EEPROM with the same interface as the Teensyduino one
+class EEPROMClass {
+public:
+    EEPROMClass() {
+        memset(data, 0xFF, sizeof(data));
+    }
+
+    uint8_t read(int idx) {
+        return data[idx];
+    }
+    void write(int idx, uint8_t val) {
+        data[idx] = val;
+    }
+    void update(int idx, uint8_t val) {
+        data[idx] = val;
+    }
+    uint16_t length() {
+        return E2END + 1;
+    }
 
-void RingBuffer::write(int value) {
-    elems[b_end&(b_size-1)] = value;
-    if (isFull()) { /* full, overwrite moves start pointer */
-        b_start = increase(b_start);
+    template<typename T> T& get(int idx, T& t) {
+        memcpy(&t, data + idx, sizeof(T));
+        return t;
     }
-    b_end = increase(b_end);
-}
+    template<typename T> const T& put(int idx, const T& t) {
+        memcpy(data + idx, &t, sizeof(T));
+        return t;
+    }
+
+private:
+    uint8_t data[E2END + 1];
+};
 
-int RingBuffer::read() {
-    int result = elems[b_start&(b_size-1)];
-    b_start = increase(b_start);
-    return result;
-}
+static EEPROMClass EEPROM;
 
-// increases the pointer modulo 2*size-1
-int RingBuffer::increase(int p) {
-    return (p + 1)&(2*b_size-1);
-}
+#endif // ADC_HOST_EEPROM_H
@@ -0,0 +1,65 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* IntervalTimer.h: IntervalTimer for host builds, the function is called in virtual time.
+*/
+
+#ifndef ADC_HOST_INTERVALTIMER_H
+#define ADC_HOST_INTERVALTIMER_H
+
+#include "Arduino.h"
+
+//! Calls a function periodically, like the PIT based IntervalTimer of Teensyduino
+class IntervalTimer {
+public:
+    IntervalTimer() : id(-1) {}
+    ~IntervalTimer() { end(); }
+
+    bool begin(void (*function)(void), uint32_t microseconds) {
+        return begin(function, (double)microseconds);
+    }
+    bool begin(void (*function)(void), int microseconds) {
+        return begin(function, (double)microseconds);
+    }
+    bool begin(void (*function)(void), float microseconds) {
+        return begin(function, (double)microseconds);
+    }
+    bool begin(void (*function)(void), double microseconds) {
+        end();
+        if(microseconds <= 0) return false;
+        id = ADC_HostSim::startTimer(function, (uint64_t)(microseconds*1e6));
+        return id >= 0;
+    }
+    void end() {
+        if(id >= 0) ADC_HostSim::stopTimer(id);
+        id = -1;
+    }
+    void priority(uint8_t n) {}
+
+private:
+    int8_t id;
+};
+
+#endif // ADC_HOST_INTERVALTIMER_H
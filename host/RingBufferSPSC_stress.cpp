@@ -0,0 +1,145 @@
+/* Teensy 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2017 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* RingBufferSPSC_stress.cpp: Host test of ADC_Buffer::RingBufferSPSC with a producer and a consumer thread
+*  The producer writes the numbers 0, 1, 2... and the consumer checks that it reads all of them in order.
+*  When the buffer is full the producer counts the failed write and tries again, getOverflows() must match that count.
+*  It runs once with write/read and once with writeBulk/readBulk, and exits with 1 if any check fails.
+*
+*  g++ -std=c++11 -O2 -pthread -I. host/RingBufferSPSC_stress.cpp -o RingBufferSPSC_stress
+*/
+
+#include "RingBuffer.h"
+
+#include <stdio.h>
+#include <thread>
+
+// small, so the buffer is full or empty often and the threads run into each other
+typedef ADC_Buffer::RingBufferSPSC<uint32_t, 64> Buffer;
+
+const uint32_t NUM_VALUES = 10000000;
+const uint32_t BLOCK = 37; // not a divisor of the size, so the bulk functions wrap around
+
+// write/read one value at a time, returns true if all values arrived in order
+bool test_single() {
+    Buffer* buffer = new Buffer;
+    uint32_t failed_writes = 0;
+
+    std::thread producer([&]() {
+        for(uint32_t i = 0; i < NUM_VALUES; i++) {
+            while(!buffer->write(i)) {
+                failed_writes++;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    bool ok = true;
+    uint32_t expected = 0;
+    while(expected < NUM_VALUES) {
+        uint32_t value;
+        if(!buffer->read(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if(ok && (value != expected)) {
+            printf("write/read: expected %u, read %u\n", expected, value);
+            ok = false;
+        }
+        expected++;
+    }
+    producer.join();
+
+    if(!buffer->isEmpty()) {
+        printf("write/read: %u values left in the buffer\n", buffer->available());
+        ok = false;
+    }
+    if(buffer->getOverflows() != failed_writes) {
+        printf("write/read: %u overflows, but %u writes failed\n", buffer->getOverflows(), failed_writes);
+        ok = false;
+    }
+    delete buffer;
+    return ok;
+}
+
+// writeBulk/readBulk blocks of values, returns true if all values arrived in order
+bool test_bulk() {
+    Buffer* buffer = new Buffer;
+    uint32_t dropped = 0;
+
+    std::thread producer([&]() {
+        uint32_t block[BLOCK];
+        uint32_t next = 0;
+        while(next < NUM_VALUES) {
+            const uint32_t n = (NUM_VALUES - next < BLOCK) ? NUM_VALUES - next : BLOCK;
+            for(uint32_t i = 0; i < n; i++) {
+                block[i] = next + i;
+            }
+            const uint32_t written = buffer->writeBulk(block, n);
+            dropped += n - written; // written again in the next block
+            next += written;
+            if(written < n) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    bool ok = true;
+    uint32_t expected = 0;
+    uint32_t block[BLOCK];
+    while(expected < NUM_VALUES) {
+        const uint32_t n = buffer->readBulk(block, BLOCK);
+        if(n == 0) {
+            std::this_thread::yield();
+        }
+        for(uint32_t i = 0; i < n; i++) {
+            if(ok && (block[i] != expected)) {
+                printf("writeBulk/readBulk: expected %u, read %u\n", expected, block[i]);
+                ok = false;
+            }
+            expected++;
+        }
+    }
+    producer.join();
+
+    if(!buffer->isEmpty()) {
+        printf("writeBulk/readBulk: %u values left in the buffer\n", buffer->available());
+        ok = false;
+    }
+    if(buffer->getOverflows() != dropped) {
+        printf("writeBulk/readBulk: %u overflows, but %u values didn't fit\n", buffer->getOverflows(), dropped);
+        ok = false;
+    }
+    delete buffer;
+    return ok;
+}
+
+int main() {
+    const bool single_test = test_single();
+    printf("WRITE/READ TEST %s\n", single_test ? "PASS" : "FAIL");
+    const bool bulk_test = test_bulk();
+    printf("WRITEBULK/READBULK TEST %s\n", bulk_test ? "PASS" : "FAIL");
+    return (single_test && bulk_test) ? 0 : 1;
+}